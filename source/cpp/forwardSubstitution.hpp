@@ -0,0 +1,320 @@
+// AMSLA forward substitution kernel.
+//
+// Executes the steps of an amsla.common.internal.SolvePlan on one or more
+// right-hand sides. All
+// the index arrays are the ones stored in the plan: they are 1-based and
+// stored as doubles, as they come from MATLAB.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AMSLA_FORWARDSUBSTITUTION_HPP
+#define AMSLA_FORWARDSUBSTITUTION_HPP
+
+#include "solvePlanView.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace amsla {
+
+namespace internal {
+
+// Queue of the sub-graphs that are ready to be executed by one thread. The
+// owner takes the sub-graph it queued last, whose inputs are likely to be
+// in its cache. Other threads steal the one queued first.
+class WorkQueue {
+public:
+    void push(std::size_t subGraph) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        subGraphs_.push_back(subGraph);
+    }
+
+    bool pop(std::size_t& subGraph) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subGraphs_.empty()) {
+            return false;
+        }
+        subGraph = subGraphs_.back();
+        subGraphs_.pop_back();
+        return true;
+    }
+
+    bool steal(std::size_t& subGraph) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subGraphs_.empty()) {
+            return false;
+        }
+        subGraph = subGraphs_.front();
+        subGraphs_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::deque<std::size_t> subGraphs_;
+};
+
+}  // namespace internal
+
+// Execute a step of the plan (0-based) on x. x holds numColumns right-hand
+// sides, stored row by row: the entries of row r are
+// x[r*numColumns : (r+1)*numColumns-1]. The contributions of the non-loop
+// edges are all computed before the rows are updated, so that every read in
+// a step sees the values from before the step.
+//
+// scratch is resized as needed and can be reused across calls.
+inline void applyStep(const SolvePlanView& plan, std::size_t step, double* x,
+                      std::size_t numColumns, std::vector<double>& scratch) {
+    using internal::toIndex;
+
+    const std::size_t firstRow = toIndex(plan.rowPointer[step]);
+    const std::size_t lastRow = toIndex(plan.rowPointer[step + 1]);
+    const std::size_t numRows = lastRow - firstRow;
+    if (scratch.size() < numRows * numColumns) {
+        scratch.resize(numRows * numColumns);
+    }
+
+    for (std::size_t k = 0; k < numRows; ++k) {
+        const std::size_t firstEdge = toIndex(plan.rowEdgePointer[firstRow + k]);
+        const std::size_t lastEdge = toIndex(plan.rowEdgePointer[firstRow + k + 1]);
+        double* sum = scratch.data() + k * numColumns;
+        std::fill(sum, sum + numColumns, 0.0);
+        for (std::size_t e = firstEdge; e < lastEdge; ++e) {
+            const double weight = plan.weights[e];
+            const double* xColumn = x + toIndex(plan.columns[e]) * numColumns;
+            for (std::size_t c = 0; c < numColumns; ++c) {
+                sum[c] += weight * xColumn[c];
+            }
+        }
+    }
+    for (std::size_t k = 0; k < numRows; ++k) {
+        double* xRow = x + toIndex(plan.updateRows[firstRow + k]) * numColumns;
+        const double* sum = scratch.data() + k * numColumns;
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            xRow[c] -= sum[c];
+        }
+    }
+
+    const std::size_t firstDiagonal = toIndex(plan.diagonalPointer[step]);
+    const std::size_t lastDiagonal = toIndex(plan.diagonalPointer[step + 1]);
+    for (std::size_t d = firstDiagonal; d < lastDiagonal; ++d) {
+        double* xRow = x + toIndex(plan.diagonalRows[d]) * numColumns;
+        const double inverseDiagonal = plan.inverseDiagonal[d];
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            xRow[c] *= inverseDiagonal;
+        }
+    }
+}
+
+// Execute all the steps of a sub-graph (0-based position in the plan).
+inline void applySubGraph(const SolvePlanView& plan, std::size_t subGraph, double* x,
+                          std::size_t numColumns, std::vector<double>& scratch) {
+    using internal::toIndex;
+
+    const std::size_t firstStep = toIndex(plan.subGraphPointer[subGraph]);
+    const std::size_t lastStep = toIndex(plan.subGraphPointer[subGraph + 1]);
+    for (std::size_t step = firstStep; step < lastStep; ++step) {
+        applyStep(plan, step, x, numColumns, scratch);
+    }
+}
+
+// Execute the transpose of a step of the plan (0-based) on x, stored as in
+// applyStep. The rows of the loop edges are scaled first, then the
+// contributions of the rows of the non-loop edges are subtracted from their
+// columns. No row of a step is also a column of the same step, so the
+// contributions can be scattered in place.
+inline void applyStepTranspose(const SolvePlanView& plan, std::size_t step, double* x,
+                               std::size_t numColumns) {
+    using internal::toIndex;
+
+    const std::size_t firstDiagonal = toIndex(plan.diagonalPointer[step]);
+    const std::size_t lastDiagonal = toIndex(plan.diagonalPointer[step + 1]);
+    for (std::size_t d = firstDiagonal; d < lastDiagonal; ++d) {
+        double* xRow = x + toIndex(plan.diagonalRows[d]) * numColumns;
+        const double inverseDiagonal = plan.inverseDiagonal[d];
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            xRow[c] *= inverseDiagonal;
+        }
+    }
+
+    const std::size_t firstRow = toIndex(plan.rowPointer[step]);
+    const std::size_t lastRow = toIndex(plan.rowPointer[step + 1]);
+    for (std::size_t k = firstRow; k < lastRow; ++k) {
+        const double* xRow = x + toIndex(plan.updateRows[k]) * numColumns;
+        const std::size_t firstEdge = toIndex(plan.rowEdgePointer[k]);
+        const std::size_t lastEdge = toIndex(plan.rowEdgePointer[k + 1]);
+        for (std::size_t e = firstEdge; e < lastEdge; ++e) {
+            const double weight = plan.weights[e];
+            double* xColumn = x + toIndex(plan.columns[e]) * numColumns;
+            for (std::size_t c = 0; c < numColumns; ++c) {
+                xColumn[c] -= weight * xRow[c];
+            }
+        }
+    }
+}
+
+// Solve the transposed system by executing the transposes of all the steps
+// of the plan, in reverse order. A sub-graph scatters into the columns of
+// the sub-graphs it depends on, which can be shared with the other
+// sub-graphs of its level: the transposed solve runs on a single thread.
+inline void backwardSubstitution(const SolvePlanView& plan, double* x,
+                                 std::size_t numColumns) {
+    for (std::size_t step = plan.numSteps; step > 0; --step) {
+        applyStepTranspose(plan, step - 1, x, numColumns);
+    }
+}
+
+// Execute all the steps of the plan, in order, on the numColumns right-hand
+// sides in x.
+inline void forwardSubstitution(const SolvePlanView& plan, double* x,
+                                std::size_t numColumns) {
+    std::vector<double> scratch;
+    for (std::size_t step = 0; step < plan.numSteps; ++step) {
+        applyStep(plan, step, x, numColumns, scratch);
+    }
+}
+
+// Execute the plan on x with up to numThreads threads. The sub-graphs of a
+// level are independent: they are distributed dynamically across the
+// threads, and every thread only writes the rows of its own sub-graphs.
+// Threads synchronise at the end of each level.
+inline void forwardSubstitution(const SolvePlanView& plan, double* x,
+                                std::size_t numColumns, std::size_t numThreads) {
+    using internal::toIndex;
+
+    std::size_t maxSubGraphsPerLevel = 0;
+    for (std::size_t level = 0; level < plan.numLevels; ++level) {
+        maxSubGraphsPerLevel = std::max(maxSubGraphsPerLevel,
+            toIndex(plan.levelPointer[level + 1]) - toIndex(plan.levelPointer[level]));
+    }
+    numThreads = std::min(numThreads, maxSubGraphsPerLevel);
+    if (numThreads <= 1) {
+        forwardSubstitution(plan, x, numColumns);
+        return;
+    }
+
+    std::vector<std::atomic<std::size_t>> nextSubGraph(plan.numLevels);
+    for (std::size_t level = 0; level < plan.numLevels; ++level) {
+        nextSubGraph[level] = toIndex(plan.levelPointer[level]);
+    }
+    internal::Barrier barrier(numThreads);
+
+    auto worker = [&plan, x, numColumns, &nextSubGraph, &barrier]() {
+        std::vector<double> scratch;
+        for (std::size_t level = 0; level < plan.numLevels; ++level) {
+            const std::size_t lastSubGraph = toIndex(plan.levelPointer[level + 1]);
+            for (std::size_t subGraph = nextSubGraph[level]++; subGraph < lastSubGraph;
+                 subGraph = nextSubGraph[level]++) {
+                applySubGraph(plan, subGraph, x, numColumns, scratch);
+            }
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (std::size_t k = 1; k < numThreads; ++k) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Execute the plan on x with up to numThreads threads, following the
+// dependencies between the sub-graphs instead of the levels. Each sub-graph
+// counts the sub-graphs it still waits for, and the thread that finishes
+// the last of them queues it. Idle threads steal from the queues of the
+// other threads. There is no barrier between levels: a sub-graph starts as
+// soon as its own inputs are ready. Plans without dependencies are executed
+// level by level.
+inline void forwardSubstitutionByDependencies(const SolvePlanView& plan, double* x,
+                                              std::size_t numColumns, std::size_t numThreads) {
+    using internal::toIndex;
+
+    if (plan.successorPointer == nullptr) {
+        forwardSubstitution(plan, x, numColumns, numThreads);
+        return;
+    }
+    const std::size_t numSubGraphs = toIndex(plan.levelPointer[plan.numLevels]);
+    numThreads = std::min(numThreads, numSubGraphs);
+    if (numThreads <= 1) {
+        forwardSubstitution(plan, x, numColumns);
+        return;
+    }
+
+    std::vector<std::atomic<std::size_t>> numWaiting(numSubGraphs);
+    std::vector<internal::WorkQueue> queues(numThreads);
+    std::size_t nextQueue = 0;
+    for (std::size_t subGraph = 0; subGraph < numSubGraphs; ++subGraph) {
+        numWaiting[subGraph] = static_cast<std::size_t>(plan.numPredecessors[subGraph]);
+        if (numWaiting[subGraph] == 0) {
+            queues[nextQueue].push(subGraph);
+            nextQueue = (nextQueue + 1) % numThreads;
+        }
+    }
+    std::atomic<std::size_t> numRemaining(numSubGraphs);
+
+    // The counters are decremented with acquire-release semantics: the
+    // thread that makes a sub-graph ready sees the rows written by all
+    // its predecessors, and hands them over through the queue.
+    auto worker = [&plan, x, numColumns, numThreads, &numWaiting, &queues,
+                   &numRemaining](std::size_t self) {
+        std::vector<double> scratch;
+        std::size_t subGraph = 0;
+        while (numRemaining.load(std::memory_order_acquire) > 0) {
+            bool hasWork = queues[self].pop(subGraph);
+            for (std::size_t k = 1; !hasWork && k < numThreads; ++k) {
+                hasWork = queues[(self + k) % numThreads].steal(subGraph);
+            }
+            if (!hasWork) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            applySubGraph(plan, subGraph, x, numColumns, scratch);
+
+            const std::size_t firstSuccessor = toIndex(plan.successorPointer[subGraph]);
+            const std::size_t lastSuccessor = toIndex(plan.successorPointer[subGraph + 1]);
+            for (std::size_t s = firstSuccessor; s < lastSuccessor; ++s) {
+                const std::size_t successor = toIndex(plan.successors[s]);
+                if (numWaiting[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    queues[self].push(successor);
+                }
+            }
+            numRemaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (std::size_t k = 1; k < numThreads; ++k) {
+        threads.emplace_back(worker, k);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace amsla
+
+#endif  // AMSLA_FORWARDSUBSTITUTION_HPP
@@ -0,0 +1,216 @@
+// AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONGPUMEX Forward substitution on
+// the GPU.
+//
+//   X = AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONGPUMEX(P, B) Solve the
+//   triangular system described by the plan structure P with the
+//   right-hand side B, and return X as a gpuArray. P has the same fields
+//   as the structure returned by the method "nativePlan" of
+//   amsla.common.internal.SolvePlan: NumRows, NumLevels and LevelPointer
+//   are ordinary double arrays, all the other arrays are gpuArray objects,
+//   uploaded once when the solver is created. B must be a real double
+//   matrix, either on the host or on the device, with one row per row of
+//   the plan. Each column of B is a right-hand side.
+//
+//   The solve launches one kernel per sub-graph level. Each sub-graph of
+//   the level is executed by one thread block, and the time-slots of a
+//   sub-graph are separated by block-level barriers.
+//
+//   Build with amsla.common.internal.buildNativeKernels on a machine with
+//   a supported GPU and the CUDA toolkit.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mex.h"
+#include "gpu/mxGPUArray.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr unsigned int kThreadsPerBlock = 256;
+
+// Device pointers to the arrays of a solve plan. The arrays are the ones of
+// amsla.common.internal.SolvePlan: 1-based indices stored as doubles.
+struct DevicePlan {
+    const double* subGraphPointer;
+    const double* rowPointer;
+    const double* updateRows;
+    const double* rowEdgePointer;
+    const double* columns;
+    const double* weights;
+    const double* diagonalPointer;
+    const double* diagonalRows;
+    const double* inverseDiagonal;
+};
+
+__device__ inline std::size_t toIndex(double oneBasedIndex) {
+    return static_cast<std::size_t>(oneBasedIndex) - 1;
+}
+
+// Execute all the sub-graphs of a level, one per block. x is column-major,
+// with numRows rows and numColumns right-hand sides. Within a step, the rows
+// that are updated are never read, so every thread can update its row in
+// place.
+__global__ void solveLevel(DevicePlan plan, std::size_t firstSubGraph, double* x,
+                           std::size_t numRows, std::size_t numColumns) {
+    const std::size_t subGraph = firstSubGraph + blockIdx.x;
+    const std::size_t firstStep = toIndex(plan.subGraphPointer[subGraph]);
+    const std::size_t lastStep = toIndex(plan.subGraphPointer[subGraph + 1]);
+
+    for (std::size_t step = firstStep; step < lastStep; ++step) {
+        const std::size_t firstRow = toIndex(plan.rowPointer[step]);
+        const std::size_t numUpdates = (toIndex(plan.rowPointer[step + 1]) - firstRow) * numColumns;
+        for (std::size_t work = threadIdx.x; work < numUpdates; work += blockDim.x) {
+            const std::size_t k = firstRow + work / numColumns;
+            const std::size_t c = work % numColumns;
+            double* xColumn = x + c * numRows;
+            double sum = 0.0;
+            for (std::size_t e = toIndex(plan.rowEdgePointer[k]);
+                 e < toIndex(plan.rowEdgePointer[k + 1]); ++e) {
+                sum += plan.weights[e] * xColumn[toIndex(plan.columns[e])];
+            }
+            xColumn[toIndex(plan.updateRows[k])] -= sum;
+        }
+        __syncthreads();
+
+        const std::size_t firstDiagonal = toIndex(plan.diagonalPointer[step]);
+        const std::size_t numScalings = (toIndex(plan.diagonalPointer[step + 1]) - firstDiagonal) * numColumns;
+        for (std::size_t work = threadIdx.x; work < numScalings; work += blockDim.x) {
+            const std::size_t d = firstDiagonal + work / numColumns;
+            const std::size_t c = work % numColumns;
+            x[c * numRows + toIndex(plan.diagonalRows[d])] *= plan.inverseDiagonal[d];
+        }
+        __syncthreads();
+    }
+}
+
+const mxArray* getField(const mxArray* plan, const char* fieldName) {
+    const mxArray* field = mxGetField(plan, 0, fieldName);
+    if (field == nullptr) {
+        const std::string message =
+            std::string("Missing field \"") + fieldName + "\" in the solve plan.";
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badPlan", message.c_str());
+    }
+    return field;
+}
+
+const double* getHostArray(const mxArray* plan, const char* fieldName, std::size_t minNumel) {
+    const mxArray* field = getField(plan, fieldName);
+    if (!mxIsDouble(field) || mxIsComplex(field) || mxIsSparse(field) ||
+        mxGetNumberOfElements(field) < minNumel) {
+        const std::string message =
+            std::string("Invalid field \"") + fieldName + "\" in the solve plan.";
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badPlan", message.c_str());
+    }
+    return mxGetPr(field);
+}
+
+// Device arrays of the plan, released when the gateway returns.
+class DeviceArrays {
+public:
+    ~DeviceArrays() {
+        for (const mxGPUArray* anArray : arrays_) {
+            mxGPUDestroyGPUArray(anArray);
+        }
+    }
+
+    const double* get(const mxArray* plan, const char* fieldName) {
+        const mxArray* field = getField(plan, fieldName);
+        if (!mxIsGPUArray(field)) {
+            const std::string message =
+                std::string("Field \"") + fieldName + "\" of the solve plan must be a gpuArray.";
+            mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badPlan", message.c_str());
+        }
+        const mxGPUArray* anArray = mxGPUCreateFromMxArray(field);
+        arrays_.push_back(anArray);
+        if (mxGPUGetClassID(anArray) != mxDOUBLE_CLASS || mxGPUGetComplexity(anArray) != mxREAL) {
+            const std::string message =
+                std::string("Field \"") + fieldName + "\" of the solve plan must be real double.";
+            mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badPlan", message.c_str());
+        }
+        return static_cast<const double*>(mxGPUGetDataReadOnly(anArray));
+    }
+
+private:
+    std::vector<const mxGPUArray*> arrays_;
+};
+
+}  // namespace
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+    if (nrhs != 2) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badInputs",
+                          "The inputs must be the plan and the right-hand side.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badOutputs",
+                          "Only one output is returned.");
+    }
+    if (mxInitGPU() != MX_GPU_SUCCESS) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:noDevice",
+                          "Cannot initialise the GPU.");
+    }
+
+    const mxArray* plan = prhs[0];
+    if (!mxIsStruct(plan) || mxGetNumberOfElements(plan) != 1) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badPlan",
+                          "The plan must be a scalar structure.");
+    }
+    const std::size_t numRows = static_cast<std::size_t>(getHostArray(plan, "NumRows", 1)[0]);
+    const std::size_t numLevels = static_cast<std::size_t>(getHostArray(plan, "NumLevels", 1)[0]);
+    const double* levelPointer = getHostArray(plan, "LevelPointer", numLevels + 1);
+
+    DeviceArrays deviceArrays;
+    DevicePlan devicePlan;
+    devicePlan.subGraphPointer = deviceArrays.get(plan, "SubGraphPointer");
+    devicePlan.rowPointer = deviceArrays.get(plan, "RowPointer");
+    devicePlan.updateRows = deviceArrays.get(plan, "UpdateRows");
+    devicePlan.rowEdgePointer = deviceArrays.get(plan, "RowEdgePointer");
+    devicePlan.columns = deviceArrays.get(plan, "Columns");
+    devicePlan.weights = deviceArrays.get(plan, "Weights");
+    devicePlan.diagonalPointer = deviceArrays.get(plan, "DiagonalPointer");
+    devicePlan.diagonalRows = deviceArrays.get(plan, "DiagonalRows");
+    devicePlan.inverseDiagonal = deviceArrays.get(plan, "InverseDiagonal");
+
+    mxGPUArray* x = mxGPUCopyFromMxArray(prhs[1]);
+    const mwSize* dimensions = mxGPUGetDimensions(x);
+    const bool isValidRhs = mxGPUGetClassID(x) == mxDOUBLE_CLASS &&
+                            mxGPUGetComplexity(x) == mxREAL &&
+                            mxGPUGetNumberOfDimensions(x) == 2 &&
+                            dimensions[0] == numRows;
+    const std::size_t numColumns = dimensions[1];
+    mxFree(const_cast<mwSize*>(dimensions));
+    if (!isValidRhs) {
+        mxGPUDestroyGPUArray(x);
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionGpuMex:badRhs",
+                          "The right-hand side must be a real double matrix with one row per row of the plan.");
+    }
+
+    double* xData = static_cast<double*>(mxGPUGetData(x));
+    for (std::size_t level = 0; level < numLevels; ++level) {
+        const std::size_t firstSubGraph = static_cast<std::size_t>(levelPointer[level]) - 1;
+        const std::size_t numSubGraphs =
+            static_cast<std::size_t>(levelPointer[level + 1]) - 1 - firstSubGraph;
+        if (numSubGraphs > 0) {
+            solveLevel<<<static_cast<unsigned int>(numSubGraphs), kThreadsPerBlock>>>(
+                devicePlan, firstSubGraph, xData, numRows, numColumns);
+        }
+    }
+
+    plhs[0] = mxGPUCreateMxArrayOnGPU(x);
+    mxGPUDestroyGPUArray(x);
+}
@@ -0,0 +1,135 @@
+// AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONMEX Native forward substitution.
+//
+//   X = AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONMEX(P, B) Solve the
+//   triangular system described by the plan structure P, as returned by
+//   the method "nativePlan" of amsla.common.internal.SolvePlan, with the
+//   right-hand side B. B must be a real, full, double matrix with one row
+//   per row of the plan. Each column of B is a right-hand side.
+//
+//   X = AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONMEX(P, B, T) Use up to T
+//   threads to execute the independent sub-graphs of each level.
+//
+//   X = AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONMEX(P, B, T, TR) If TR is
+//   true, solve the transposed system instead, walking the plan backwards.
+//   The transposed solve always runs on a single thread.
+//
+//   X = AMSLA.COMMON.INTERNAL.FORWARDSUBSTITUTIONMEX(P, B, T, TR, D) If D
+//   is true, start each sub-graph as soon as the sub-graphs it depends on
+//   are done, instead of synchronising the threads at the end of each
+//   level. The plan must have the dependencies between its sub-graphs.
+//
+//   Build with amsla.common.internal.buildNativeKernels.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mex.h"
+
+#include "forwardSubstitution.hpp"
+#include "mexSolvePlan.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+constexpr const char* kBadPlan = "amsla:forwardSubstitutionMex:badPlan";
+
+// Read a logical scalar input, or raise the error errorId.
+bool readFlag(const mxArray* flag, const char* errorId, const char* message) {
+    if (mxGetNumberOfElements(flag) != 1 ||
+        !(mxIsLogical(flag) || amsla::mex::isRealDouble(flag))) {
+        mexErrMsgIdAndTxt(errorId, message);
+    }
+    return mxIsLogicalScalarTrue(flag) || (mxIsDouble(flag) && mxGetPr(flag)[0] != 0);
+}
+
+}  // namespace
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+    if (nrhs < 2 || nrhs > 5) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionMex:badInputs",
+                          "The inputs must be the plan, the right-hand side and, optionally, the number of threads, the transpose flag and the dependency flag.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionMex:badOutputs",
+                          "Only one output is returned.");
+    }
+
+    using amsla::mex::isRealDouble;
+
+    const mxArray* plan = prhs[0];
+    const mxArray* rhs = prhs[1];
+    const amsla::SolvePlanView view = amsla::mex::readSolvePlan(plan, kBadPlan);
+
+    const std::size_t numRows =
+        static_cast<std::size_t>(amsla::mex::getPlanScalar(plan, "NumRows", kBadPlan));
+    if (!isRealDouble(rhs) || mxGetNumberOfDimensions(rhs) != 2 || mxGetM(rhs) != numRows) {
+        mexErrMsgIdAndTxt("amsla:forwardSubstitutionMex:badRhs",
+                          "The right-hand side must be a real double matrix with one row per row of the plan.");
+    }
+    const std::size_t numColumns = mxGetN(rhs);
+
+    std::size_t numThreads = 1;
+    if (nrhs >= 3) {
+        if (!isRealDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1 ||
+            mxGetPr(prhs[2])[0] < 1) {
+            mexErrMsgIdAndTxt("amsla:forwardSubstitutionMex:badNumThreads",
+                              "The number of threads must be a positive scalar.");
+        }
+        numThreads = static_cast<std::size_t>(mxGetPr(prhs[2])[0]);
+    }
+
+    const bool isTranspose = nrhs >= 4 &&
+        readFlag(prhs[3], "amsla:forwardSubstitutionMex:badTranspose",
+                 "The transpose flag must be a logical scalar.");
+    const bool followDependencies = nrhs == 5 &&
+        readFlag(prhs[4], "amsla:forwardSubstitutionMex:badDependencies",
+                 "The dependency flag must be a logical scalar.");
+    if (followDependencies && view.successorPointer == nullptr) {
+        mexErrMsgIdAndTxt(kBadPlan, "The plan has no dependencies between its sub-graphs.");
+    }
+
+    const auto solve = [&view, numThreads, isTranspose, followDependencies](
+                           double* xByRow, std::size_t numColumns) {
+        if (isTranspose) {
+            amsla::backwardSubstitution(view, xByRow, numColumns);
+        } else if (followDependencies) {
+            amsla::forwardSubstitutionByDependencies(view, xByRow, numColumns, numThreads);
+        } else {
+            amsla::forwardSubstitution(view, xByRow, numColumns, numThreads);
+        }
+    };
+
+    plhs[0] = mxDuplicateArray(rhs);
+    double* x = mxGetPr(plhs[0]);
+    if (numColumns == 1) {
+        solve(x, 1);
+    } else {
+        // The kernel reads the right-hand sides of a row contiguously:
+        // transpose from column-major and back.
+        std::vector<double> xByRow(numRows * numColumns);
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            for (std::size_t r = 0; r < numRows; ++r) {
+                xByRow[r * numColumns + c] = x[c * numRows + r];
+            }
+        }
+        solve(xByRow.data(), numColumns);
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            for (std::size_t r = 0; r < numRows; ++r) {
+                x[c * numRows + r] = xByRow[r * numColumns + c];
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// AMSLA solve plan in MEX gateways.
+//
+// Reads a SolvePlanView from the plan structure returned by the method
+// "nativePlan" of amsla.common.internal.SolvePlan. Include after mex.h.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AMSLA_MEXSOLVEPLAN_HPP
+#define AMSLA_MEXSOLVEPLAN_HPP
+
+#include "solvePlanView.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace amsla {
+namespace mex {
+
+inline bool isRealDouble(const mxArray* anArray) {
+    return mxIsDouble(anArray) && !mxIsComplex(anArray) && !mxIsSparse(anArray);
+}
+
+// Get a field of the plan with at least minNumel elements, or raise the
+// error errorId.
+inline const double* getPlanArray(const mxArray* plan, const char* fieldName,
+                                  std::size_t minNumel, const char* errorId) {
+    const mxArray* field = mxGetField(plan, 0, fieldName);
+    if (field == nullptr || !isRealDouble(field) ||
+        mxGetNumberOfElements(field) < minNumel) {
+        const std::string message =
+            std::string("Invalid field \"") + fieldName + "\" in the solve plan.";
+        mexErrMsgIdAndTxt(errorId, message.c_str());
+    }
+    return mxGetPr(field);
+}
+
+inline double getPlanScalar(const mxArray* plan, const char* fieldName, const char* errorId) {
+    return getPlanArray(plan, fieldName, 1, errorId)[0];
+}
+
+// Read the view of a plan structure. The sizes of the arrays are checked
+// against the pointers, and any error is raised with the ID errorId. The
+// unscheduled rows and the dependencies between the sub-graphs are only
+// read if their fields are present.
+inline SolvePlanView readSolvePlan(const mxArray* plan, const char* errorId) {
+    if (!mxIsStruct(plan) || mxGetNumberOfElements(plan) != 1) {
+        mexErrMsgIdAndTxt(errorId, "The plan must be a scalar structure.");
+    }
+
+    SolvePlanView view;
+    view.numLevels = static_cast<std::size_t>(getPlanScalar(plan, "NumLevels", errorId));
+    view.levelPointer = getPlanArray(plan, "LevelPointer", view.numLevels + 1, errorId);
+    const std::size_t numSubGraphs = static_cast<std::size_t>(view.levelPointer[view.numLevels]) - 1;
+    view.subGraphPointer = getPlanArray(plan, "SubGraphPointer", numSubGraphs + 1, errorId);
+    view.numSteps = static_cast<std::size_t>(getPlanScalar(plan, "NumSteps", errorId));
+    view.rowPointer = getPlanArray(plan, "RowPointer", view.numSteps + 1, errorId);
+    const std::size_t numUpdateRows = static_cast<std::size_t>(view.rowPointer[view.numSteps]) - 1;
+    view.updateRows = getPlanArray(plan, "UpdateRows", numUpdateRows, errorId);
+    view.rowEdgePointer = getPlanArray(plan, "RowEdgePointer", numUpdateRows + 1, errorId);
+    const std::size_t numEdges = static_cast<std::size_t>(view.rowEdgePointer[numUpdateRows]) - 1;
+    view.columns = getPlanArray(plan, "Columns", numEdges, errorId);
+    view.weights = getPlanArray(plan, "Weights", numEdges, errorId);
+    view.diagonalPointer = getPlanArray(plan, "DiagonalPointer", view.numSteps + 1, errorId);
+    const std::size_t numDiagonal = static_cast<std::size_t>(view.diagonalPointer[view.numSteps]) - 1;
+    view.diagonalRows = getPlanArray(plan, "DiagonalRows", numDiagonal, errorId);
+    view.inverseDiagonal = getPlanArray(plan, "InverseDiagonal", numDiagonal, errorId);
+    if (mxGetField(plan, 0, "Diagonal") != nullptr) {
+        view.diagonal = getPlanArray(plan, "Diagonal", numDiagonal, errorId);
+    }
+
+    if (mxGetField(plan, 0, "UnscheduledRows") != nullptr) {
+        view.unscheduledRows = getPlanArray(plan, "UnscheduledRows", 0, errorId);
+        view.numUnscheduledRows = mxGetNumberOfElements(mxGetField(plan, 0, "UnscheduledRows"));
+    }
+
+    if (mxGetField(plan, 0, "SuccessorPointer") != nullptr) {
+        view.successorPointer = getPlanArray(plan, "SuccessorPointer", numSubGraphs + 1, errorId);
+        const std::size_t numDependencies =
+            static_cast<std::size_t>(view.successorPointer[numSubGraphs]) - 1;
+        view.successors = getPlanArray(plan, "Successors", numDependencies, errorId);
+        view.numPredecessors = getPlanArray(plan, "NumPredecessors", numSubGraphs, errorId);
+    }
+    return view;
+}
+
+}  // namespace mex
+}  // namespace amsla
+
+#endif  // AMSLA_MEXSOLVEPLAN_HPP
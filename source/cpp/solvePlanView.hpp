@@ -0,0 +1,105 @@
+// AMSLA solve plan.
+//
+// Read-only view of the arrays of an amsla.common.internal.SolvePlan, shared
+// by the native kernels, and the helpers used to execute it. All the index
+// arrays are the ones stored in the plan: they are 1-based and stored as
+// doubles, as they come from MATLAB.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AMSLA_SOLVEPLANVIEW_HPP
+#define AMSLA_SOLVEPLANVIEW_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace amsla {
+
+// Read-only view of the arrays of a solve plan.
+struct SolvePlanView {
+    std::size_t numSteps = 0;
+    std::size_t numLevels = 0;
+
+    // Sub-graphs of each level, and steps of each sub-graph.
+    const double* levelPointer = nullptr;
+    const double* subGraphPointer = nullptr;
+
+    // Update rows of each step, and edges of each update row.
+    const double* rowPointer = nullptr;
+    const double* updateRows = nullptr;
+    const double* rowEdgePointer = nullptr;
+
+    // Non-loop edges.
+    const double* columns = nullptr;
+    const double* weights = nullptr;
+
+    // Sub-graphs that depend on each sub-graph, and number of sub-graphs
+    // each sub-graph depends on. Only used by the dependency-driven
+    // execution, and null if the plan does not have them.
+    const double* successorPointer = nullptr;
+    const double* successors = nullptr;
+    const double* numPredecessors = nullptr;
+
+    // Loop edges of each step. The weights of the loop edges are only
+    // used by the matrix-vector product, and null if the plan does not
+    // have them.
+    const double* diagonalPointer = nullptr;
+    const double* diagonalRows = nullptr;
+    const double* diagonal = nullptr;
+    const double* inverseDiagonal = nullptr;
+
+    // Rows of the unit loop edges that were not scheduled. Only used by
+    // the matrix-vector product.
+    std::size_t numUnscheduledRows = 0;
+    const double* unscheduledRows = nullptr;
+};
+
+namespace internal {
+
+inline std::size_t toIndex(double oneBasedIndex) {
+    return static_cast<std::size_t>(oneBasedIndex) - 1;
+}
+
+// Reusable barrier for a fixed number of threads.
+class Barrier {
+public:
+    explicit Barrier(std::size_t numThreads) : numThreads_(numThreads) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        const std::size_t generation = generation_;
+        if (++numWaiting_ == numThreads_) {
+            numWaiting_ = 0;
+            ++generation_;
+            condition_.notify_all();
+        } else {
+            condition_.wait(lock, [this, generation] { return generation != generation_; });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    const std::size_t numThreads_;
+    std::size_t numWaiting_ = 0;
+    std::size_t generation_ = 0;
+};
+
+}  // namespace internal
+
+}  // namespace amsla
+
+#endif  // AMSLA_SOLVEPLANVIEW_HPP
@@ -0,0 +1,112 @@
+// AMSLA sparse matrix-vector product.
+//
+// Multiplies the matrix stored in an amsla.common.internal.SolvePlan by one
+// or more vectors. The product reads the same arrays as the triangular
+// solve, so the matrix is not stored twice.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef AMSLA_SPARSEMATRIXVECTOR_HPP
+#define AMSLA_SPARSEMATRIXVECTOR_HPP
+
+#include "solvePlanView.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace amsla {
+
+// Accumulate the product of the rows of a sub-graph (0-based position in
+// the plan) into y. x and y are column-major, with numRows rows and
+// numColumns columns. The steps of a sub-graph only contain its own rows,
+// so the columns of x it reads stay close together.
+inline void multiplySubGraph(const SolvePlanView& plan, std::size_t subGraph, const double* x,
+                             double* y, std::size_t numRows, std::size_t numColumns) {
+    using internal::toIndex;
+
+    const std::size_t firstStep = toIndex(plan.subGraphPointer[subGraph]);
+    const std::size_t lastStep = toIndex(plan.subGraphPointer[subGraph + 1]);
+    for (std::size_t step = firstStep; step < lastStep; ++step) {
+        const std::size_t firstRow = toIndex(plan.rowPointer[step]);
+        const std::size_t lastRow = toIndex(plan.rowPointer[step + 1]);
+        for (std::size_t k = firstRow; k < lastRow; ++k) {
+            const std::size_t row = toIndex(plan.updateRows[k]);
+            const std::size_t firstEdge = toIndex(plan.rowEdgePointer[k]);
+            const std::size_t lastEdge = toIndex(plan.rowEdgePointer[k + 1]);
+            for (std::size_t c = 0; c < numColumns; ++c) {
+                const double* xColumn = x + c * numRows;
+                double sum = 0.0;
+                for (std::size_t e = firstEdge; e < lastEdge; ++e) {
+                    sum += plan.weights[e] * xColumn[toIndex(plan.columns[e])];
+                }
+                y[c * numRows + row] += sum;
+            }
+        }
+
+        const std::size_t firstDiagonal = toIndex(plan.diagonalPointer[step]);
+        const std::size_t lastDiagonal = toIndex(plan.diagonalPointer[step + 1]);
+        for (std::size_t d = firstDiagonal; d < lastDiagonal; ++d) {
+            const std::size_t row = toIndex(plan.diagonalRows[d]);
+            for (std::size_t c = 0; c < numColumns; ++c) {
+                y[c * numRows + row] += x[c * numRows + row] * plan.diagonal[d];
+            }
+        }
+    }
+}
+
+// Compute y = A*x, where A is the matrix of the plan. y is overwritten. The
+// sub-graphs write disjoint rows of y and do not depend on each other: they
+// are distributed dynamically across up to numThreads threads, regardless
+// of their level.
+inline void sparseMatrixVector(const SolvePlanView& plan, const double* x, double* y,
+                               std::size_t numRows, std::size_t numColumns,
+                               std::size_t numThreads) {
+    using internal::toIndex;
+
+    std::fill(y, y + numRows * numColumns, 0.0);
+    for (std::size_t u = 0; u < plan.numUnscheduledRows; ++u) {
+        const std::size_t row = toIndex(plan.unscheduledRows[u]);
+        for (std::size_t c = 0; c < numColumns; ++c) {
+            y[c * numRows + row] = x[c * numRows + row];
+        }
+    }
+
+    const std::size_t numSubGraphs = toIndex(plan.levelPointer[plan.numLevels]);
+    numThreads = std::max<std::size_t>(std::min(numThreads, numSubGraphs), 1);
+    std::atomic<std::size_t> nextSubGraph(0);
+    auto worker = [&plan, x, y, numRows, numColumns, numSubGraphs, &nextSubGraph]() {
+        for (std::size_t subGraph = nextSubGraph++; subGraph < numSubGraphs;
+             subGraph = nextSubGraph++) {
+            multiplySubGraph(plan, subGraph, x, y, numRows, numColumns);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (std::size_t k = 1; k < numThreads; ++k) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace amsla
+
+#endif  // AMSLA_SPARSEMATRIXVECTOR_HPP
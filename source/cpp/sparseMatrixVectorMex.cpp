@@ -0,0 +1,82 @@
+// AMSLA.COMMON.INTERNAL.SPARSEMATRIXVECTORMEX Native sparse matrix-vector
+// product.
+//
+//   Y = AMSLA.COMMON.INTERNAL.SPARSEMATRIXVECTORMEX(P, X) Multiply the
+//   matrix described by the plan structure P, as returned by the method
+//   "nativePlan" of amsla.common.internal.SolvePlan, by X. X must be a
+//   real, full, double matrix with one row per row of the plan.
+//
+//   Y = AMSLA.COMMON.INTERNAL.SPARSEMATRIXVECTORMEX(P, X, T) Use up to T
+//   threads. Each sub-graph of the plan is a block of rows, and the blocks
+//   are shared dynamically across the threads.
+//
+//   Build with amsla.common.internal.buildNativeKernels.
+
+// Copyright 2020 Andrea Picciau
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mex.h"
+
+#include "mexSolvePlan.hpp"
+#include "sparseMatrixVector.hpp"
+
+#include <cstddef>
+
+namespace {
+
+constexpr const char* kBadPlan = "amsla:sparseMatrixVectorMex:badPlan";
+
+}  // namespace
+
+void mexFunction(int nlhs, mxArray* plhs[], int nrhs, const mxArray* prhs[]) {
+    if (nrhs < 2 || nrhs > 3) {
+        mexErrMsgIdAndTxt("amsla:sparseMatrixVectorMex:badInputs",
+                          "The inputs must be the plan, the vector and, optionally, the number of threads.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt("amsla:sparseMatrixVectorMex:badOutputs",
+                          "Only one output is returned.");
+    }
+
+    using amsla::mex::isRealDouble;
+
+    const mxArray* plan = prhs[0];
+    const mxArray* x = prhs[1];
+    const amsla::SolvePlanView view = amsla::mex::readSolvePlan(plan, kBadPlan);
+    if (view.diagonal == nullptr) {
+        mexErrMsgIdAndTxt(kBadPlan, "Invalid field \"Diagonal\" in the solve plan.");
+    }
+
+    const std::size_t numRows =
+        static_cast<std::size_t>(amsla::mex::getPlanScalar(plan, "NumRows", kBadPlan));
+    if (!isRealDouble(x) || mxGetNumberOfDimensions(x) != 2 || mxGetM(x) != numRows) {
+        mexErrMsgIdAndTxt("amsla:sparseMatrixVectorMex:badVector",
+                          "The vector must be a real double matrix with one row per row of the plan.");
+    }
+    const std::size_t numColumns = mxGetN(x);
+
+    std::size_t numThreads = 1;
+    if (nrhs == 3) {
+        if (!isRealDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1 ||
+            mxGetPr(prhs[2])[0] < 1) {
+            mexErrMsgIdAndTxt("amsla:sparseMatrixVectorMex:badNumThreads",
+                              "The number of threads must be a positive scalar.");
+        }
+        numThreads = static_cast<std::size_t>(mxGetPr(prhs[2])[0]);
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(numRows, numColumns, mxREAL);
+    amsla::sparseMatrixVector(view, mxGetPr(x), mxGetPr(plhs[0]), numRows, numColumns,
+                              numThreads);
+}
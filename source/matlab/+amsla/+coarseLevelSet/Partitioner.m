@@ -0,0 +1,139 @@
+classdef Partitioner < amsla.levelSet.Partitioner
+    %AMSLA.COARSELEVELSET.PARTITIONER Construct an object that carries out
+    %the partitioning of a matrix according to the level-set algorithm,
+    %then merges runs of thin consecutive levels.
+    %
+    %   A = PARTITIONER(G, W) Partition the sparse matrix defined by the
+    %   DataStructure object G into levels, then merge consecutive levels
+    %   into one sub-graph as long as the sub-graph has at most W elements
+    %   of the matrix. A level with more than W elements stays alone. If W
+    %   is empty, it is 512, about the number of elements a core can
+    %   process in the time of a synchronisation.
+    %
+    %   A = PARTITIONER(__, 'Plot', true) Plot the progress of the
+    %   partitioning algorithm.
+    %
+    %   Each merged sub-graph is executed sequentially, so runs of thin
+    %   levels cost one synchronisation instead of one per level. Deep and
+    %   narrow matrices, like banded matrices, lose little parallelism and
+    %   get much fewer sub-graph levels.
+    %
+    %   Methods of Partitioner:
+    %       partition        - Partitions the matrix according to the
+    %                          level-set algorithm and merges thin levels.
+    %
+    %   See also AMSLA.LEVELSET.PARTITIONER
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(Constant, Access=private)
+        
+        % Number of elements of a merged sub-graph if no size is given.
+        DefaultMaxWork = 512
+        
+    end
+    
+    %% PUBLIC METHDOS
+    
+    methods(Access=public)
+        
+        function obj = Partitioner(dataStructure, varargin)
+            %PARTITIONER Construct an object that executes the analysis of
+            %a matrix according to the coarse level-set algorithm.
+            
+            % The maximum size is used here, unlike in the level-set
+            % algorithm
+            warningState = warning("off", "amsla:levelSet:sizeIgnored");
+            restoreWarning = onCleanup(@() warning(warningState));
+            obj@amsla.levelSet.Partitioner(dataStructure, varargin{:});
+            clear restoreWarning;
+        end
+        
+        function partitioningResult = partition(obj)
+            %PARTITION(A) Partition the graph according to the level-set
+            %algorithm, then merge the thin consecutive levels.
+            
+            partitioningResult = partition@amsla.levelSet.Partitioner(obj);
+            startTime = amsla.common.Tracer.timestamp();
+            obj.mergeThinLevels();
+            amsla.common.Tracer.span("mergeThinLevels", startTime);
+            obj.updateProgressPlot();
+        end
+        
+    end
+    
+    methods(Static)
+        
+        function tf = usesMaxSubGraphSize()
+            %USESMAXSUBGRAPHSIZE The merged levels are limited by the
+            %maximum sub-graph size.
+            
+            tf = true;
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function mergeThinLevels(obj)
+            % Give consecutive levels the same sub-graph ID while their
+            % total number of elements fits in the maximum.
+            
+            maxWork = obj.MaxSubGraphSize;
+            if isempty(maxWork)
+                maxWork = obj.DefaultMaxWork;
+            end
+            
+            nodeIds = obj.DataStructure.listOfNodes();
+            levelOfNode = obj.DataStructure.subGraphOfNode(nodeIds);
+            numLevels = max(levelOfNode);
+            
+            % Each edge is work for the node of its row
+            edgeIds = obj.DataStructure.listOfEdges();
+            rows = obj.DataStructure.exitingNodeOfEdge(edgeIds);
+            [~, rowPosition] = ismember(rows, nodeIds);
+            workOfLevel = accumarray(reshape(levelOfNode(rowPosition), [], 1), 1, [numLevels, 1]);
+            
+            subGraphOfLevel = iMergeRuns(workOfLevel, maxWork);
+            obj.DataStructure.setSubGraphOfNode(nodeIds, ...
+                reshape(subGraphOfLevel(levelOfNode), size(nodeIds)));
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function groupOfItem = iMergeRuns(workOfItem, maxWork)
+% Split a sequence of items into runs whose total work is at most maxWork.
+% An item with more work than that is a run on its own.
+
+numItems = numel(workOfItem);
+groupOfItem = zeros(numItems, 1);
+currentGroup = 0;
+currentWork = Inf;
+for k = 1:numItems
+    if currentWork + workOfItem(k) > maxWork
+        currentGroup = currentGroup + 1;
+        currentWork = 0;
+    end
+    groupOfItem(k) = currentGroup;
+    currentWork = currentWork + workOfItem(k);
+end
+end
@@ -0,0 +1,167 @@
+classdef AnalysisCache
+    %AMSLA.COMMON.INTERNAL.ANALYSISCACHE Store the results of the analysis
+    %of sparse matrices on disk.
+    %
+    %   C = AMSLA.COMMON.INTERNAL.ANALYSISCACHE(F) Create a cache that reads
+    %   and writes MAT-files in the folder F. The folder is created if it
+    %   does not exist.
+    %
+    %   Each entry holds the sub-graph of every node, the time-slot of every
+    %   edge, and the table of sub-graph levels of a matrix. Entries are
+    %   keyed by a SHA-256 hash of the sparsity pattern of the matrix, its
+    %   format and the maximum sub-graph size used to analyse it.
+    %
+    %   AnalysisCache methods:
+    %      keyOf    - The key of the analysis of a DataStructure.
+    %      load     - Load the analysis of a key, if it is in the cache.
+    %      restore  - Apply a cached analysis to a DataStructure.
+    %      save     - Store the analysis of a DataStructure.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(Constant, Access=private)
+        
+        % Version of the layout of the entries. Changing it invalidates all
+        % the existing entries.
+        Version = "1"
+        
+    end
+    
+    properties(GetAccess=public, SetAccess=immutable)
+        
+        %Folder containing the MAT-files of the cache.
+        Folder
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Access=public)
+        
+        function obj = AnalysisCache(folder)
+            %ANALYSISCACHE Construct a cache in a folder.
+            
+            validateattributes(folder, {'string', 'char'}, {'nonempty', 'scalartext'});
+            obj.Folder = string(folder);
+            if ~isfolder(obj.Folder)
+                mkdir(obj.Folder);
+            end
+        end
+        
+        function key = keyOf(obj, aDataStructure, format, maxSize)
+            %KEYOF(C, G, FORMAT, MAXSIZE) Compute the key of the analysis
+            %of the DataStructure G in the format FORMAT, with maximum
+            %sub-graph size MAXSIZE.
+            
+            edgeIds = aDataStructure.listOfEdges();
+            rows = double(aDataStructure.exitingNodeOfEdge(edgeIds));
+            columns = double(aDataStructure.enteringNodeOfEdge(edgeIds));
+            numNodes = numel(aDataStructure.listOfNodes());
+            
+            header = strjoin([ ...
+                "amsla", obj.Version, string(format), ...
+                iSizeToString(maxSize), string(numNodes)], ":");
+            
+            digest = java.security.MessageDigest.getInstance("SHA-256");
+            digest.update(unicode2native(char(header), "UTF-8"));
+            digest.update(typecast(reshape(rows, [], 1), "int8"));
+            digest.update(typecast(reshape(columns, [], 1), "int8"));
+            hashBytes = typecast(int8(digest.digest()), "uint8");
+            key = lower(string(reshape(dec2hex(hashBytes, 2)', 1, [])));
+        end
+        
+        function [isCached, entry] = load(obj, key)
+            %LOAD(C, K) Load the entry with key K. Return false if the
+            %entry is not in the cache.
+            
+            fileName = obj.fileOf(key);
+            isCached = isfile(fileName);
+            entry = [];
+            if isCached
+                loaded = load(fileName, "entry");
+                entry = loaded.entry;
+                isCached = isfield(entry, "Version") && entry.Version==obj.Version;
+            end
+        end
+        
+        function save(obj, key, aDataStructure, subGraphLevelsTable)
+            %SAVE(C, K, G, T) Store the sub-graphs and time-slots of the
+            %DataStructure G, and its table of sub-graph levels T, with the
+            %key K.
+            
+            entry = struct( ...
+                "Version", obj.Version, ...
+                "SubGraphOfNode", aDataStructure.subGraphOfNode(aDataStructure.listOfNodes()), ...
+                "TimeSlotOfEdge", aDataStructure.timeSlotOfEdge(aDataStructure.listOfEdges()), ...
+                "SubGraphLevelsTable", subGraphLevelsTable); %#ok<NASGU>
+            
+            % Write to a temporary file first, so that concurrent readers
+            % never see a partial entry.
+            fileName = obj.fileOf(key);
+            temporaryName = fileName + "." + string(feature("getpid")) + ".tmp";
+            save(temporaryName, "entry", "-v7");
+            movefile(temporaryName, fileName, "f");
+        end
+        
+    end
+    
+    methods(Static)
+        
+        function subGraphLevelsTable = restore(entry, aDataStructure)
+            %RESTORE(E, G) Apply the sub-graphs and time-slots of the
+            %entry E to the DataStructure G. Return the table of sub-graph
+            %levels of the entry.
+            
+            nodeIds = aDataStructure.listOfNodes();
+            edgeIds = aDataStructure.listOfEdges();
+            assert(numel(entry.SubGraphOfNode)==numel(nodeIds) && ...
+                numel(entry.TimeSlotOfEdge)==numel(edgeIds), ...
+                "amsla:AnalysisCache:sizeMismatch", ...
+                "The cached analysis does not match the size of the matrix.");
+            
+            aDataStructure.setSubGraphOfNode(nodeIds, entry.SubGraphOfNode);
+            aDataStructure.setTimeSlotOfEdge(edgeIds, entry.TimeSlotOfEdge);
+            subGraphLevelsTable = entry.SubGraphLevelsTable;
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function fileName = fileOf(obj, key)
+            % Name of the MAT-file of a key.
+            
+            fileName = fullfile(obj.Folder, "analysis_" + key + ".mat");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function str = iSizeToString(maxSize)
+% Convert the maximum sub-graph size to a string, including the case in
+% which it was not specified.
+
+if isempty(maxSize)
+    str = "default";
+else
+    str = string(num2str(double(maxSize), 17));
+end
+end
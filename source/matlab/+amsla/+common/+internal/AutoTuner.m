@@ -0,0 +1,280 @@
+classdef AutoTuner
+    %AMSLA.COMMON.INTERNAL.AUTOTUNER Choose the format and the maximum
+    %sub-graph size of a sparse matrix for the current processor.
+    %
+    %   T = AMSLA.COMMON.INTERNAL.AUTOTUNER() Create an auto-tuner. The
+    %   properties of the processor are measured with
+    %   amsla.common.internal.machineProfile.
+    %
+    %   T = AMSLA.COMMON.INTERNAL.AUTOTUNER('NumTrials', N) Run N trial
+    %   solves for each of the most promising configurations. The default
+    %   is 3.
+    %
+    %   T = AMSLA.COMMON.INTERNAL.AUTOTUNER('UseStored', false) Always
+    %   search, even if a configuration was stored for a matrix with a
+    %   similar structure.
+    %
+    %   T = AMSLA.COMMON.INTERNAL.AUTOTUNER('Compact', true) Analyse the
+    %   matrices with their data structure in compact layout. See
+    %   amsla.SparseMatrix.
+    %
+    %   The tuner first analyses the matrix in each format. Formats whose
+    %   partitioner does not use a maximum sub-graph size, as stated by its
+    %   static method usesMaxSubGraphSize, are analysed once. The others are
+    %   analysed with the sizes whose working set fits in the L1, L2 and
+    %   last-level cache of a core. The analyses are ranked by the time
+    %   predicted by amsla.common.internal.ScheduleSimulator, and the best
+    %   ones are timed with trial solves. The fastest configuration
+    %   is stored with setpref, keyed by the size, density and bandwidth
+    %   of the matrix.
+    %
+    %   AutoTuner methods:
+    %      tune              - Choose the configuration of a matrix.
+    %      forgetStored      - Remove all the stored configurations.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(Constant, Access=private)
+        
+        % Group and name of the preference storing the configurations.
+        PreferenceGroup = "amsla"
+        PreferenceName = "AutoTunerConfigurations"
+        
+        % Number of configurations timed with trial solves.
+        NumCandidatesToTry = 2
+        
+        % Bytes read for each element of the matrix: value, column index
+        % and entry of the solution.
+        BytesPerElement = 24
+        
+        % Bytes read and written for each row: right-hand side and
+        % solution.
+        BytesPerRow = 16
+        
+    end
+    
+    properties(GetAccess=public, SetAccess=immutable)
+        
+        %Number of trial solves of each candidate configuration.
+        NumTrials
+        
+        %Whether stored configurations are reused.
+        UseStored
+        
+        %Whether the analysed matrices use the compact layout.
+        Compact
+        
+        %Properties of the processor.
+        MachineProfile
+        
+    end
+    
+    properties(Access=private)
+        
+        %Simulator that predicts the time of the solve of an analysis.
+        Simulator
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Access=public)
+        
+        function obj = AutoTuner(varargin)
+            %AUTOTUNER Construct an auto-tuner.
+            
+            parser = inputParser;
+            addParameter(parser, 'NumTrials', 3, ...
+                @(x) isnumeric(x) && isscalar(x) && x>=1 && x==round(x));
+            addParameter(parser, 'UseStored', true, @(x) islogical(x) && isscalar(x));
+            addParameter(parser, 'Compact', false, @(x) islogical(x) && isscalar(x));
+            parse(parser, varargin{:});
+            
+            obj.NumTrials = parser.Results.NumTrials;
+            obj.UseStored = parser.Results.UseStored;
+            obj.Compact = parser.Results.Compact;
+            obj.MachineProfile = amsla.common.internal.machineProfile();
+            obj.Simulator = amsla.common.internal.ScheduleSimulator( ...
+                "NumCores", obj.MachineProfile.NumCores, ...
+                "L2CacheSize", obj.MachineProfile.L2CacheSize, ...
+                "LLCacheSize", obj.MachineProfile.LLCacheSize, ...
+                "Bandwidth", obj.MachineProfile.Bandwidth);
+        end
+        
+        function [format, maxSize, matrix] = tune(obj, rows, columns, values, formats)
+            %TUNE(T, I, J, V, F) Choose the format among F, and the maximum
+            %sub-graph size, of the matrix with elements V in rows I and
+            %columns J. MAXSIZE is empty if the format does not use it.
+            %
+            %   [FORMAT, MAXSIZE, M] = TUNE(__) Also return the
+            %   amsla.SparseMatrix analysed with the chosen configuration.
+            %   M is empty if the configuration was stored, as the matrix
+            %   was not analysed.
+            
+            matrix = [];
+            key = iStructureKey(rows, columns);
+            if obj.UseStored
+                [isStored, format, maxSize] = obj.storedConfiguration(key, formats);
+                if isStored
+                    return;
+                end
+            end
+            
+            candidates = obj.analyseCandidates(rows, columns, values, formats);
+            [~, ranking] = sort([candidates.PredictedTime]);
+            candidates = candidates(ranking(1:min(obj.NumCandidatesToTry, end)));
+            
+            numRows = max([rows(:); columns(:)]);
+            rhs = ones(numRows, 1);
+            for k = 1:numel(candidates)
+                candidates(k).MeasuredTime = obj.trialTime(candidates(k).Matrix, rhs);
+            end
+            [~, best] = min([candidates.MeasuredTime]);
+            format = candidates(best).Format;
+            maxSize = candidates(best).MaxSize;
+            matrix = candidates(best).Matrix;
+            
+            obj.storeConfiguration(key, format, maxSize);
+        end
+        
+    end
+    
+    methods(Static)
+        
+        function forgetStored()
+            %FORGETSTORED Remove all the configurations stored by the
+            %auto-tuner.
+            
+            group = amsla.common.internal.AutoTuner.PreferenceGroup;
+            name = amsla.common.internal.AutoTuner.PreferenceName;
+            if ispref(group, name)
+                rmpref(group, name);
+            end
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function candidates = analyseCandidates(obj, rows, columns, values, formats)
+            % Analyse the matrix with every candidate configuration and
+            % predict the time of its solve.
+            
+            candidates = struct("Format", {}, "MaxSize", {}, "Matrix", {}, ...
+                "PredictedTime", {}, "MeasuredTime", {});
+            numRows = max([rows(:); columns(:)]);
+            sizes = obj.candidateSizes(numRows, numel(values));
+            
+            for format = reshape(string(formats), 1, [])
+                if iUsesMaxSubGraphSize(format)
+                    formatSizes = num2cell(sizes);
+                else
+                    formatSizes = {[]};
+                end
+                for k = 1:numel(formatSizes)
+                    matrix = amsla.SparseMatrix(rows, columns, values, format, ...
+                        "Compact", obj.Compact);
+                    [matrix, result] = matrix.analyse(formatSizes{k});
+                    candidates(end+1) = struct( ...
+                        "Format", format, ...
+                        "MaxSize", formatSizes{k}, ...
+                        "Matrix", matrix, ...
+                        "PredictedTime", obj.predictTime(result), ...
+                        "MeasuredTime", Inf); %#ok<AGROW>
+                end
+            end
+        end
+        
+        function sizes = candidateSizes(obj, numRows, numElements)
+            % Sub-graph sizes whose working set fits in each level of cache
+            % of a core.
+            
+            bytesPerRow = obj.BytesPerRow + obj.BytesPerElement*numElements/numRows;
+            profile = obj.MachineProfile;
+            cacheSizes = [profile.L1CacheSize, profile.L2CacheSize, ...
+                profile.LLCacheSize/max(profile.NumCores, 1)];
+            sizes = unique(min(2.^floor(log2(cacheSizes/bytesPerRow)), numRows));
+            sizes = max(sizes, 1);
+        end
+        
+        function time = predictTime(obj, result)
+            % Predict the time of a solve by simulating its schedule.
+            
+            prediction = obj.Simulator.simulate(result);
+            time = prediction.TotalTime;
+        end
+        
+        function time = trialTime(obj, matrix, rhs)
+            % Best time of a few solves.
+            
+            time = Inf;
+            for k = 1:obj.NumTrials
+                solveTimer = tic();
+                matrix.solve(rhs);
+                time = min(time, toc(solveTimer));
+            end
+        end
+        
+        function [isStored, format, maxSize] = storedConfiguration(obj, key, formats)
+            % Look up the configuration stored for a structure key.
+            
+            isStored = false;
+            format = "";
+            maxSize = [];
+            configurations = getpref(obj.PreferenceGroup, obj.PreferenceName, struct());
+            if isfield(configurations, key) && ...
+                    any(strcmpi(configurations.(key).Format, formats))
+                isStored = true;
+                format = string(configurations.(key).Format);
+                maxSize = configurations.(key).MaxSize;
+            end
+        end
+        
+        function storeConfiguration(obj, key, format, maxSize)
+            % Store the configuration chosen for a structure key.
+            
+            configurations = getpref(obj.PreferenceGroup, obj.PreferenceName, struct());
+            configurations.(key) = struct("Format", char(format), "MaxSize", maxSize);
+            setpref(obj.PreferenceGroup, obj.PreferenceName, configurations);
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function key = iStructureKey(rows, columns)
+% Matrices with the same key have similar structure: the same number of
+% rows, elements per row and distance from the diagonal, up to a factor of
+% two.
+
+numRows = max([rows(:); columns(:)]);
+numElements = numel(rows);
+meanBandwidth = mean(abs(double(rows(:))-double(columns(:))));
+key = sprintf("rows%d_density%d_bandwidth%d", ...
+    round(log2(numRows)), ...
+    round(log2(numElements/numRows)), ...
+    round(log2(meanBandwidth+1)));
+end
+
+function tf = iUsesMaxSubGraphSize(format)
+% Ask the partitioner of a format whether it uses a maximum sub-graph size.
+
+tf = feval("amsla." + format + ".Partitioner.usesMaxSubGraphSize");
+end
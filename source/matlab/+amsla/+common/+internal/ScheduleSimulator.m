@@ -0,0 +1,222 @@
+classdef ScheduleSimulator
+    %AMSLA.COMMON.INTERNAL.SCHEDULESIMULATOR Predict the time of the
+    %triangular solve of an analysed matrix on a given machine.
+    %
+    %   S = AMSLA.COMMON.INTERNAL.SCHEDULESIMULATOR() Create a simulator of
+    %   the current processor, as measured by
+    %   amsla.common.internal.machineProfile.
+    %
+    %   S = AMSLA.COMMON.INTERNAL.SCHEDULESIMULATOR(Name, Value) Describe a
+    %   different machine. The names are:
+    %      NumCores      - Number of cores.
+    %      L2CacheSize   - Size of the level-2 cache of a core, in bytes.
+    %      LLCacheSize   - Size of the last-level cache, in bytes.
+    %      Bandwidth     - Memory bandwidth, in bytes per second.
+    %      CoreBandwidth - Largest bandwidth that one core can use, in
+    %                      bytes per second. The default is Bandwidth
+    %                      divided by NumCores.
+    %      BarrierCost   - Time of the synchronisation at the end of a
+    %                      sub-graph level, in seconds. The default is 1e-6.
+    %   The properties that are not given are those of the current
+    %   processor.
+    %
+    %   The simulator replays the schedule, one sub-graph level at a time.
+    %   The sub-graphs of a level are taken in order by the first core that
+    %   is free, and each sub-graph runs on one core. A sub-graph reads its
+    %   values, column indices, right-hand side and solution from memory,
+    %   and the cores that work on the same level share the bandwidth, up
+    %   to the bandwidth of a core. The entries of the solution read by a
+    %   sub-graph come from the cache if they fit: those of the sub-graph
+    %   itself in the level-2 cache, those of earlier sub-graphs in the
+    %   last-level cache. Each level ends with a barrier.
+    %
+    %   ScheduleSimulator methods:
+    %      simulate          - Predict the time of the solve of a schedule.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(Constant, Access=private)
+        
+        % Bytes streamed for each element of the matrix: value and column
+        % index.
+        BytesPerElement = 16
+        
+        % Bytes read for each entry of the solution that is not in the
+        % cache.
+        BytesPerSolutionEntry = 8
+        
+        % Bytes read and written for each row: right-hand side and
+        % solution.
+        BytesPerRow = 16
+        
+    end
+    
+    properties(GetAccess=public, SetAccess=immutable)
+        
+        %Properties of the simulated machine.
+        Machine
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Access=public)
+        
+        function obj = ScheduleSimulator(varargin)
+            %SCHEDULESIMULATOR Construct a schedule simulator.
+            
+            isPositiveScalar = @(x) isnumeric(x) && isscalar(x) && x>0;
+            parser = inputParser;
+            addParameter(parser, 'NumCores', [], ...
+                @(x) isPositiveScalar(x) && x==round(x));
+            addParameter(parser, 'L2CacheSize', [], isPositiveScalar);
+            addParameter(parser, 'LLCacheSize', [], isPositiveScalar);
+            addParameter(parser, 'Bandwidth', [], isPositiveScalar);
+            addParameter(parser, 'CoreBandwidth', [], isPositiveScalar);
+            addParameter(parser, 'BarrierCost', 1e-6, @(x) isnumeric(x) && isscalar(x) && x>=0);
+            parse(parser, varargin{:});
+            
+            machine = parser.Results;
+            profileFields = ["NumCores", "L2CacheSize", "LLCacheSize", "Bandwidth"];
+            isMissing = arrayfun(@(f) isempty(machine.(f)), profileFields);
+            if any(isMissing)
+                profile = amsla.common.internal.machineProfile();
+                for fieldName = profileFields(isMissing)
+                    machine.(fieldName) = profile.(fieldName);
+                end
+            end
+            if isempty(machine.CoreBandwidth)
+                machine.CoreBandwidth = machine.Bandwidth/machine.NumCores;
+            end
+            obj.Machine = machine;
+        end
+        
+        function prediction = simulate(obj, varargin)
+            %SIMULATE Predict the time of the solve of a schedule.
+            %
+            %   P = SIMULATE(S, G) Simulate the solve of the DataStructure G,
+            %   which has been partitioned and scheduled.
+            %
+            %   P = SIMULATE(S, G, T) Use the sub-graph levels in the table T
+            %   computed by amsla.common.internal.findSubGraphLevels.
+            %
+            %   P = SIMULATE(S, R) Simulate the schedule described by the
+            %   amsla.common.PartitioningResult R.
+            %
+            %   P is a structure with the fields:
+            %      TotalTime     - Predicted time of the solve, in seconds.
+            %      Levels        - Table with one row per sub-graph level and
+            %                      the variables:
+            %         NumSubGraphs  - Number of sub-graphs in the level.
+            %         NumCores      - Number of cores that work on it.
+            %         Work          - Sum of the times of its sub-graphs.
+            %         Time          - Time from the start of the level to
+            %                         the end of its barrier.
+            %         Imbalance     - Time of the busiest core over the
+            %                         average time of the cores, from 1
+            %                         for a perfectly balanced level.
+            
+            result = iPartitioningResult(varargin{:});
+            subGraphTimes = obj.subGraphTimes(result);
+            
+            numLevels = result.NumLevels;
+            numSubGraphs = result.ParallelismPerLevel;
+            numCores = min(numSubGraphs, obj.Machine.NumCores);
+            work = zeros(numLevels, 1);
+            busiestCore = zeros(numLevels, 1);
+            for k = 1:numLevels
+                levelTimes = subGraphTimes(result.LevelOfSubGraph==k);
+                work(k) = sum(levelTimes);
+                busiestCore(k) = iListSchedule(levelTimes, numCores(k));
+            end
+            time = busiestCore + obj.Machine.BarrierCost;
+            imbalance = busiestCore./(work./numCores);
+            imbalance(work==0) = 1;
+            
+            prediction.TotalTime = sum(time);
+            prediction.Levels = table(numSubGraphs, numCores, work, time, imbalance, ...
+                'VariableNames', {'NumSubGraphs', 'NumCores', 'Work', 'Time', 'Imbalance'});
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function times = subGraphTimes(obj, result)
+            % Time each sub-graph takes on one core, when it shares the
+            % bandwidth with the other cores that work on its level.
+            
+            machine = obj.Machine;
+            numRows = result.SubGraphSizes;
+            numEdges = result.EdgesPerSubGraph;
+            numExternalEdges = result.ExternalEdgesPerSubGraph;
+            numInternalEdges = max(numEdges - numExternalEdges - numRows, 0);
+            
+            bytes = obj.BytesPerElement*numEdges + obj.BytesPerRow*numRows;
+            isInL2Cache = bytes + obj.BytesPerSolutionEntry*numRows <= machine.L2CacheSize;
+            missedEntries = numInternalEdges.*~isInL2Cache;
+            if obj.BytesPerSolutionEntry*sum(numRows) > machine.LLCacheSize
+                missedEntries = missedEntries + numExternalEdges;
+            end
+            bytes = bytes + obj.BytesPerSolutionEntry*missedEntries;
+            
+            coresOnLevel = min(result.ParallelismPerLevel, machine.NumCores);
+            bandwidth = min(machine.Bandwidth./coresOnLevel(result.LevelOfSubGraph), ...
+                machine.CoreBandwidth);
+            times = bytes./reshape(bandwidth, [], 1);
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function result = iPartitioningResult(varargin)
+% Statistics of the schedule to simulate.
+
+if isa(varargin{1}, 'amsla.common.PartitioningResult')
+    result = varargin{1};
+    return;
+end
+
+aDataStructure = varargin{1};
+if nargin>1
+    subGraphLevelsTable = varargin{2};
+else
+    subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(aDataStructure);
+end
+result = amsla.common.PartitioningResult(true, aDataStructure, subGraphLevelsTable);
+end
+
+function busiestCore = iListSchedule(times, numCores)
+% Give each task, in order, to the core that becomes free first, and return
+% the time at which the last core finishes.
+
+if numel(times)<=numCores
+    busiestCore = max([0; times(:)]);
+    return;
+end
+
+coreTimes = zeros(numCores, 1);
+for k = 1:numel(times)
+    [earliest, core] = min(coreTimes);
+    coreTimes(core) = earliest + times(k);
+end
+busiestCore = max(coreTimes);
+end
@@ -0,0 +1,625 @@
+classdef SolvePlan
+    %AMSLA.COMMON.INTERNAL.SOLVEPLAN Flat execution plan for the
+    %triangular solve of a partitioned and scheduled DataStructure.
+    %
+    %   P = AMSLA.COMMON.INTERNAL.SOLVEPLAN(G) Compile the plan of the
+    %   DataStructure G. G must have been partitioned into sub-graphs and
+    %   its edges must have been assigned to time-slots.
+    %
+    %   P = AMSLA.COMMON.INTERNAL.SOLVEPLAN(G, T) Use the table of sub-graph
+    %   levels T, as computed by amsla.common.internal.findSubGraphLevels,
+    %   instead of computing it again.
+    %
+    %   The plan is a sequence of steps, one per time-slot of each
+    %   sub-graph. Steps are ordered by sub-graph level, then by sub-graph,
+    %   then by time-slot. Each step first subtracts the contributions of
+    %   the non-loop edges from their rows, then scales the rows of the
+    %   loop edges by the reciprocal of the diagonal. All the reads in a
+    %   step use the values computed before the step.
+    %
+    %   The plan also keeps the dependencies between the sub-graphs, so
+    %   that a sub-graph can be executed as soon as the sub-graphs it
+    %   depends on are done, without waiting for the rest of the level.
+    %
+    %   The last steps of a sub-graph can be marked as a dense block with
+    %   markDenseBlocks. The block is then executed with dense triangular
+    %   solves and matrix products instead of its steps.
+    %
+    %   SolvePlan methods:
+    %      applyLevel     - Execute all the steps in a sub-graph level.
+    %      applyLevelTranspose - Execute the transposes of the steps in a
+    %                       sub-graph level, in reverse order.
+    %      multiply       - Multiply the matrix of the plan by a vector.
+    %      reorder        - Renumber the rows so that each sub-graph is
+    %                       contiguous.
+    %      markDenseBlocks - Execute the dense blocks at the end of the
+    %                       sub-graphs with dense kernels.
+    %      toSinglePrecision - Store the weights in single precision.
+    %      toPlanOrder    - Permute a vector to the numbering of the plan.
+    %      fromPlanOrder  - Permute a vector back to the original numbering.
+    %      stepsInLevel   - The range of steps in a sub-graph level.
+    %      nativePlan     - The plan arrays used by the native kernels.
+    %      updateWeights  - Change the weights of the edges in the plan.
+    %      onDevice       - Move the data of the plan to the GPU.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(GetAccess=public, SetAccess=private)
+        
+        %Number of rows of the matrix.
+        NumRows
+        
+        %Number of sub-graph levels.
+        NumLevels
+        
+        %Number of steps.
+        NumSteps
+        
+        %Sub-graphs in each level: the sub-graphs of level L are
+        %SubGraphIds(LevelPointer(L):LevelPointer(L+1)-1).
+        LevelPointer
+        
+        %Sub-graph IDs, sorted by level and then by ID.
+        SubGraphIds
+        
+        %Steps of each sub-graph: the steps of the K-th sub-graph in
+        %SubGraphIds are SubGraphPointer(K):SubGraphPointer(K+1)-1.
+        SubGraphPointer
+        
+        %Dependencies between the sub-graphs, as positions in SubGraphIds:
+        %the sub-graphs that depend on the K-th sub-graph are
+        %Successors(SuccessorPointer(K):SuccessorPointer(K+1)-1), and
+        %NumPredecessors(K) is the number of sub-graphs it depends on.
+        SuccessorPointer
+        Successors
+        NumPredecessors
+        
+        %Time-slot ID of each step.
+        TimeSlotIds
+        
+        %Rows updated by the non-loop edges of each step: the rows of step
+        %S are UpdateRows(RowPointer(S):RowPointer(S+1)-1).
+        RowPointer
+        UpdateRows
+        
+        %Non-loop edges of each update row: the edges of the K-th row in
+        %UpdateRows are RowEdgePointer(K):RowEdgePointer(K+1)-1.
+        RowEdgePointer
+        
+        %Non-loop edges of each step: the edges of step S are in positions
+        %EdgePointer(S):EdgePointer(S+1)-1 of LocalRows, Columns, Weights
+        %and EdgeIds. LocalRows are relative to the rows of the step.
+        EdgePointer
+        LocalRows
+        Columns
+        Weights
+        EdgeIds
+        
+        %Loop edges of each step: the loop edges of step S are in
+        %positions DiagonalPointer(S):DiagonalPointer(S+1)-1 of
+        %DiagonalRows, Diagonal, InverseDiagonal and DiagonalEdgeIds. The
+        %solve uses the reciprocals, the product the weights themselves.
+        DiagonalPointer
+        DiagonalRows
+        Diagonal
+        InverseDiagonal
+        DiagonalEdgeIds
+        
+        %Edges that were not assigned to a time-slot and do not take part
+        %in the solve. These are loops with unit weight, and
+        %UnscheduledRows are their rows.
+        UnscheduledEdgeIds
+        UnscheduledRows
+        
+        %Original row of each row of the plan, or empty if the rows have
+        %not been renumbered. All the rows and columns stored in the plan
+        %are in the new numbering.
+        Permutation
+        
+        %Dense blocks at the end of the sub-graphs, as found by
+        %amsla.common.internal.findDenseBlocks. DenseBlockOfSubGraph(K) is
+        %the index of the block of the K-th sub-graph in SubGraphIds, or 0
+        %if it has none.
+        DenseBlocks
+        DenseBlockOfSubGraph
+        
+        %Lower-triangular matrix and panel of each dense block, with the
+        %weights of its edges.
+        DenseTriangles
+        DensePanels
+        
+        %Class of the weights stored in the plan, "double" or "single".
+        %The weights are converted to the class of the right-hand side
+        %when they are used.
+        ValueClass
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Access=public)
+        
+        function obj = SolvePlan(aDataStructure, subGraphLevelsTable)
+            %SOLVEPLAN Compile the execution plan of a DataStructure.
+            
+            validateattributes(aDataStructure, ...
+                {'amsla.common.DataStructureInterface'}, ...
+                {'scalar', 'nonempty'});
+            if nargin<2 || isempty(subGraphLevelsTable)
+                subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(aDataStructure);
+            end
+            
+            obj = obj.compileSubGraphs(aDataStructure, subGraphLevelsTable);
+            obj = obj.compileSteps(aDataStructure);
+            
+            obj.DenseBlocks = struct([]);
+            obj.DenseBlockOfSubGraph = zeros(numel(obj.SubGraphIds), 1);
+            obj.DenseTriangles = {};
+            obj.DensePanels = {};
+            obj.ValueClass = "double";
+        end
+        
+        function x = applyLevel(obj, x, levelId)
+            %APPLYLEVEL(P, X, L) Execute the steps of level L on the columns
+            %of X.
+            
+            if isempty(obj.DenseBlocks)
+                for s = obj.stepsInLevel(levelId)
+                    x = obj.applyStep(x, s);
+                end
+                return;
+            end
+            
+            for k = obj.LevelPointer(levelId):(obj.LevelPointer(levelId+1)-1)
+                [stepIds, blockId] = obj.stepsOfSubGraph(k);
+                for s = stepIds
+                    x = obj.applyStep(x, s);
+                end
+                if blockId>0
+                    x = obj.applyDenseBlock(x, blockId);
+                end
+            end
+        end
+        
+        function x = applyLevelTranspose(obj, x, levelId)
+            %APPLYLEVELTRANSPOSE(P, X, L) Execute the transposes of the steps
+            %of level L on the columns of X, from the last to the first.
+            %Executing all the levels from the last to the first solves the
+            %transposed system.
+            
+            if isempty(obj.DenseBlocks)
+                for s = fliplr(obj.stepsInLevel(levelId))
+                    x = obj.applyStepTranspose(x, s);
+                end
+                return;
+            end
+            
+            for k = (obj.LevelPointer(levelId+1)-1):-1:obj.LevelPointer(levelId)
+                [stepIds, blockId] = obj.stepsOfSubGraph(k);
+                if blockId>0
+                    x = obj.applyDenseBlockTranspose(x, blockId);
+                end
+                for s = fliplr(stepIds)
+                    x = obj.applyStepTranspose(x, s);
+                end
+            end
+        end
+        
+        function y = multiply(obj, x)
+            %MULTIPLY(P, X) Multiply the matrix of the plan by the columns of
+            %X. The product reads the arrays of the plan, so the matrix is
+            %not stored a second time.
+            
+            numColumns = size(x, 2);
+            rowOfEdge = repelem(obj.UpdateRows, diff(obj.RowEdgePointer));
+            contributions = cast(obj.Weights, 'like', x).*x(obj.Columns, :);
+            subscripts = [ ...
+                repmat(rowOfEdge, numColumns, 1), ...
+                repelem((1:numColumns)', numel(rowOfEdge))];
+            y = accumarray(subscripts, contributions(:), [obj.NumRows, numColumns]);
+            
+            rows = obj.DiagonalRows;
+            y(rows, :) = y(rows, :) + x(rows, :).*cast(obj.Diagonal, 'like', x);
+            rows = obj.UnscheduledRows;
+            y(rows, :) = y(rows, :) + x(rows, :);
+        end
+        
+        function obj = reorder(obj)
+            %REORDER(P) Renumber the rows and columns of the plan, so that
+            %the rows of each sub-graph are contiguous and sorted by the
+            %step that computes them. Rows that are never updated are
+            %placed first. Use toPlanOrder and fromPlanOrder to convert
+            %right-hand sides and solutions.
+            
+            stepOfUpdateRow = repelem((1:obj.NumSteps)', diff(obj.RowPointer));
+            stepOfDiagonalRow = repelem((1:obj.NumSteps)', diff(obj.DiagonalPointer));
+            lastStepOfRow = accumarray([obj.UpdateRows; obj.DiagonalRows], ...
+                [stepOfUpdateRow; stepOfDiagonalRow], [obj.NumRows, 1], @max, 0);
+            
+            [~, permutation] = sort(lastStepOfRow);
+            newRowOf = zeros(obj.NumRows, 1);
+            newRowOf(permutation) = 1:obj.NumRows;
+            for fieldName = ["UpdateRows", "Columns", "DiagonalRows", "UnscheduledRows"]
+                obj.(fieldName) = newRowOf(obj.(fieldName));
+            end
+            for b = 1:numel(obj.DenseBlocks)
+                obj.DenseBlocks(b).Rows = newRowOf(obj.DenseBlocks(b).Rows);
+                obj.DenseBlocks(b).Columns = newRowOf(obj.DenseBlocks(b).Columns);
+            end
+            
+            % Compose with a previous renumbering.
+            if isempty(obj.Permutation)
+                obj.Permutation = permutation;
+            else
+                obj.Permutation = obj.Permutation(permutation);
+            end
+        end
+        
+        function obj = markDenseBlocks(obj, varargin)
+            %MARKDENSEBLOCKS(P) Find the dense blocks at the end of the
+            %sub-graphs, and execute them with dense kernels in applyLevel
+            %and applyLevelTranspose. The steps of the blocks stay in the
+            %plan, so the native kernels are not affected.
+            %
+            %   P = MARKDENSEBLOCKS(P, NAME, VALUE) Pass the options NAME
+            %   and VALUE to amsla.common.internal.findDenseBlocks.
+            
+            [obj.DenseBlocks, obj.DenseBlockOfSubGraph] = ...
+                amsla.common.internal.findDenseBlocks(obj, varargin{:});
+            
+            edgeWeights = zeros(max([0; obj.EdgeIds; obj.DiagonalEdgeIds]), 1);
+            edgeWeights(obj.EdgeIds) = obj.Weights;
+            edgeWeights(obj.DiagonalEdgeIds) = obj.Diagonal;
+            obj = obj.fillDenseBlocks(edgeWeights);
+            obj = obj.castValues();
+        end
+        
+        function obj = toSinglePrecision(obj)
+            %TOSINGLEPRECISION(P) Store the weights, the diagonal, its
+            %reciprocals and the dense blocks in single precision. Solving
+            %with single right-hand sides computes in single precision,
+            %while solving with double right-hand sides accumulates in
+            %double precision.
+            
+            obj.ValueClass = "single";
+            obj = obj.castValues();
+        end
+        
+        function x = toPlanOrder(obj, x)
+            %TOPLANORDER(P, X) Permute the rows of X from the original
+            %numbering to the numbering of the plan.
+            
+            if ~isempty(obj.Permutation)
+                x = x(obj.Permutation, :);
+            end
+        end
+        
+        function x = fromPlanOrder(obj, x)
+            %FROMPLANORDER(P, X) Permute the rows of X from the numbering of
+            %the plan to the original numbering.
+            
+            if ~isempty(obj.Permutation)
+                x(obj.Permutation, :) = x;
+            end
+        end
+        
+        function planStruct = nativePlan(obj)
+            %NATIVEPLAN(P) Get the plan arrays used by the native kernels
+            %as a scalar structure.
+            
+            fieldNames = ["NumRows", "NumLevels", "NumSteps", ...
+                "LevelPointer", "SubGraphPointer", ...
+                "RowPointer", "UpdateRows", "RowEdgePointer", ...
+                "Columns", "Weights", ...
+                "DiagonalPointer", "DiagonalRows", "Diagonal", "InverseDiagonal", ...
+                "UnscheduledRows", ...
+                "SuccessorPointer", "Successors", "NumPredecessors"];
+            planStruct = struct();
+            for fieldName = fieldNames
+                planStruct.(fieldName) = double(obj.(fieldName));
+            end
+        end
+        
+        function obj = updateWeights(obj, edgeWeights)
+            %UPDATEWEIGHTS(P, W) Replace the weights of the edges in the
+            %plan. W(E) is the new weight of the edge with ID E. The
+            %sub-graphs and the steps of the plan do not change.
+            
+            validateattributes(edgeWeights, {'numeric'}, {'vector'});
+            edgeWeights = reshape(double(edgeWeights), [], 1);
+            
+            % Unscheduled loops are only correct if they have unit weight.
+            assert(all(edgeWeights(obj.UnscheduledEdgeIds)==1), ...
+                "amsla:SolvePlan:unitDiagonalChanged", ...
+                "Cannot change the weight of a unit diagonal without analysing the matrix again.");
+            
+            obj.Weights = edgeWeights(obj.EdgeIds);
+            obj.Diagonal = edgeWeights(obj.DiagonalEdgeIds);
+            obj.InverseDiagonal = 1./obj.Diagonal;
+            obj = obj.fillDenseBlocks(edgeWeights);
+            obj = obj.castValues();
+        end
+        
+        function obj = onDevice(obj)
+            %ONDEVICE(P) Move the rows, columns and weights of the plan to
+            %the GPU as gpuArray data. The pointers stay on the host, so that
+            %applyLevel can execute the plan on gpuArray right-hand sides.
+            
+            for fieldName = ["UpdateRows", "LocalRows", "Columns", "Weights", ...
+                    "DiagonalRows", "Diagonal", "InverseDiagonal"]
+                obj.(fieldName) = gpuArray(obj.(fieldName));
+            end
+            obj.DenseTriangles = cellfun(@gpuArray, obj.DenseTriangles, 'UniformOutput', false);
+            obj.DensePanels = cellfun(@gpuArray, obj.DensePanels, 'UniformOutput', false);
+        end
+        
+        function stepIds = stepsInLevel(obj, levelId)
+            %STEPSINLEVEL(P, L) Get the IDs of the steps in level L.
+            
+            firstSubGraph = obj.LevelPointer(levelId);
+            lastSubGraph = obj.LevelPointer(levelId+1)-1;
+            stepIds = obj.SubGraphPointer(firstSubGraph):(obj.SubGraphPointer(lastSubGraph+1)-1);
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function [stepIds, blockId] = stepsOfSubGraph(obj, k)
+            % Steps of the K-th sub-graph that are not in its dense block,
+            % and index of the dense block, 0 if it has none.
+            
+            blockId = obj.DenseBlockOfSubGraph(k);
+            lastStep = obj.SubGraphPointer(k+1)-1;
+            if blockId>0
+                lastStep = obj.DenseBlocks(blockId).FirstStep-1;
+            end
+            stepIds = obj.SubGraphPointer(k):lastStep;
+        end
+        
+        function x = applyDenseBlock(obj, x, b)
+            % Execute a dense block: subtract the product of the panel and
+            % the columns computed before the block, then solve with the
+            % triangle.
+            
+            rows = obj.DenseBlocks(b).Rows;
+            columns = obj.DenseBlocks(b).Columns;
+            rhs = x(rows, :);
+            if ~isempty(columns)
+                rhs = rhs - cast(obj.DensePanels{b}, 'like', x)*x(columns, :);
+            end
+            x(rows, :) = iSolveLowerTriangular( ...
+                cast(obj.DenseTriangles{b}, 'like', x), rhs, false);
+        end
+        
+        function x = applyDenseBlockTranspose(obj, x, b)
+            % Execute the transpose of a dense block: solve with the
+            % transposed triangle, then subtract the product of the
+            % transposed panel from the columns.
+            
+            rows = obj.DenseBlocks(b).Rows;
+            columns = obj.DenseBlocks(b).Columns;
+            x(rows, :) = iSolveLowerTriangular( ...
+                cast(obj.DenseTriangles{b}, 'like', x), x(rows, :), true);
+            if ~isempty(columns)
+                x(columns, :) = x(columns, :) - cast(obj.DensePanels{b}, 'like', x).'*x(rows, :);
+            end
+        end
+        
+        function obj = fillDenseBlocks(obj, edgeWeights)
+            % Build the triangle and the panel of each dense block from the
+            % weights of the edges. Rows with unit diagonal keep a unit
+            % diagonal.
+            
+            numBlocks = numel(obj.DenseBlocks);
+            obj.DenseTriangles = cell(numBlocks, 1);
+            obj.DensePanels = cell(numBlocks, 1);
+            for b = 1:numBlocks
+                block = obj.DenseBlocks(b);
+                numRows = numel(block.Rows);
+                numColumns = numel(block.Columns);
+                values = [reshape(eye(numRows), [], 1); zeros(numRows*numColumns, 1)];
+                values(block.Positions) = edgeWeights(block.EdgeIds);
+                obj.DenseTriangles{b} = reshape(values(1:numRows^2), numRows, numRows);
+                obj.DensePanels{b} = reshape(values((numRows^2+1):end), numRows, numColumns);
+            end
+        end
+        
+        function obj = castValues(obj)
+            % Convert the weights stored in the plan to ValueClass.
+            
+            obj.Weights = cast(obj.Weights, obj.ValueClass);
+            obj.Diagonal = cast(obj.Diagonal, obj.ValueClass);
+            obj.InverseDiagonal = cast(obj.InverseDiagonal, obj.ValueClass);
+            obj.DenseTriangles = cellfun(@(A) cast(A, obj.ValueClass), ...
+                obj.DenseTriangles, 'UniformOutput', false);
+            obj.DensePanels = cellfun(@(A) cast(A, obj.ValueClass), ...
+                obj.DensePanels, 'UniformOutput', false);
+        end
+        
+        function x = applyStep(obj, x, s)
+            % Execute a single step of the plan on all the columns of X.
+            
+            edges = obj.EdgePointer(s):(obj.EdgePointer(s+1)-1);
+            if ~isempty(edges)
+                rows = obj.UpdateRows(obj.RowPointer(s):(obj.RowPointer(s+1)-1));
+                contributions = cast(obj.Weights(edges), 'like', x).*x(obj.Columns(edges), :);
+                numColumns = size(x, 2);
+                if numColumns==1
+                    subscripts = obj.LocalRows(edges);
+                else
+                    subscripts = [ ...
+                        repmat(obj.LocalRows(edges), numColumns, 1), ...
+                        repelem((1:numColumns)', numel(edges))];
+                end
+                x(rows, :) = x(rows, :) - accumarray(subscripts, ...
+                    contributions(:), [numel(rows), numColumns]);
+            end
+            
+            diagonal = obj.DiagonalPointer(s):(obj.DiagonalPointer(s+1)-1);
+            if ~isempty(diagonal)
+                rows = obj.DiagonalRows(diagonal);
+                x(rows, :) = x(rows, :).*cast(obj.InverseDiagonal(diagonal), 'like', x);
+            end
+        end
+        
+        function x = applyStepTranspose(obj, x, s)
+            % Execute the transpose of a single step: scale the rows of the
+            % loop edges, then subtract the contributions of the rows of the
+            % non-loop edges from their columns. No row of a step is also a
+            % column of the same step.
+            
+            diagonal = obj.DiagonalPointer(s):(obj.DiagonalPointer(s+1)-1);
+            if ~isempty(diagonal)
+                rows = obj.DiagonalRows(diagonal);
+                x(rows, :) = x(rows, :).*cast(obj.InverseDiagonal(diagonal), 'like', x);
+            end
+            
+            edges = obj.EdgePointer(s):(obj.EdgePointer(s+1)-1);
+            if ~isempty(edges)
+                rows = obj.UpdateRows(obj.RowPointer(s):(obj.RowPointer(s+1)-1));
+                contributions = cast(obj.Weights(edges), 'like', x).*x(rows(obj.LocalRows(edges)), :);
+                [columns, ~, localColumns] = unique(obj.Columns(edges));
+                numColumns = size(x, 2);
+                subscripts = [ ...
+                    repmat(localColumns, numColumns, 1), ...
+                    repelem((1:numColumns)', numel(edges))];
+                x(columns, :) = x(columns, :) - accumarray(subscripts, ...
+                    contributions(:), [numel(columns), numColumns]);
+            end
+        end
+        
+        function obj = compileSubGraphs(obj, aDataStructure, subGraphLevelsTable)
+            % Sort the sub-graphs by level and by ID.
+            
+            sortedTable = sortrows( ...
+                [subGraphLevelsTable.SubGraphLevel, subGraphLevelsTable.SubGraphId]);
+            
+            obj.NumRows = numel(aDataStructure.listOfNodes());
+            obj.SubGraphIds = sortedTable(:, 2);
+            [~, ~, levelOfSubGraph] = unique(sortedTable(:, 1));
+            obj.NumLevels = max([0; levelOfSubGraph]);
+            obj.LevelPointer = iPointer(levelOfSubGraph, obj.NumLevels);
+            
+            % Dependencies between the sub-graphs, sorted by the position
+            % of the upstream sub-graph.
+            if ~ismember("ToSubGraphId", subGraphLevelsTable.Properties.VariableNames)
+                subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(aDataStructure);
+            end
+            [~, positionOfRow] = ismember(subGraphLevelsTable.SubGraphId, obj.SubGraphIds);
+            toSubGraphIds = cellfun(@(ids) reshape(ids, [], 1), ...
+                subGraphLevelsTable.ToSubGraphId, 'UniformOutput', false);
+            numDownstream = cellfun(@numel, toSubGraphIds);
+            [~, toPosition] = ismember(vertcat(zeros(0, 1), toSubGraphIds{:}), obj.SubGraphIds);
+            fromPosition = repelem(positionOfRow, numDownstream);
+            dependencies = sortrows([fromPosition(:), toPosition(:)]);
+            numSubGraphs = numel(obj.SubGraphIds);
+            obj.SuccessorPointer = iPointer(dependencies(:, 1), numSubGraphs);
+            obj.Successors = dependencies(:, 2);
+            obj.NumPredecessors = accumarray(dependencies(:, 2), 1, [numSubGraphs, 1]);
+        end
+        
+        function obj = compileSteps(obj, aDataStructure)
+            % Group the scheduled edges by sub-graph and time-slot.
+            
+            edgeIds = reshape(aDataStructure.listOfEdges(), [], 1);
+            rows = reshape(aDataStructure.exitingNodeOfEdge(edgeIds), [], 1);
+            columns = reshape(aDataStructure.enteringNodeOfEdge(edgeIds), [], 1);
+            weights = reshape(aDataStructure.weightOfEdge(edgeIds), [], 1);
+            timeSlots = reshape(aDataStructure.timeSlotOfEdge(edgeIds), [], 1);
+            
+            % Edges that were never assigned to a time-slot do not take part
+            % in the solve.
+            isScheduled = ~amsla.common.isNullId(timeSlots);
+            obj.UnscheduledEdgeIds = edgeIds(~isScheduled);
+            obj.UnscheduledRows = rows(~isScheduled);
+            edgeIds = edgeIds(isScheduled);
+            rows = rows(isScheduled);
+            columns = columns(isScheduled);
+            weights = weights(isScheduled);
+            timeSlots = timeSlots(isScheduled);
+            
+            % Position of the sub-graph of each edge in the plan.
+            nodeSubGraphs = reshape(aDataStructure.subGraphOfNode(1:obj.NumRows), [], 1);
+            [~, subGraphPosition] = ismember(nodeSubGraphs(rows), obj.SubGraphIds);
+            
+            % Steps, sorted by sub-graph position and time-slot.
+            [stepKeys, ~, stepOfEdge] = unique([subGraphPosition, timeSlots], 'rows');
+            stepOfEdge = reshape(stepOfEdge, [], 1);
+            numSteps = size(stepKeys, 1);
+            obj.NumSteps = numSteps;
+            obj.TimeSlotIds = stepKeys(:, 2);
+            obj.SubGraphPointer = iPointer(stepKeys(:, 1), numel(obj.SubGraphIds));
+            
+            % Non-loop edges, sorted by step and row.
+            isLoop = rows==columns;
+            offDiagonal = find(~isLoop);
+            [~, sorter] = sortrows([stepOfEdge(offDiagonal), rows(offDiagonal), edgeIds(offDiagonal)]);
+            offDiagonal = offDiagonal(sorter);
+            [stepRows, ~, rowOfEdge] = unique( ...
+                [stepOfEdge(offDiagonal), rows(offDiagonal)], 'rows');
+            obj.RowPointer = iPointer(stepRows(:, 1), numSteps);
+            obj.UpdateRows = stepRows(:, 2);
+            obj.RowEdgePointer = iPointer(rowOfEdge, size(stepRows, 1));
+            obj.EdgePointer = iPointer(stepOfEdge(offDiagonal), numSteps);
+            obj.LocalRows = reshape(rowOfEdge, [], 1) - ...
+                obj.RowPointer(stepOfEdge(offDiagonal)) + 1;
+            obj.Columns = columns(offDiagonal);
+            obj.Weights = weights(offDiagonal);
+            obj.EdgeIds = edgeIds(offDiagonal);
+            
+            % Loop edges, sorted by step and row.
+            diagonal = find(isLoop);
+            [stepDiagonal, sorter] = sortrows([stepOfEdge(diagonal), rows(diagonal)]);
+            diagonal = diagonal(sorter);
+            obj.DiagonalPointer = iPointer(stepDiagonal(:, 1), numSteps);
+            obj.DiagonalRows = rows(diagonal);
+            obj.Diagonal = weights(diagonal);
+            obj.InverseDiagonal = 1./obj.Diagonal;
+            obj.DiagonalEdgeIds = edgeIds(diagonal);
+            
+            % Non-loop and loop edges cannot be mixed in the same time-slot.
+            assert(~any(ismember(stepDiagonal, stepRows, 'rows')), ...
+                "amsla:SolvePlan:mixedTimeSlot", ...
+                "Looping and non-looping edges cannot be mixed in the same time slot");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function x = iSolveLowerTriangular(triangle, rhs, isTransposed)
+% Solve with a dense lower-triangular matrix, or with its transpose.
+
+if isa(triangle, 'gpuArray')
+    if isTransposed
+        triangle = triangle.';
+    end
+    x = triangle\rhs;
+else
+    x = linsolve(triangle, rhs, struct('LT', true, 'TRANSA', isTransposed));
+end
+end
+
+function pointer = iPointer(sortedGroups, numGroups)
+% Compute the pointer array of a set of sorted group indices.
+numPerGroup = accumarray(reshape(sortedGroups, [], 1), 1, [numGroups, 1]);
+pointer = [1; cumsum(numPerGroup)+1];
+end
@@ -64,6 +64,16 @@ classdef TimeSlotDecorator < amsla.common.DataStructureDecorator
             outIds = obj.selectNodesInSameSubGraph(outIds, nodeIds);
         end
         
+        function [offsets, outIds] = parentsOfFrontier(obj, nodeIds)
+            [offsets, outIds] = parentsOfFrontier@amsla.common.DataStructureDecorator(obj, nodeIds);
+            [offsets, outIds] = obj.selectFrontierInSameSubGraph(offsets, outIds, nodeIds);
+        end
+        
+        function [offsets, outIds] = childrenOfFrontier(obj, nodeIds)
+            [offsets, outIds] = childrenOfFrontier@amsla.common.DataStructureDecorator(obj, nodeIds);
+            [offsets, outIds] = obj.selectFrontierInSameSubGraph(offsets, outIds, nodeIds);
+        end
+        
         function outIds = externalEdgesOfNode(obj, nodeIds)
             %EXTERNALEDGESOFNODE Given a node, return the IDs of the
             %external edges.
@@ -137,6 +147,23 @@ classdef TimeSlotDecorator < amsla.common.DataStructureDecorator
             end
         end
         
+        function [offsets, nodeIds] = selectFrontierInSameSubGraph(obj, offsets, nodeIds, refNodeIds)
+            %Select the nodes of a frontier that are in the same sub-graph
+            %as the corresponding node in refNodeIds
+            
+            if isempty(nodeIds)
+                return;
+            end
+            
+            refNodeIds = reshape(refNodeIds, [], 1);
+            refNodeIds = refNodeIds(amsla.common.internal.segmentIds(offsets));
+            isKept = reshape(obj.subGraphOfNode(nodeIds), [], 1) == ...
+                reshape(obj.subGraphOfNode(refNodeIds), [], 1);
+            
+            offsets = amsla.common.internal.filterSegments(offsets, isKept);
+            nodeIds = nodeIds(isKept);
+        end
+        
         function tf = isInternalEdge(obj, currEdgeIds, refNodeId)
             %Return true if the edge is internal
             
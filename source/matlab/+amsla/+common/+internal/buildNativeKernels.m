@@ -0,0 +1,80 @@
+function buildNativeKernels(varargin)
+%AMSLA.COMMON.INTERNAL.BUILDNATIVEKERNELS Compile the native kernels.
+%
+%   AMSLA.COMMON.INTERNAL.BUILDNATIVEKERNELS() Compile the C++ MEX kernels
+%   in source/cpp and place them in the package amsla.common.internal.
+%   A C++11 compiler configured with "mex -setup C++" is required.
+%
+%   The CUDA kernels are also compiled, with mexcuda, if Parallel Computing
+%   Toolbox can use a GPU on this machine.
+%
+%   AMSLA.COMMON.INTERNAL.BUILDNATIVEKERNELS(__, 'Verbose', true) Show the
+%   output of the compiler.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+parser = inputParser;
+addParameter(parser, 'Verbose', false, @(x) islogical(x) && isscalar(x));
+parse(parser, varargin{:});
+
+outputDir = fileparts(mfilename('fullpath'));
+sourceDir = fullfile(outputDir, "..", "..", "..", "..", "cpp");
+
+mexOptions = ["-R2017b", "-O", "-outdir", outputDir, "-I" + sourceDir];
+if isunix
+    % The kernels use C++11 threads.
+    mexOptions = [mexOptions, ...
+        "CXXFLAGS=$CXXFLAGS -std=c++11 -pthread", ...
+        "LDFLAGS=$LDFLAGS -pthread"];
+end
+if parser.Results.Verbose
+    mexOptions = ["-v", mexOptions];
+end
+
+kernelSources = iKernelSources();
+for k = 1:numel(kernelSources)
+    mexArguments = cellstr([mexOptions, fullfile(sourceDir, kernelSources(k))]);
+    mex(mexArguments{:});
+end
+
+if iCanUseGpu()
+    cudaOptions = ["-R2018a", "-outdir", outputDir, "-I" + sourceDir];
+    if parser.Results.Verbose
+        cudaOptions = ["-v", cudaOptions];
+    end
+    cudaSources = iCudaKernelSources();
+    for k = 1:numel(cudaSources)
+        mexArguments = cellstr([cudaOptions, fullfile(sourceDir, cudaSources(k))]);
+        mexcuda(mexArguments{:});
+    end
+end
+end
+
+%% HELPER FUNCTIONS
+
+function kernelSources = iKernelSources()
+% Sources of the MEX gateways to build.
+kernelSources = ["forwardSubstitutionMex.cpp", "sparseMatrixVectorMex.cpp"];
+end
+
+function kernelSources = iCudaKernelSources()
+% Sources of the CUDA MEX gateways to build.
+kernelSources = "forwardSubstitutionGpuMex.cu";
+end
+
+function tf = iCanUseGpu()
+% Check whether there is a GPU that MATLAB can use.
+tf = exist("canUseGPU", "file")==2 && canUseGPU();
+end
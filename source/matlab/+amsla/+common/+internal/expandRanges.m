@@ -0,0 +1,32 @@
+function indices = expandRanges(firstIndex, lastIndex)
+%AMSLA.COMMON.INTERNAL.EXPANDRANGES Concatenate several ranges of indices
+%into a single column vector.
+%
+%   IDX = AMSLA.COMMON.INTERNAL.EXPANDRANGES(F, L) Return the column vector
+%   [F(1):L(1), F(2):L(2), ...]'. Empty ranges (L(k)<F(k)) are skipped.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+firstIndex = reshape(firstIndex, [], 1);
+lastIndex = reshape(lastIndex, [], 1);
+assert(numel(firstIndex)==numel(lastIndex), ...
+    "The number of range starts and ends should be the same.");
+
+rangeLengths = max(lastIndex-firstIndex+1, 0);
+rangeOffsets = cumsum(rangeLengths)-rangeLengths;
+
+indices = (1:sum(rangeLengths))' + ...
+    repelem(firstIndex-rangeOffsets-1, rangeLengths);
+end
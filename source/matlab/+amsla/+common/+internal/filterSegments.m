@@ -0,0 +1,27 @@
+function offsets = filterSegments(offsets, isKept)
+%AMSLA.COMMON.INTERNAL.FILTERSEGMENTS Compute the offsets of an
+%offsets-indices pair after removing some of its elements.
+%
+%   O = AMSLA.COMMON.INTERNAL.FILTERSEGMENTS(O, TF) Return the offsets of
+%   the segments in O after keeping only the elements where TF is true.
+%   The indices themselves are filtered by the caller with IDX(TF).
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+numSegments = numel(offsets)-1;
+segmentIds = amsla.common.internal.segmentIds(offsets);
+numKept = accumarray(segmentIds(isKept), 1, [numSegments, 1]);
+offsets = [1; cumsum(numKept)+1];
+end
@@ -0,0 +1,64 @@
+function subGraphIds = findAffectedSubGraphs(aGraph, nodeIds)
+%AMSLA.COMMON.INTERNAL.FINDAFFECTEDSUBGRAPHS Find the sub-graphs that have
+%to be partitioned again when the edges of some nodes change.
+%
+%   SID = AMSLA.COMMON.INTERNAL.FINDAFFECTEDSUBGRAPHS(G, NID) Return the
+%   sorted IDs of the sub-graphs of the nodes NID in the partitioned graph
+%   G, and of every sub-graph that is both downstream and upstream of
+%   them.
+%
+%   The graph G must already have its new edges. The sub-graphs of NID are
+%   collapsed into a single node of the graph of sub-graphs: a path that
+%   leaves them and comes back would become a cycle if its nodes were
+%   replaced by new sub-graphs, so the sub-graphs on such paths are
+%   affected too. Any partition of the nodes of the affected sub-graphs
+%   into sub-graphs then keeps the dependencies between all the
+%   sub-graphs a DAG.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+validateattributes(aGraph, {'amsla.common.DataStructureInterface'}, {'nonempty', 'scalar'});
+
+allNodes = reshape(aGraph.listOfNodes(), [], 1);
+nodeSubGraphs = reshape(aGraph.subGraphOfNode(allNodes), [], 1);
+assert(~any(amsla.common.isNullId(nodeSubGraphs)), ...
+    "amsla:findAffectedSubGraphs:NotPartitioned", ...
+    "Cannot find the affected sub-graphs of a non-partitioned graph.");
+
+[allSubGraphIds, ~, positionOfNode] = unique(nodeSubGraphs);
+subGraphOfNodeId = zeros(max([0; allNodes]), 1);
+subGraphOfNodeId(allNodes) = positionOfNode;
+isSeed = false(numel(allSubGraphIds), 1);
+isSeed(subGraphOfNodeId(nodeIds)) = true;
+
+% Graph of sub-graphs, with all the seed sub-graphs as its last node. The
+% children of a node are the rows of its column.
+seedNode = numel(allSubGraphIds)+1;
+nodeOfPosition = (1:numel(allSubGraphIds))';
+nodeOfPosition(isSeed) = seedNode;
+edgeIds = aGraph.listOfEdges();
+fromNode = nodeOfPosition(subGraphOfNodeId(reshape(aGraph.enteringNodeOfEdge(edgeIds), [], 1)));
+toNode = nodeOfPosition(subGraphOfNodeId(reshape(aGraph.exitingNodeOfEdge(edgeIds), [], 1)));
+isExternal = fromNode~=toNode;
+quotientEdges = unique([fromNode(isExternal), toNode(isExternal)], 'rows');
+quotientGraph = digraph(quotientEdges(:, 1), quotientEdges(:, 2), [], seedNode);
+
+downstream = bfsearch(quotientGraph, seedNode);
+upstream = bfsearch(flipedge(quotientGraph), seedNode);
+isBetween = false(seedNode, 1);
+isBetween(intersect(downstream, upstream)) = true;
+
+subGraphIds = allSubGraphIds(isSeed | isBetween(1:end-1));
+end
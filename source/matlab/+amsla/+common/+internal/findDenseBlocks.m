@@ -0,0 +1,156 @@
+function [denseBlocks, blockOfSubGraph] = findDenseBlocks(plan, varargin)
+%AMSLA.COMMON.INTERNAL.FINDDENSEBLOCKS Find the dense triangular blocks at
+%the end of the sub-graphs of a solve plan.
+%
+%   [B, K] = AMSLA.COMMON.INTERNAL.FINDDENSEBLOCKS(P) Look for a dense
+%   block in each sub-graph of the amsla.common.internal.SolvePlan P. The
+%   block of a sub-graph is made of its last steps: the rows that these
+%   steps compute form a lower-triangular matrix, and the columns they read
+%   from outside the block form a rectangular panel. B is a structure array
+%   with one element per block, and K(S) is the index in B of the block of
+%   the S-th sub-graph of the plan, or 0 if it has none.
+%
+%   [B, K] = AMSLA.COMMON.INTERNAL.FINDDENSEBLOCKS(P, 'MinSize', N) Only
+%   keep blocks with at least N rows. The default is 16.
+%
+%   [B, K] = AMSLA.COMMON.INTERNAL.FINDDENSEBLOCKS(P, 'MinDensity', D)
+%   Only keep blocks where at least a fraction D of the triangle and the
+%   panel is non-zero. The default is 0.7.
+%
+%   [B, K] = AMSLA.COMMON.INTERNAL.FINDDENSEBLOCKS(P, 'MaxSize', N) Do not
+%   look for blocks with more than N rows. The default is 1024.
+%
+%   Each element of B has the fields:
+%      FirstStep   - First step of the block. The block ends with the
+%                    last step of its sub-graph.
+%      Rows        - Rows computed by the block, sorted so that the
+%                    triangle is lower triangular.
+%      Columns     - Columns read by the block and computed before it.
+%      EdgeIds     - IDs of the scheduled edges of the block.
+%      Positions   - Linear index of each edge in [T(:); P(:)], where T
+%                    is the triangle and P the panel of the block.
+%
+%   The largest block that satisfies all the conditions is chosen in each
+%   sub-graph.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+parser = inputParser;
+addParameter(parser, 'MinSize', 16, @(x) isnumeric(x) && isscalar(x) && x>=1);
+addParameter(parser, 'MinDensity', 0.7, @(x) isnumeric(x) && isscalar(x) && x>0 && x<=1);
+addParameter(parser, 'MaxSize', 1024, @(x) isnumeric(x) && isscalar(x) && x>=1);
+parse(parser, varargin{:});
+options = parser.Results;
+
+numSubGraphs = numel(plan.SubGraphIds);
+blockOfSubGraph = zeros(numSubGraphs, 1);
+denseBlocks = struct("FirstStep", {}, "Rows", {}, "Columns", {}, ...
+    "EdgeIds", {}, "Positions", {});
+
+for k = 1:numSubGraphs
+    firstStep = plan.SubGraphPointer(k);
+    lastStep = plan.SubGraphPointer(k+1)-1;
+    blockStep = iFirstStepOfBlock(plan, firstStep, lastStep, options);
+    if ~isempty(blockStep)
+        denseBlocks(end+1) = iDenseBlock(plan, blockStep, lastStep); %#ok<AGROW>
+        blockOfSubGraph(k) = numel(denseBlocks);
+    end
+end
+end
+
+%% HELPER FUNCTIONS
+
+function blockStep = iFirstStepOfBlock(plan, firstStep, lastStep, options)
+% Extend the block backwards, one step at a time, and keep the first step
+% of the largest block that is dense enough.
+
+blockStep = [];
+for s = lastStep:-1:firstStep
+    [rows, ~, edges] = iContentOfSteps(plan, s, lastStep);
+    numRows = numel(rows);
+    if numRows>options.MaxSize
+        break;
+    end
+
+    columns = plan.Columns(edges);
+    numPanelColumns = numel(unique(columns(~ismember(columns, rows))));
+    numNonZeros = numel(edges) + numRows;
+    denseSize = numRows*(numRows+1)/2 + numRows*numPanelColumns;
+    if numRows>=options.MinSize && numNonZeros>=options.MinDensity*denseSize
+        blockStep = s;
+    end
+end
+end
+
+function block = iDenseBlock(plan, firstStep, lastStep)
+% Describe the block made of the steps from firstStep to lastStep.
+
+[rows, lastStepOfRow, edges, diagonal] = iContentOfSteps(plan, firstStep, lastStep);
+
+% A row only reads rows computed by earlier steps, so sorting the rows by
+% the step that computes them makes the triangle lower triangular.
+[~, sorter] = sort(lastStepOfRow);
+rows = rows(sorter);
+numRows = numel(rows);
+
+edgeRows = plan.UpdateRows(iRowOfEdge(plan, firstStep, lastStep));
+edgeColumns = plan.Columns(edges);
+[~, localRows] = ismember(edgeRows, rows);
+[isInTriangle, localColumns] = ismember(edgeColumns, rows);
+columns = unique(edgeColumns(~isInTriangle));
+[~, panelColumns] = ismember(edgeColumns(~isInTriangle), columns);
+
+positions = zeros(numel(edges), 1);
+positions(isInTriangle) = sub2ind([numRows, numRows], ...
+    localRows(isInTriangle), localColumns(isInTriangle));
+positions(~isInTriangle) = numRows^2 + sub2ind([numRows, max(numel(columns), 1)], ...
+    localRows(~isInTriangle), panelColumns);
+assert(all(localColumns(isInTriangle)<localRows(isInTriangle)), ...
+    "amsla:findDenseBlocks:notTriangular", ...
+    "The rows of a dense block cannot be sorted into a triangle.");
+
+[~, localDiagonal] = ismember(plan.DiagonalRows(diagonal), rows);
+
+block = struct( ...
+    "FirstStep", firstStep, ...
+    "Rows", rows, ...
+    "Columns", columns, ...
+    "EdgeIds", [plan.EdgeIds(edges); plan.DiagonalEdgeIds(diagonal)], ...
+    "Positions", [positions; sub2ind([numRows, numRows], localDiagonal, localDiagonal)]);
+end
+
+function [rows, lastStepOfRow, edges, diagonal] = iContentOfSteps(plan, firstStep, lastStep)
+% Rows computed by a range of consecutive steps, with the last step that
+% writes each of them, and positions of the non-loop and loop edges of the
+% steps in the plan.
+
+updates = plan.RowPointer(firstStep):(plan.RowPointer(lastStep+1)-1);
+edges = reshape(plan.EdgePointer(firstStep):(plan.EdgePointer(lastStep+1)-1), [], 1);
+diagonal = reshape(plan.DiagonalPointer(firstStep):(plan.DiagonalPointer(lastStep+1)-1), [], 1);
+
+stepOfUpdate = repelem((firstStep:lastStep)', diff(plan.RowPointer(firstStep:(lastStep+1))));
+stepOfDiagonal = repelem((firstStep:lastStep)', diff(plan.DiagonalPointer(firstStep:(lastStep+1))));
+[rows, ~, rowPosition] = unique([plan.UpdateRows(updates); plan.DiagonalRows(diagonal)]);
+lastStepOfRow = accumarray(rowPosition, [stepOfUpdate; stepOfDiagonal], [], @max);
+end
+
+function rowPositions = iRowOfEdge(plan, firstStep, lastStep)
+% Position in UpdateRows of the row of each non-loop edge of a range of
+% consecutive steps.
+
+edges = plan.EdgePointer(firstStep):(plan.EdgePointer(lastStep+1)-1);
+stepOfEdge = repelem((firstStep:lastStep)', diff(plan.EdgePointer(firstStep:(lastStep+1))));
+rowPositions = plan.RowPointer(stepOfEdge) + reshape(plan.LocalRows(edges), [], 1) - 1;
+end
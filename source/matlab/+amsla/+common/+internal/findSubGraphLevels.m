@@ -4,6 +4,11 @@ function [subGraphLevelTable] = findSubGraphLevels(aGraph)
 %
 %   SGLT = AMSLA.COMMON.INTERNAL.FINDSUBGRAPHLEVELS(G) Organises the
 %   sub-graphs in graph G into sub-graph levels, and returns a table.
+%
+%   The external edges are collapsed into a quotient graph with one node
+%   per sub-graph, in a single pass over the edges. The level of a
+%   sub-graph is the length of the longest path that reaches it in the
+%   quotient graph, computed with Kahn's algorithm.
 
 % Copyright 2019-2020 Andrea Picciau
 %
@@ -19,49 +24,22 @@ function [subGraphLevelTable] = findSubGraphLevels(aGraph)
 % See the License for the specific language governing permissions and
 % limitations under the License.
 
-validateattributes(aGraph, {'amsla.common.DataStructure'}, {'nonempty', 'scalar'});
-
-% Extract data about sub-graphs
-subGraphLevelTable = iExtractDataBySubGraph(aGraph);
+validateattributes(aGraph, {'amsla.common.DataStructureInterface'}, {'nonempty', 'scalar'});
 
-% Find the sub-graphs in the first sub-graph level
-isInFirstLevel = arrayfun( ...
-    @iIsInFirstLevel, subGraphLevelTable.SubGraphId, 'UniformOutput', true);
-subGraphLevelTable.SubGraphLevel(isInFirstLevel) = 1;
+[subGraphIds, fromPosition, toPosition, hasChildren] = iQuotientGraph(aGraph);
+numSubGraphs = numel(subGraphIds);
 
-    function tf = iIsInFirstLevel(subGraphId)
-        % Returns true if the sub-graphID is in the first level
-        
-        tf = ~any(cellfun( ...
-            @(x) ismember(subGraphId, x), subGraphLevelTable.ToSubGraphId, 'UniformOutput', true));
-    end
+% Downstream sub-graphs of each sub-graph, as row vectors. A sub-graph whose
+% nodes have no children at all has a 0-by-1 set.
+numDownstream = accumarray(fromPosition, 1, [numSubGraphs, 1]);
+toSubGraphId = reshape(mat2cell(reshape(subGraphIds(toPosition), 1, []), ...
+    1, numDownstream), [], 1);
+toSubGraphId(numDownstream==0 & ~hasChildren) = {zeros(0, 1)};
 
-% Initialise the algorithm with the sub-graphs that are below the ones in
-% the first level.
-currentSubGraphs = unique(iMergeSets( ...
-    subGraphLevelTable.ToSubGraphId(isInFirstLevel)));
-currentSubGraphLevel = 2;
+subGraphLevel = iLongestPathLevels(fromPosition, toPosition, numDownstream);
 
-% Loop until there are not sub-graphs to assign to sub-graph levels.
-while ~isempty(currentSubGraphs)
-    selRows = ismember(subGraphLevelTable.SubGraphId, currentSubGraphs);
-    
-    % Exclude sub-graphs that are already assigned to a higher sub-graph
-    % level.
-    currentAssignment = subGraphLevelTable.SubGraphLevel(selRows);
-    currentSubGraphsToExclude = currentAssignment>=currentSubGraphLevel;
-    currentSubGraphs(currentSubGraphsToExclude) = [];
-    
-    selRows = ismember(subGraphLevelTable.SubGraphId, currentSubGraphs);
-    
-    % Assign remaining sub-graphs to the current level
-    subGraphLevelTable.SubGraphLevel(selRows) = currentSubGraphLevel;
-    
-    % Find sub-graphs downstream
-    currentSubGraphs = unique(iMergeSets( ...
-        subGraphLevelTable.ToSubGraphId(selRows)));
-    currentSubGraphLevel = currentSubGraphLevel+1;
-end
+subGraphLevelTable = table(subGraphIds, subGraphLevel, toSubGraphId, ...
+    'VariableNames', {'SubGraphId', 'SubGraphLevel', 'ToSubGraphId'});
 
 % Check final result
 assert(~any(amsla.common.isNullId(subGraphLevelTable.SubGraphLevel)), ...
@@ -71,72 +49,63 @@ end
 
 %% HELPER FUNCTION
 
-function subGraphLevelTable = iExtractDataBySubGraph(aGraph)
-% Create a table that organises the data about external edges by sub-graph.
-% The output table has the following columns:
-% - SubGraphId      ID of the sub-graph.
-% - SubGraphLevel   ID of the sub-graph level of the current sub-graph.
-% - ToSubGraphId    IDs of the sub-graphs to which the current sub-graph is
-%                   connected by a downstream external edge.
+function [subGraphIds, fromPosition, toPosition, hasChildren] = iQuotientGraph(aGraph)
+% Collapse the graph into a graph of sub-graphs. Sub-graphs are identified
+% by their position in the sorted list SUBGRAPHIDS. The external edges go
+% from FROMPOSITION to TOPOSITION, are unique, and are sorted by
+% FROMPOSITION and then by TOPOSITION. HASCHILDREN is true for the
+% sub-graphs with at least one node that has a child.
 
-% Sub-graphs of input nodes
-fromNodes = aGraph.listOfNodes();
-fromSubGraph = aGraph.subGraphOfNode(fromNodes);
+allNodes = reshape(aGraph.listOfNodes(), [], 1);
+nodeSubGraphs = reshape(aGraph.subGraphOfNode(allNodes), [], 1);
 
-assert(~any(amsla.common.isNullId(fromSubGraph)), "amsla:findSubGraphLevels:NotPartitioned", ...
+assert(~any(amsla.common.isNullId(nodeSubGraphs)), "amsla:findSubGraphLevels:NotPartitioned", ...
     "Cannot find sub-graph levels for a non-partitioned input.");
 
-% Sub-graphs of output nodes
-toNodes = aGraph.childrenOfNode(fromNodes);
-if iscell(toNodes)
-    toSubGraph = cellfun(@iFindDownstreamSubGraphs, toNodes, 'UniformOutput', false);
-else
-    toSubGraph = iFindDownstreamSubGraphs(toNodes);
+[subGraphIds, ~, positionOfNode] = unique(nodeSubGraphs);
+subGraphIds = reshape(subGraphIds, [], 1);
+subGraphOfNodeId = zeros(max([0; allNodes]), 1);
+subGraphOfNodeId(allNodes) = positionOfNode;
+
+% The children of a node are the rows of its column.
+allEdges = aGraph.listOfEdges();
+rows = reshape(aGraph.exitingNodeOfEdge(allEdges), [], 1);
+columns = reshape(aGraph.enteringNodeOfEdge(allEdges), [], 1);
+isLoop = rows==columns;
+fromPosition = subGraphOfNodeId(columns(~isLoop));
+toPosition = subGraphOfNodeId(rows(~isLoop));
+
+hasChildren = false(numel(subGraphIds), 1);
+hasChildren(fromPosition) = true;
+
+isExternal = fromPosition~=toPosition;
+quotientEdges = unique([fromPosition(isExternal), toPosition(isExternal)], 'rows');
+fromPosition = reshape(quotientEdges(:, 1), [], 1);
+toPosition = reshape(quotientEdges(:, 2), [], 1);
 end
 
-% Deal with corner cases for toSubGraph
-if ~iscell(toSubGraph)
-    toSubGraph = { toSubGraph };
+function levels = iLongestPathLevels(fromPosition, toPosition, numDownstream)
+% Kahn's algorithm, one frontier at a time: a sub-graph enters the frontier
+% once all the sub-graphs upstream have a level, so the frontier number is
+% the length of the longest path to it. Sub-graphs on a cycle never enter
+% the frontier and keep a null level.
+
+numSubGraphs = numel(numDownstream);
+levels = amsla.common.nullId([numSubGraphs, 1]);
+numUpstream = accumarray(toPosition, 1, [numSubGraphs, 1]);
+edgePointer = [1; cumsum(numDownstream)+1];
+
+frontier = find(numUpstream==0);
+currentLevel = 1;
+while ~isempty(frontier)
+    levels(frontier) = currentLevel;
+    
+    frontierEdges = amsla.common.internal.expandRanges( ...
+        edgePointer(frontier), edgePointer(frontier+1)-1);
+    downstream = toPosition(frontierEdges);
+    numUpstream = numUpstream - accumarray(downstream, 1, [numSubGraphs, 1]);
+    
+    frontier = unique(downstream(numUpstream(downstream)==0));
+    currentLevel = currentLevel+1;
 end
-
-% Create a table with non-unique rows
-tempTable = table(fromSubGraph', toSubGraph', ...
-    'VariableNames', {'FromSubGraphId', 'ToSubGraphId'});
-allSubGraphs = aGraph.listOfSubGraphs();
-
-% Merge non-unique rows
-allMergedSets = ...
-    arrayfun(@iFindAndMergeSets, allSubGraphs, 'UniformOutput', false);
-
-% Create output table
-subGraphLevel = amsla.common.nullId(size(allSubGraphs));
-subGraphLevelTable = table(allSubGraphs', subGraphLevel', allMergedSets', ...
-    'VariableNames', {'SubGraphId', 'SubGraphLevel', 'ToSubGraphId'});
-subGraphLevelTable = sortrows(subGraphLevelTable, 1);
-
-    function downstreamGraph = iFindDownstreamSubGraphs(subGraphIds)
-        % Find the downstream sub-graph IDs for a given sub-graph ID
-        
-        if isempty(subGraphIds)
-            downstreamGraph = [];
-        else
-            downstreamGraph = aGraph.subGraphOfNode(subGraphIds);
-        end
-    end
-
-    function mergedSet = iFindAndMergeSets(subGraphId)
-        % Merge all rows in tempTable that refer to subGraphId, and remove
-        % data about internal edges in the graph.
-        
-        selRows = tempTable.FromSubGraphId==subGraphId;
-        setsToMerge = tempTable.ToSubGraphId(selRows);
-        mergedSet = unique(iMergeSets(setsToMerge));
-        
-        % Remove data about internal edges in the graph.
-        mergedSet(mergedSet==subGraphId) = [];
-    end
 end
-
-function mergedSet = iMergeSets(allSets)
-mergedSet = [allSets{:}];
-end
\ No newline at end of file
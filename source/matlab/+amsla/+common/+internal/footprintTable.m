@@ -0,0 +1,34 @@
+function footprint = footprintTable(components, contents)
+%AMSLA.COMMON.INTERNAL.FOOTPRINTTABLE Tabulate the memory used by the
+%components of an object.
+%
+%   T = AMSLA.COMMON.INTERNAL.FOOTPRINTTABLE(N, C) Return a table with one
+%   row per component, with the variables Component, the names N, and
+%   Bytes, the memory used by the arrays in the cell array C as reported by
+%   whos. The memory of cell arrays includes the header of each cell.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+bytes = cellfun(@iBytes, reshape(contents, [], 1));
+footprint = table(reshape(string(components), [], 1), bytes, ...
+    'VariableNames', {'Component', 'Bytes'});
+end
+
+%% HELPER FUNCTIONS
+
+function bytes = iBytes(content) %#ok<INUSD>
+information = whos('content');
+bytes = information.bytes;
+end
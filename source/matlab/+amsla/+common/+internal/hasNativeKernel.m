@@ -0,0 +1,23 @@
+function tf = hasNativeKernel(kernelName)
+%AMSLA.COMMON.INTERNAL.HASNATIVEKERNEL Check whether a native kernel has
+%been built.
+%
+%   TF = AMSLA.COMMON.INTERNAL.HASNATIVEKERNEL(K) Return true if the MEX
+%   file of the kernel K in amsla.common.internal is available.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+tf = exist("amsla.common.internal." + kernelName, "file")==3;
+end
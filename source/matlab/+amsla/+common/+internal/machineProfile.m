@@ -0,0 +1,119 @@
+function profile = machineProfile()
+%AMSLA.COMMON.INTERNAL.MACHINEPROFILE Properties of the processor that
+%affect the performance of the triangular solve.
+%
+%   P = AMSLA.COMMON.INTERNAL.MACHINEPROFILE() Return a structure with the
+%   fields:
+%      NumCores      - Number of physical cores.
+%      L1CacheSize   - Size of the level-1 data cache of a core, in bytes.
+%      L2CacheSize   - Size of the level-2 cache of a core, in bytes.
+%      LLCacheSize   - Size of the last-level cache, in bytes.
+%      Bandwidth     - Measured memory bandwidth, in bytes per second.
+%
+%   The cache sizes are read from the operating system on Linux and set to
+%   common values elsewhere. The bandwidth is measured with a copy of an
+%   array larger than the last-level cache. The profile is computed once
+%   per MATLAB session.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+persistent cachedProfile
+if isempty(cachedProfile)
+    cachedProfile = iCacheSizes();
+    cachedProfile.NumCores = feature("numcores");
+    cachedProfile.Bandwidth = iMeasureBandwidth(cachedProfile.LLCacheSize);
+end
+profile = cachedProfile;
+end
+
+%% HELPER FUNCTIONS
+
+function profile = iCacheSizes()
+% Read the cache sizes of the first core from sysfs, if available.
+
+profile = struct( ...
+    "L1CacheSize", 32*2^10, ...
+    "L2CacheSize", 256*2^10, ...
+    "LLCacheSize", 8*2^20);
+
+cacheFolders = dir("/sys/devices/system/cpu/cpu0/cache/index*");
+lastLevel = 0;
+for k = 1:numel(cacheFolders)
+    cacheFolder = fullfile(cacheFolders(k).folder, cacheFolders(k).name);
+    cacheType = iReadSysFile(fullfile(cacheFolder, "type"));
+    if cacheType=="Instruction"
+        continue;
+    end
+    level = str2double(iReadSysFile(fullfile(cacheFolder, "level")));
+    cacheSize = iParseCacheSize(iReadSysFile(fullfile(cacheFolder, "size")));
+    if isnan(level) || isnan(cacheSize)
+        continue;
+    end
+    if level==1
+        profile.L1CacheSize = cacheSize;
+    elseif level==2
+        profile.L2CacheSize = cacheSize;
+    end
+    if level>=lastLevel
+        lastLevel = level;
+        profile.LLCacheSize = cacheSize;
+    end
+end
+end
+
+function content = iReadSysFile(fileName)
+% Read the first line of a sysfs file, or return an empty string.
+
+content = "";
+fileId = fopen(fileName, "r");
+if fileId>=0
+    line = fgetl(fileId);
+    fclose(fileId);
+    if ischar(line)
+        content = string(strtrim(line));
+    end
+end
+end
+
+function cacheSize = iParseCacheSize(sizeString)
+% Convert sizes such as "32K" or "8M" to bytes.
+
+tokens = regexp(sizeString, "^(\d+)([KMG]?)$", "tokens", "once");
+if isempty(tokens)
+    cacheSize = NaN;
+    return;
+end
+multipliers = struct("K", 2^10, "M", 2^20, "G", 2^30);
+cacheSize = str2double(tokens{1});
+if tokens{2}~=""
+    cacheSize = cacheSize*multipliers.(tokens{2});
+end
+end
+
+function bandwidth = iMeasureBandwidth(llcSize)
+% Time the copy of an array four times larger than the last-level cache.
+% Each copy reads and writes the array.
+
+numElements = max(4*llcSize/8, 2^20);
+source = ones(numElements, 1);
+numRepetitions = 5;
+bestTime = Inf;
+for k = 1:numRepetitions
+    copyTimer = tic();
+    destination = source + 0; %#ok<NASGU>
+    bestTime = min(bestTime, toc(copyTimer));
+end
+bandwidth = 2*8*numElements/bestTime;
+end
@@ -0,0 +1,33 @@
+function numWorkers = numParallelWorkers(useParallel)
+%AMSLA.COMMON.INTERNAL.NUMPARALLELWORKERS Number of workers for a parfor
+%loop.
+%
+%   N = AMSLA.COMMON.INTERNAL.NUMPARALLELWORKERS(TF) Return the number of
+%   workers of the current parallel pool if TF is true, starting a pool if
+%   needed. Return 0 if TF is false or Parallel Computing Toolbox is not
+%   available, so that "parfor (k = 1:K, N)" runs on the client.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+numWorkers = 0;
+if ~useParallel || exist("gcp", "file")~=2 || ~license("test", "Distrib_Computing_Toolbox")
+    return;
+end
+
+pool = gcp();
+if ~isempty(pool)
+    numWorkers = pool.NumWorkers;
+end
+end
@@ -0,0 +1,149 @@
+function subGraphLevelTable = patchSubGraphLevels(aGraph, subGraphLevelTable, removedIds, addedIds)
+%AMSLA.COMMON.INTERNAL.PATCHSUBGRAPHLEVELS Update a table of sub-graph
+%levels after some sub-graphs have been partitioned again.
+%
+%   SGLT = AMSLA.COMMON.INTERNAL.PATCHSUBGRAPHLEVELS(G, SGLT, R, A) Update
+%   the table SGLT, as computed by amsla.common.internal.findSubGraphLevels,
+%   after the sub-graphs R of the graph G were replaced by the sub-graphs
+%   A. The result is the same table that findSubGraphLevels(G) returns.
+%
+%   Only the dependencies that start or end in A are computed from the
+%   edges of G. The other sub-graphs keep their dependencies, without R
+%   and with the sub-graphs of A that they reach, and only the levels of
+%   the sub-graphs downstream of A are computed again.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+validateattributes(aGraph, {'amsla.common.DataStructureInterface'}, {'nonempty', 'scalar'});
+validateattributes(subGraphLevelTable, {'table'}, {});
+removedIds = reshape(removedIds, [], 1);
+addedIds = reshape(sort(addedIds), [], 1);
+
+[fromIds, toIds, hasChildren] = iDependenciesOfAdded(aGraph, addedIds);
+
+% Sub-graphs that were not partitioned again, and their dependencies on
+% the new sub-graphs.
+keptTable = subGraphLevelTable(~ismember(subGraphLevelTable.SubGraphId, removedIds), :);
+[isFromKept, keptPosition] = ismember(fromIds, keptTable.SubGraphId);
+newDownstream = iGroup(keptPosition(isFromKept), toIds(isFromKept), height(keptTable));
+keptTable.ToSubGraphId = cellfun(@(ids, newIds) iPatchDownstream(ids, removedIds, newIds), ...
+    keptTable.ToSubGraphId, newDownstream, 'UniformOutput', false);
+
+% New sub-graphs. A sub-graph whose nodes have no children at all has a
+% 0-by-1 set, as in findSubGraphLevels.
+[isFromAdded, addedPosition] = ismember(fromIds, addedIds);
+toSubGraphId = iGroup(addedPosition(isFromAdded), toIds(isFromAdded), numel(addedIds));
+toSubGraphId(~hasChildren) = {zeros(0, 1)};
+addedTable = table(addedIds, amsla.common.nullId(size(addedIds)), toSubGraphId, ...
+    'VariableNames', {'SubGraphId', 'SubGraphLevel', 'ToSubGraphId'});
+
+subGraphLevelTable = sortrows([keptTable; addedTable], 'SubGraphId');
+subGraphLevelTable.SubGraphLevel = iPatchLevels(subGraphLevelTable, addedIds);
+
+assert(~any(amsla.common.isNullId(subGraphLevelTable.SubGraphLevel)), ...
+    "amsla:patchSubGraphLevels:NonDagDependencies", ...
+    "Identification of sub-graph levels failed.");
+end
+
+%% HELPER FUNCTIONS
+
+function [fromIds, toIds, hasChildren] = iDependenciesOfAdded(aGraph, addedIds)
+% Unique dependencies between different sub-graphs that start or end in
+% the sub-graphs ADDEDIDS, sorted by FROMIDS and then by TOIDS. HASCHILDREN
+% is true for the sub-graphs in ADDEDIDS with at least one node that has a
+% child.
+
+allNodes = reshape(aGraph.listOfNodes(), [], 1);
+subGraphOfNodeId = zeros(max([0; allNodes]), 1);
+subGraphOfNodeId(allNodes) = aGraph.subGraphOfNode(allNodes);
+
+% The children of a node are the rows of its column.
+edgeIds = aGraph.listOfEdges();
+rows = reshape(aGraph.exitingNodeOfEdge(edgeIds), [], 1);
+columns = reshape(aGraph.enteringNodeOfEdge(edgeIds), [], 1);
+isLoop = rows==columns;
+fromIds = subGraphOfNodeId(columns(~isLoop));
+toIds = subGraphOfNodeId(rows(~isLoop));
+
+hasChildren = ismember(addedIds, fromIds);
+
+isSelected = fromIds~=toIds & (ismember(fromIds, addedIds) | ismember(toIds, addedIds));
+dependencies = unique([fromIds(isSelected), toIds(isSelected)], 'rows');
+fromIds = reshape(dependencies(:, 1), [], 1);
+toIds = reshape(dependencies(:, 2), [], 1);
+end
+
+function groups = iGroup(positions, values, numGroups)
+% Group sorted values by position, as row vectors. Empty groups are
+% 1-by-0.
+
+groups = repmat({zeros(1, 0)}, numGroups, 1);
+if isempty(positions)
+    return;
+end
+groups = accumarray(reshape(positions, [], 1), reshape(values, [], 1), ...
+    [numGroups, 1], @(x) {reshape(sort(x), 1, [])});
+isEmptyGroup = cellfun(@isempty, groups);
+groups(isEmptyGroup) = {zeros(1, 0)};
+end
+
+function ids = iPatchDownstream(ids, removedIds, newIds)
+% Replace the removed sub-graphs downstream of a sub-graph with the new
+% ones. The 0-by-1 set of a sub-graph without children stays as it is:
+% none of its edges changed.
+
+if isempty(ids) && iscolumn(ids)
+    return;
+end
+ids = sort([reshape(ids(~ismember(ids, removedIds)), 1, []), newIds]);
+end
+
+function levels = iPatchLevels(subGraphLevelTable, addedIds)
+% Compute the levels of the sub-graphs downstream of the sub-graphs
+% ADDEDIDS, in topological order. The levels of the sub-graphs upstream
+% are already correct.
+
+subGraphIds = subGraphLevelTable.SubGraphId;
+levels = subGraphLevelTable.SubGraphLevel;
+numSubGraphs = numel(subGraphIds);
+
+numDownstream = cellfun(@numel, subGraphLevelTable.ToSubGraphId);
+toIds = cellfun(@(ids) reshape(ids, [], 1), subGraphLevelTable.ToSubGraphId, ...
+    'UniformOutput', false);
+[~, toPosition] = ismember(vertcat(zeros(0, 1), toIds{:}), subGraphIds);
+fromPosition = repelem((1:numSubGraphs)', numDownstream);
+
+% The sub-graphs downstream of the new ones are reached from an extra
+% node that all the new ones depend on.
+[~, addedPosition] = ismember(addedIds, subGraphIds);
+sourceNode = numSubGraphs+1;
+quotientGraph = digraph( ...
+    [fromPosition; repmat(sourceNode, numel(addedPosition), 1)], ...
+    [toPosition; addedPosition], [], sourceNode);
+downstream = bfsearch(quotientGraph, sourceNode);
+downstream = sort(downstream(downstream~=sourceNode));
+
+levels(downstream) = amsla.common.nullId();
+downstreamGraph = subgraph(quotientGraph, downstream);
+if ~isdag(downstreamGraph)
+    return;
+end
+
+for position = reshape(downstream(toposort(downstreamGraph)), 1, [])
+    upstream = predecessors(quotientGraph, position);
+    upstream = upstream(upstream~=sourceNode);
+    levels(position) = max([0; levels(upstream)]) + 1;
+end
+end
@@ -0,0 +1,243 @@
+function [rowPointer, columnIndex, values, numRows] = readMatrixFile(fileName, varargin)
+%AMSLA.COMMON.INTERNAL.READMATRIXFILE Read the lower triangle of a sparse
+%matrix from a file, in compressed sparse row form.
+%
+%   [P, C, V, N] = AMSLA.COMMON.INTERNAL.READMATRIXFILE(F) Read the lower
+%   triangle of the N-by-N matrix in the file F. The elements of row K are
+%   P(K):P(K+1)-1, with columns C and values V. The elements of a row are
+%   sorted by column.
+%
+%   [__] = AMSLA.COMMON.INTERNAL.READMATRIXFILE(F, 'ChunkSize', S) Read
+%   the file S elements at a time. The default is 2^20.
+%
+%   The file is either a Matrix Market file or a binary CSR dump. Matrix
+%   Market files must use the "coordinate" layout, with "real", "integer"
+%   or "pattern" fields and "general" or "symmetric" symmetry. Pattern
+%   matrices get unit values. The elements of symmetric matrices above the
+%   diagonal are moved to the lower triangle, while those of general
+%   matrices are dropped.
+%
+%   A binary CSR dump is made of, in little-endian order:
+%      - the 8 characters 'AMSLACSR';
+%      - the number of rows and the number of elements, as uint64;
+%      - the 0-based row pointer, as NumRows+1 uint64;
+%      - the 0-based column of each element, as uint64;
+%      - the value of each element, as double.
+%   The elements above the diagonal are dropped.
+%
+%   The file is read twice, one chunk at a time: the first pass counts the
+%   elements of each row, the second one writes each element directly in
+%   its place. No copy of the whole file is held in memory.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+parser = inputParser;
+addParameter(parser, 'ChunkSize', 2^20, ...
+    @(x) isnumeric(x) && isscalar(x) && x>=1 && x==round(x));
+parse(parser, varargin{:});
+chunkSize = parser.Results.ChunkSize;
+
+fileId = fopen(fileName, "r", "ieee-le");
+assert(fileId>=0, "amsla:readMatrixFile:cannotOpenFile", ...
+    "Cannot open file '%s'.", fileName);
+closeFile = onCleanup(@() fclose(fileId));
+
+magic = fread(fileId, [1, 8], "*char");
+frewind(fileId);
+if isequal(magic, 'AMSLACSR')
+    reader = iCompressedRowsReader(fileId, fileName, chunkSize);
+else
+    reader = iMatrixMarketReader(fileId, fileName, chunkSize);
+end
+numRows = reader.NumRows;
+
+% First pass: count the elements of each row
+numElementsInRow = zeros(numRows, 1);
+reader.rewind();
+for k = 1:reader.NumChunks
+    rows = reader.readChunk(k);
+    numElementsInRow = numElementsInRow + accumarray(rows, 1, [numRows, 1]);
+end
+rowPointer = [1; cumsum(numElementsInRow)+1];
+
+% Second pass: write each element after those already in its row
+numElements = rowPointer(end)-1;
+columnIndex = zeros(numElements, 1);
+values = zeros(numElements, 1);
+nextPosition = rowPointer(1:end-1);
+reader.rewind();
+for k = 1:reader.NumChunks
+    [rows, columns, chunkValues] = reader.readChunk(k);
+    [rows, sorter] = sort(rows);
+    positions = nextPosition(rows) + iRankInGroup(rows);
+    columnIndex(positions) = columns(sorter);
+    values(positions) = chunkValues(sorter);
+    nextPosition = nextPosition + accumarray(rows, 1, [numRows, 1]);
+end
+
+[columnIndex, values] = iSortColumnsInRows(rowPointer, columnIndex, values);
+end
+
+%% HELPER FUNCTIONS
+
+function reader = iMatrixMarketReader(fileId, fileName, chunkSize)
+% Read a Matrix Market file sequentially, chunkSize lines at a time.
+
+header = lower(strsplit(strtrim(fgetl(fileId))));
+assert(numel(header)==5 && header{1}=="%%matrixmarket" && ...
+    header{2}=="matrix" && header{3}=="coordinate", ...
+    "amsla:readMatrixFile:badFile", "Unsupported Matrix Market file '%s'.", fileName);
+field = validatestring(header{4}, ["real", "integer", "pattern"]);
+symmetry = validatestring(header{5}, ["general", "symmetric"]);
+
+% Skip the comments, then read the size line
+sizeLine = fgetl(fileId);
+while startsWith(sizeLine, "%")
+    sizeLine = fgetl(fileId);
+end
+matrixSize = sscanf(sizeLine, "%d %d %d");
+assert(numel(matrixSize)==3 && matrixSize(1)>=1 && matrixSize(1)==matrixSize(2), ...
+    "amsla:readMatrixFile:badFile", "The matrix in file '%s' is not square.", fileName);
+firstElement = ftell(fileId);
+
+if field=="pattern"
+    formatSpec = "%f %f";
+else
+    formatSpec = "%f %f %f";
+end
+
+reader.NumRows = matrixSize(1);
+reader.NumChunks = ceil(matrixSize(3)/chunkSize);
+reader.rewind = @() fseek(fileId, firstElement, "bof");
+reader.readChunk = @(~) iReadMatrixMarketChunk(fileId, formatSpec, chunkSize, ...
+    symmetry=="symmetric", reader.NumRows);
+end
+
+function [rows, columns, values] = iReadMatrixMarketChunk(fileId, formatSpec, chunkSize, isSymmetric, numRows)
+% Read the next chunk of a Matrix Market file and keep the lower triangle.
+
+entries = textscan(fileId, formatSpec, chunkSize);
+rows = entries{1};
+columns = entries{2};
+if numel(entries)>2
+    values = entries{3};
+else
+    values = ones(size(rows));
+end
+
+if isSymmetric
+    [rows, columns] = deal(max(rows, columns), min(rows, columns));
+else
+    isLower = rows>=columns;
+    rows = rows(isLower);
+    columns = columns(isLower);
+    values = values(isLower);
+end
+iValidateChunk(rows, columns, values, numRows);
+end
+
+function reader = iCompressedRowsReader(fileId, fileName, chunkSize)
+% Read a binary CSR dump, a group of whole rows with about chunkSize
+% elements at a time.
+
+fseek(fileId, 8, "bof");
+matrixSize = fread(fileId, 2, "uint64=>double");
+assert(numel(matrixSize)==2 && matrixSize(1)>=1, ...
+    "amsla:readMatrixFile:badFile", "Invalid header in file '%s'.", fileName);
+numRows = matrixSize(1);
+numElements = matrixSize(2);
+filePointer = fread(fileId, numRows+1, "uint64=>double");
+assert(numel(filePointer)==numRows+1 && filePointer(1)==0 && ...
+    filePointer(end)==numElements && all(diff(filePointer)>=0), ...
+    "amsla:readMatrixFile:badFile", "Invalid row pointer in file '%s'.", fileName);
+firstColumn = ftell(fileId);
+firstValue = firstColumn + 8*numElements;
+
+% Each chunk starts with the row whose first element begins a new block of
+% chunkSize elements.
+chunkOfRow = floor(filePointer(1:end-1)/chunkSize);
+firstRowOfChunk = [find([true; diff(chunkOfRow)~=0]); numRows+1];
+
+reader.NumRows = numRows;
+reader.NumChunks = numel(firstRowOfChunk)-1;
+reader.rewind = @() [];
+reader.readChunk = @(k) iReadCompressedRowsChunk(fileId, filePointer, ...
+    firstRowOfChunk(k):(firstRowOfChunk(k+1)-1), firstColumn, firstValue);
+end
+
+function [rows, columns, values] = iReadCompressedRowsChunk(fileId, filePointer, chunkRows, firstColumn, firstValue)
+% Read the elements of a group of rows of a binary CSR dump and keep the
+% lower triangle. The values are read only if requested.
+
+firstElement = filePointer(chunkRows(1));
+numElements = filePointer(chunkRows(end)+1) - firstElement;
+rows = repelem(reshape(chunkRows, [], 1), diff(filePointer([chunkRows, chunkRows(end)+1])));
+
+fseek(fileId, firstColumn + 8*firstElement, "bof");
+columns = fread(fileId, numElements, "uint64=>double") + 1;
+isLower = rows>=columns;
+rows = rows(isLower);
+columns = columns(isLower);
+
+if nargout>2
+    fseek(fileId, firstValue + 8*firstElement, "bof");
+    values = fread(fileId, numElements, "double");
+    values = values(isLower);
+    iValidateChunk(rows, columns, values, numel(filePointer)-1);
+end
+end
+
+function iValidateChunk(rows, columns, values, numRows)
+% Check the indices and values read from a file.
+
+assert(numel(rows)==numel(columns) && numel(columns)==numel(values), ...
+    "amsla:readMatrixFile:badFile", "Truncated matrix file.");
+assert(all(rows==round(rows) & columns>=1 & rows<=numRows & columns==round(columns)), ...
+    "amsla:readMatrixFile:badFile", "Invalid element indices in the matrix file.");
+assert(all(isfinite(values)), ...
+    "amsla:readMatrixFile:badFile", "Non-finite values in the matrix file.");
+end
+
+function rank = iRankInGroup(sortedIds)
+% Position of each element among those with the same ID, from 0.
+
+positions = reshape(1:numel(sortedIds), [], 1);
+isFirst = [true; diff(sortedIds)~=0];
+rank = positions - cummax(positions.*isFirst);
+end
+
+function [columnIndex, values] = iSortColumnsInRows(rowPointer, columnIndex, values)
+% Sort the elements of each row by column, unless they are already sorted,
+% and check that no element appears twice.
+
+isRowStart = false(numel(columnIndex), 1);
+isRowStart(rowPointer(rowPointer<rowPointer(end))) = true;
+isIncreasing = [true; diff(columnIndex)>0] | isRowStart;
+if all(isIncreasing)
+    return;
+end
+
+% Two stable sorts: by column, then by row
+rows = repelem(reshape(1:(numel(rowPointer)-1), [], 1), diff(rowPointer));
+[~, byColumn] = sort(columnIndex);
+[~, byRow] = sort(rows(byColumn));
+sorter = byColumn(byRow);
+columnIndex = columnIndex(sorter);
+values = values(sorter);
+
+assert(all([true; diff(columnIndex)~=0] | isRowStart), ...
+    "amsla:readMatrixFile:duplicateElements", ...
+    "The matrix file contains the same element twice.");
+end
@@ -0,0 +1,25 @@
+function segmentIds = segmentIds(offsets)
+%AMSLA.COMMON.INTERNAL.SEGMENTIDS Index of the segment of each element in
+%an offsets-indices pair.
+%
+%   S = AMSLA.COMMON.INTERNAL.SEGMENTIDS(O) Return the column vector S such
+%   that S(J)=K for all J in O(K):O(K+1)-1. S can be used as the subscripts
+%   of segmented reductions with accumarray.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+offsets = reshape(offsets, [], 1);
+segmentIds = repelem((1:numel(offsets)-1)', diff(offsets));
+end
@@ -74,7 +74,16 @@ classdef(Abstract) BreadthFirstSearch < handle
             assert(numel(unique(currNodeIds))==numel(currNodeIds), ...
                 "Ambiguous input.");
             
+            % The size of each frontier is only kept while tracing, and
+            % recorded once the search is over.
+            isTracing = amsla.common.Tracer.isEnabled();
+            frontierSizes = zeros(1, 0);
+            
             while ~isempty(currNodeIds)
+                if isTracing
+                    frontierSizes(end+1) = numel(currNodeIds); %#ok<AGROW>
+                end
+                
                 % Assign the current tags to the current nodes
                 obj.assignTagsToNodes(currNodeIds, currTags);
                 
@@ -93,6 +102,11 @@ classdef(Abstract) BreadthFirstSearch < handle
                     break;
                 end
             end
+            
+            if isTracing
+                amsla.common.Tracer.count("bfsIterations", numel(frontierSizes));
+                amsla.common.Tracer.count("bfsFrontierSize", frontierSizes);
+            end
         end
         
         function compOut = computeBasedOnParents(obj, nodeIds, processPerNodeFcn)
@@ -116,9 +130,10 @@ classdef(Abstract) BreadthFirstSearch < handle
             %they satisfy the given function.
             
             % Find children of current nodes
-            dataStructure = obj.DataStructure;
-            nodeIds = dataStructure.childrenOfNode(currentNodeIds);
-            nodeIds = unique(amsla.common.numericArray(nodeIds));
+            nodeIds = obj.uniqueChildrenOfNodes(currentNodeIds);
+            if isempty(nodeIds)
+                return;
+            end
             
             % Find out which ones are ready
             isChildReady = obj.computeBasedOnParents(nodeIds, isReadyFcn);
@@ -130,25 +145,44 @@ classdef(Abstract) BreadthFirstSearch < handle
             %input nodes if all of their parents have been assigned a tag.
             
             % Find children of current nodes
-            nodeIds = obj.selectChildrenIfReady(currentNodeIds, @isNodeReady);
+            nodeIds = obj.uniqueChildrenOfNodes(currentNodeIds);
             
-            function tf = isNodeReady(parentNodes)
-                tf = ~any(iIsNullId(tagAccessor(obj.DataStructure, parentNodes)));
-            end
+            % A child is ready when none of its parents has a null tag
+            [parentTags, segmentIds, numNodes] = obj.tagsOfParents(nodeIds, tagAccessor);
+            numNotAssigned = accumarray(segmentIds, ...
+                double(iIsNullId(parentTags)), [numNodes, 1]);
+            nodeIds = nodeIds(numNotAssigned'==0);
         end
         
         function tagId = maxTagOfParents(obj, currentNodeIds, tagAccessor)
             %MAXSUBGRAPHOFPARENTS Get the highest tag assigned to the
             %parent nodes of each input node.
             
-            tagId = obj.computeBasedOnParents(currentNodeIds, @getLargestTagId);
+            [parentTags, segmentIds, numNodes] = obj.tagsOfParents(currentNodeIds, tagAccessor);
+            tagId = accumarray(segmentIds, parentTags, [numNodes, 1], ...
+                @max, amsla.common.nullId())';
+        end
+        
+        function nodeIds = uniqueChildrenOfNodes(obj, currentNodeIds)
+            %UNIQUECHILDRENOFNODES Get the unique children of all the input
+            %nodes, as a row vector.
             
-            function nextTagId = getLargestTagId(allParents)
-                % Get the components of parent nodes
-                nextTagId = tagAccessor(obj.DataStructure, allParents);
-                
-                % Compute the max
-                nextTagId = max(nextTagId);
+            [~, nodeIds] = obj.DataStructure.childrenOfFrontier(iArray(currentNodeIds));
+            nodeIds = unique(reshape(nodeIds, 1, []));
+        end
+        
+        function [parentTags, segmentIds, numNodes] = tagsOfParents(obj, nodeIds, tagAccessor)
+            %TAGSOFPARENTS Get the tags of the parents of all the input
+            %nodes, and the index of the input node to which each parent
+            %belongs.
+            
+            [offsets, parentIds] = obj.DataStructure.parentsOfFrontier(iArray(nodeIds));
+            numNodes = numel(offsets)-1;
+            segmentIds = amsla.common.internal.segmentIds(offsets);
+            if isempty(parentIds)
+                parentTags = zeros(0, 1);
+            else
+                parentTags = reshape(tagAccessor(obj.DataStructure, parentIds), [], 1);
             end
         end
         
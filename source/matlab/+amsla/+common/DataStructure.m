@@ -8,11 +8,16 @@ classdef DataStructure < amsla.common.DataStructureInterface
     %   given the row indices (I), column indices (J), and values (V) of the
     %   edges in the graph.
     %
+    %	G = AMSLA.COMMON.DATASTRUCTURE(I,J,V,'Compact',true) Construct a
+    %	DataStructure object that uses less memory. See DataStructure.
+    %
     %   DataStructure edge/node-level methods:
     %      listOfNodes           - Get the list of the IDs of all the nodes
     %                              in the graph.
     %      childrenOfNode        - Get the children of a node.
     %      parentsOfNode         - Get the parents of a node.
+    %      childrenOfFrontier    - Get the children of a set of nodes.
+    %      parentsOfFrontier     - Get the parents of a set of nodes.
     %      listOfEdges           - Get the list of the IDs of all the edges
     %                              in the graph.
     %      exitingEdgesOfNode    - Get the edges coming out of  a node.
@@ -22,6 +27,7 @@ classdef DataStructure < amsla.common.DataStructureInterface
     %      loopEdgesOfNode       - Get the edges entering and exiting the
     %                              same node.
     %      weightOfEdge          - Get the weight of an edge.
+    %      setWeightOfEdge       - Change the weight of an edge.
     %
     %   DataStructure sub-graph-level methods:
     %      listOfSubGraphs       - Get the list of sub-graphs.
@@ -44,6 +50,10 @@ classdef DataStructure < amsla.common.DataStructureInterface
     %
     %   Other DataStructure methods:
     %      plot                  - Plot a DataStructure.
+    %      memoryFootprint       - Get the memory used by each component
+    %                              of a DataStructure.
+    %      isCompact             - Whether a DataStructure uses the compact
+    %                              layout.
     
     % Copyright 2018-2020 Andrea Picciau
     %
@@ -79,6 +89,27 @@ classdef DataStructure < amsla.common.DataStructureInterface
         %      TimeSlot      - Time slot to which the node belongs
         BaseGraph
         
+        %Whether the parents and children of all the nodes were computed
+        %when the object was constructed.
+        HasEagerAdjacency
+        
+        %Whether the object uses the compact layout. The IDs of nodes and
+        %edges are integers, the sub-graphs and time-slots are the
+        %smallest integers that fit, with 0 as the null ID, and the
+        %parents and children are in the pointer-index pairs below instead
+        %of the ParentsId and ChildrenId columns.
+        IsCompact = false
+        
+        %Parents of the nodes in compact layout: the columns of the edges
+        %sorted by row are ParentsIndex(ParentsPointer(K):
+        %ParentsPointer(K+1)-1) for node K, loops included.
+        ParentsPointer
+        ParentsIndex
+        
+        %Children of the nodes in compact layout, as the parents.
+        ChildrenPointer
+        ChildrenIndex
+        
     end
     
     %% PUBLIC METHODS
@@ -87,13 +118,45 @@ classdef DataStructure < amsla.common.DataStructureInterface
         
         %% General
         
-        function obj = DataStructure(I, J, V)
+        function obj = DataStructure(I, J, V, varargin)
             %ENHANCEDGRAPH Construct an DataStructure object.
-            
-            % TODO: parse inputs
+            %
+            %   G = AMSLA.COMMON.DATASTRUCTURE(I, J, V) Construct the graph
+            %   of the sparse matrix with the elements V in rows I and
+            %   columns J.
+            %
+            %   G = AMSLA.COMMON.DATASTRUCTURE(__, 'Adjacency', A) Choose
+            %   when the parents and children of the nodes are computed. A
+            %   can be "eager" (default), to compute them for all the nodes
+            %   when the object is constructed, or "lazy", to compute them
+            %   for each node the first time they are requested.
+            %
+            %   G = AMSLA.COMMON.DATASTRUCTURE(__, 'Compact', true) Store the
+            %   IDs of nodes and edges as int32 and the sub-graphs and
+            %   time-slots as uint16 or int16 when the number of nodes
+            %   allows it, int32 or uint32 otherwise. The parents and
+            %   children of the nodes are computed on construction and
+            %   stored as pointer-index pairs instead of a cell array, and
+            %   the 'Adjacency' option is ignored. All the methods still
+            %   return doubles. A sub-graph or time-slot that does not fit
+            %   in its integer type turns its column back to double.
+            
+            [adjacency, isCompact] = iParseConstructorArguments(varargin{:});
+            obj.HasEagerAdjacency = adjacency=="eager" && ~isCompact;
+            obj.IsCompact = isCompact;
             
             % Initialise internal data
-            obj.BaseGraph = iInitialiseDataStructure(I,J,V);
+            startTime = amsla.common.Tracer.timestamp();
+            obj.BaseGraph = iInitialiseDataStructure(I, J, V, obj.HasEagerAdjacency, isCompact);
+            if isCompact
+                rows = obj.BaseGraph.Edges.EndNodes(:, 1);
+                columns = obj.BaseGraph.Edges.EndNodes(:, 2);
+                numNodes = numnodes(obj.BaseGraph);
+                [obj.ParentsPointer, obj.ParentsIndex] = iCompactAdjacency(rows, columns, numNodes);
+                [obj.ChildrenPointer, obj.ChildrenIndex] = iCompactAdjacency(columns, rows, numNodes);
+            end
+            amsla.common.Tracer.span("buildDataStructure", startTime, ...
+                struct("numEdges", numel(V)));
         end
         
         function h = plot(obj, varargin)
@@ -119,11 +182,42 @@ classdef DataStructure < amsla.common.DataStructureInterface
             end
         end
         
+        function footprint = memoryFootprint(obj)
+            %MEMORYFOOTPRINT(G) Get the memory used by each component of
+            %the graph.
+            %
+            %   T = MEMORYFOOTPRINT(G) Return a table with the name of each
+            %   component (Component) and the bytes it uses (Bytes). The
+            %   total is sum(T.Bytes).
+            
+            nodes = obj.BaseGraph.Nodes;
+            edges = obj.BaseGraph.Edges;
+            if obj.IsCompact
+                parents = {obj.ParentsPointer, obj.ParentsIndex};
+                children = {obj.ChildrenPointer, obj.ChildrenIndex};
+            else
+                parents = {nodes.ParentsId};
+                children = {nodes.ChildrenId};
+            end
+            
+            footprint = amsla.common.internal.footprintTable( ...
+                ["Node IDs", "Parents", "Children", "Sub-graphs", ...
+                "Edge end nodes", "Edge IDs", "Edge weights", "Time-slots"], ...
+                {nodes.Id, parents, children, nodes.SubGraphId, ...
+                edges.EndNodes, edges.Id, edges.Weight, edges.TimeSlot});
+        end
+        
+        function tf = isCompact(obj)
+            %ISCOMPACT(G) True if the graph was constructed with
+            %'Compact', true.
+            tf = obj.IsCompact;
+        end
+        
         %% Graph operations
         
         function outIds = listOfNodes(obj)
             %LISTOFNODES(G) Get the IDs of all the nodes in the graph.
-            outIds = unique(obj.BaseGraph.Nodes.Id)';
+            outIds = unique(double(obj.BaseGraph.Nodes.Id))';
         end
         
         function outIds = childrenOfNode(obj, nodeIds)
@@ -138,9 +232,21 @@ classdef DataStructure < amsla.common.DataStructureInterface
             outIds = getNodesConnectedToNode(obj, nodeIds, "Parents");
         end
         
+        function [offsets, outIds] = childrenOfFrontier(obj, nodeIds)
+            %CHILDRENOFFRONTIER(G, NODEID) Get the IDs of the children of
+            %a set of nodes as an offsets-indices pair.
+            [offsets, outIds] = getNodesConnectedToFrontier(obj, nodeIds, "Children");
+        end
+        
+        function [offsets, outIds] = parentsOfFrontier(obj, nodeIds)
+            %PARENTSOFFRONTIER(G, NODEID) Get the IDs of the parents of a
+            %set of nodes as an offsets-indices pair.
+            [offsets, outIds] = getNodesConnectedToFrontier(obj, nodeIds, "Parents");
+        end
+        
         function outIds = listOfEdges(obj)
             %LISTOFEDGES(G) Get the IDs of all the edges in the graph.
-            outIds = unique(obj.BaseGraph.Edges.Id)';
+            outIds = unique(double(obj.BaseGraph.Edges.Id))';
         end
         
         function outIds = exitingEdgesOfNode(obj, nodeIds)
@@ -184,6 +290,12 @@ classdef DataStructure < amsla.common.DataStructureInterface
             value = value(inverseSorter);
         end
         
+        function setWeightOfEdge(obj, edgeIds, weights)
+            %SETWEIGHTOFEDGE(G, EDGEID, W) Change the weight of one or more
+            %edges. The sparsity pattern of the graph does not change.
+            obj.BaseGraph.Edges.Weight(edgeIds) = weights;
+        end
+        
         %% Sub-graph level operations
         
         function varargout = listOfSubGraphs(obj)
@@ -212,7 +324,7 @@ classdef DataStructure < amsla.common.DataStructureInterface
         function timeSlotIds = listOfTimeSlots(obj)
             %LISTOFTIMESLOTS Get all the time-slots in the graph
             
-            timeSlotIds = unique(iRow(obj.BaseGraph.Edges.TimeSlot));
+            timeSlotIds = unique(iRow(iDecodeTags(obj.BaseGraph.Edges.TimeSlot)));
         end
         
         function edgeIds = edgesInSubGraphAndTimeSlot(obj, subGraphId, timeSlotId)
@@ -220,8 +332,8 @@ classdef DataStructure < amsla.common.DataStructureInterface
             %sub-graph.
             
             edgeSelector = (obj.edgesInSubGraph(subGraphId));
-            possibleTimeSlotIds = obj.BaseGraph.Edges.TimeSlot(edgeSelector);
-            possibleEdgeIds = obj.BaseGraph.Edges.Id(edgeSelector);
+            possibleTimeSlotIds = iDecodeTags(obj.BaseGraph.Edges.TimeSlot(edgeSelector));
+            possibleEdgeIds = double(obj.BaseGraph.Edges.Id(edgeSelector));
             edgeSelector = ismember(possibleTimeSlotIds, timeSlotId);
             edgeIds = possibleEdgeIds(edgeSelector);
         end
@@ -231,7 +343,7 @@ classdef DataStructure < amsla.common.DataStructureInterface
             %sub-graph.
             
             edgeSelector = obj.edgesInSubGraph(subGraphId);
-            timeSlotIds = obj.BaseGraph.Edges.TimeSlot(edgeSelector);
+            timeSlotIds = iDecodeTags(obj.BaseGraph.Edges.TimeSlot(edgeSelector));
             % Remove null IDs
             timeSlotIds(amsla.common.isNullId(timeSlotIds)) = [];
             timeSlotIds = unique(timeSlotIds);
@@ -239,13 +351,13 @@ classdef DataStructure < amsla.common.DataStructureInterface
         
         function outIds = timeSlotOfEdge(obj, edgeIds)
             %TIMESLOTOFEDGE(G, ID) Get the time-slot IDs of one or more edges.
-            outIds = obj.BaseGraph.Edges.TimeSlot(edgeIds);
+            outIds = iDecodeTags(obj.BaseGraph.Edges.TimeSlot(edgeIds));
         end
         
         function setTimeSlotOfEdge(obj, edgeIds, timeSlotIds)
             %SETTIMESLOTOFEDGE(G, ID) Assign one or more edges to the given
             %time-slot IDs.
-            obj.BaseGraph.Edges.TimeSlot(edgeIds) = timeSlotIds;
+            obj.setTags("Edges", "TimeSlot", edgeIds, timeSlotIds);
         end
         
     end
@@ -254,6 +366,20 @@ classdef DataStructure < amsla.common.DataStructureInterface
     
     methods (Access=private)
         
+        function setTags(obj, tableName, tableColumn, rowIds, tags)
+            % Write sub-graph or time-slot IDs in a column of the table of
+            % nodes or edges, which is turned back to double if an ID does
+            % not fit in its integer type.
+            
+            column = obj.BaseGraph.(tableName).(tableColumn);
+            if isinteger(column) && ~iFitsInTags(tags, class(column))
+                obj.BaseGraph.(tableName).(tableColumn) = iDecodeTags(column);
+            else
+                tags = iEncodeTags(tags, class(column));
+            end
+            obj.BaseGraph.(tableName).(tableColumn)(rowIds) = tags;
+        end
+        
         function edgeSel = edgesInSubGraph(obj, subGraphId)
             % Select the edges in the given sub-graph.
             
@@ -264,8 +390,6 @@ classdef DataStructure < amsla.common.DataStructureInterface
         
         function outIds = getNodesConnectedToNode(obj, nodeIds, nodeProperty)
             % Get parents or children of one or more nodes
-            [nodeIds, ~, sorter] = unique(nodeIds);
-            selNodes = ismember(obj.BaseGraph.Nodes.Id, nodeIds);
             
             % Check which property to retrieve
             nodeProperty = validatestring(nodeProperty, ["Parents", "Children"]);
@@ -277,6 +401,37 @@ classdef DataStructure < amsla.common.DataStructureInterface
                 cachingFunction = @iCacheChildrenOfOneNode;
             end
             
+            % The lists of the compact layout include the loops, which are
+            % filtered on request
+            if obj.IsCompact
+                if strcmp(nodeProperty, "Parents")
+                    [pointer, index] = deal(obj.ParentsPointer, obj.ParentsIndex);
+                else
+                    [pointer, index] = deal(obj.ChildrenPointer, obj.ChildrenIndex);
+                end
+                if isscalar(nodeIds)
+                    outIds = iCompactList(pointer, index, nodeIds);
+                else
+                    outIds = arrayfun(@(x) iCompactList(pointer, index, x), ...
+                        reshape(nodeIds, 1, []), 'UniformOutput', false);
+                end
+                return;
+            end
+            
+            % All the lists have been computed on construction: the node IDs
+            % are the rows of the table
+            if obj.HasEagerAdjacency
+                if isscalar(nodeIds)
+                    outIds = obj.BaseGraph.Nodes.(tableColumn){nodeIds};
+                else
+                    outIds = reshape(obj.BaseGraph.Nodes.(tableColumn)(nodeIds), 1, []);
+                end
+                return;
+            end
+            
+            [nodeIds, ~, sorter] = unique(nodeIds);
+            selNodes = ismember(obj.BaseGraph.Nodes.Id, nodeIds);
+            
             % Cache the children indices that have never been cached
             cacheContent = obj.BaseGraph.Nodes.(tableColumn)(selNodes)';
             if iscell(cacheContent)
@@ -313,6 +468,43 @@ classdef DataStructure < amsla.common.DataStructureInterface
             end
         end
         
+        function [offsets, outIds] = getNodesConnectedToFrontier(obj, nodeIds, nodeProperty)
+            % Get parents or children of a set of nodes as an
+            % offsets-indices pair, from the lists of the nodes. The cost
+            % is proportional to the number of nodes returned, not to the
+            % number of edges of the graph.
+            
+            nodeIds = reshape(double(nodeIds), [], 1);
+            
+            % The lists of the compact layout include the loops
+            if obj.IsCompact
+                if strcmp(nodeProperty, "Parents")
+                    [pointer, index] = deal(obj.ParentsPointer, obj.ParentsIndex);
+                else
+                    [pointer, index] = deal(obj.ChildrenPointer, obj.ChildrenIndex);
+                end
+                firstIndex = double(pointer(nodeIds));
+                lastIndex = double(pointer(nodeIds+1))-1;
+                outIds = double(index(amsla.common.internal.expandRanges(firstIndex, lastIndex)));
+                segmentIds = amsla.common.internal.segmentIds( ...
+                    [1; cumsum(lastIndex-firstIndex+1)+1]);
+                isLoop = reshape(outIds, [], 1)==nodeIds(segmentIds);
+                outIds = reshape(outIds(~isLoop), [], 1);
+                numConnected = accumarray(segmentIds(~isLoop), 1, [numel(nodeIds), 1]);
+                offsets = [1; cumsum(numConnected)+1];
+                return;
+            end
+            
+            % Eager lists are read directly, lazy ones are cached first
+            connectedIds = getNodesConnectedToNode(obj, nodeIds, nodeProperty);
+            if ~iscell(connectedIds)
+                connectedIds = {connectedIds};
+            end
+            numConnected = reshape(cellfun(@numel, connectedIds), [], 1);
+            outIds = reshape([zeros(1, 0), connectedIds{:}], [], 1);
+            offsets = [1; cumsum(numConnected)+1];
+        end
+        
         function outIds = getEdgesConnectedToNode(obj, nodeIds, edgeProperty)
             % Get the edges entering one or more nodes
             
@@ -360,27 +552,15 @@ classdef DataStructure < amsla.common.DataStructureInterface
             nodeProperty = validatestring(nodeProperty, ...
                 ["Entering", "Exiting"]);
             if strcmp(nodeProperty, "Entering")
-                finderFunction = @iFindEnteringNodeOfOneEdge;
+                endNodesColumn = 2;
             elseif strcmp(nodeProperty, "Exiting")
-                finderFunction = @iFindExitingNodeOfOneEdge;
+                endNodesColumn = 1;
             end
             
-            if isscalar(edgeIds)
-                outIds = finderFunction(edgeIds);
-            else
-                outIds = arrayfun(finderFunction, edgeIds, 'UniformOutput', true);
-            end
-            
-            % Helper functions
-            function nodeId = iFindEnteringNodeOfOneEdge(edgeId)
-                nodeId = obj.BaseGraph.Edges.EndNodes( ...
-                    obj.BaseGraph.Edges.Id==edgeId, 2)';
-            end
-            
-            function nodeId = iFindExitingNodeOfOneEdge(edgeId)
-                nodeId = obj.BaseGraph.Edges.EndNodes( ...
-                    obj.BaseGraph.Edges.Id==edgeId, 1)';
-            end
+            % Edge IDs are the row indices in the table of edges.
+            outIds = reshape( ...
+                obj.BaseGraph.Edges.EndNodes(edgeIds, endNodesColumn), ...
+                size(edgeIds));
         end
         
         function varargout = getListOfGraphSet(obj, graphSetType)
@@ -389,8 +569,9 @@ classdef DataStructure < amsla.common.DataStructureInterface
             tableColumn = iGetTableColumnByGraphSetType(graphSetType);
             
             outIds = [];
-            if ~any(amsla.common.isNullId(obj.BaseGraph.Nodes.(tableColumn)))
-                outIds = unique(obj.BaseGraph.Nodes.(tableColumn))';
+            graphSetIds = iDecodeTags(obj.BaseGraph.Nodes.(tableColumn));
+            if ~any(amsla.common.isNullId(graphSetIds))
+                outIds = unique(graphSetIds)';
             end
             varargout{1} = outIds;
             
@@ -402,7 +583,7 @@ classdef DataStructure < amsla.common.DataStructureInterface
             
             % Helper function
             function numelOneGraphSet = iGetNodesInOneGraphSet(graphSetId)
-                numelOneGraphSet = sum(obj.BaseGraph.Nodes.(tableColumn)==graphSetId);
+                numelOneGraphSet = sum(graphSetIds==graphSetId);
             end
         end
         
@@ -421,7 +602,7 @@ classdef DataStructure < amsla.common.DataStructureInterface
             % Helper functions
             function graphSetNodes = iFindNodesInOneGraphSet(grapSetId)
                 selComponent = obj.BaseGraph.Nodes.(tableColumn) == grapSetId;
-                graphSetNodes = obj.BaseGraph.Nodes.Id(selComponent);
+                graphSetNodes = double(obj.BaseGraph.Nodes.Id(selComponent));
             end
             
             function nodesWithNoParents = iFindNodesWithNoParents(nodesInComponent)
@@ -455,31 +636,24 @@ classdef DataStructure < amsla.common.DataStructureInterface
             
             tableColumn = iGetTableColumnByGraphSetType(graphSetType);
             
+            % The node IDs are the rows of the table
             accessType = validatestring(accessType, ["Set", "Get"]);
             if strcmp(accessType, "Set")
                 % Check ambiguity of inputs
                 iCheckAssignmentAmbiguity(nodeIds, graphSetId);
-                accessor = @iSetGraphSetIdOfOneNode;
+                obj.setTags("Nodes", tableColumn, nodeIds, graphSetId);
+                outIds = reshape(graphSetId, size(nodeIds));
             elseif strcmp(accessType, "Get")
-                accessor = @iGetGraphSetIdOfOneNode;
-            end
-            
-            outIds = arrayfun(accessor, nodeIds, graphSetId, 'UniformOutput', true);
-            
-            % Helper functions
-            function graphSetId = iGetGraphSetIdOfOneNode(nodeId, ~)
-                graphSetId = obj.BaseGraph.Nodes.(tableColumn)(obj.BaseGraph.Nodes.Id==nodeId);
-            end
-            
-            function newGraphSetId = iSetGraphSetIdOfOneNode(nodeId, newGraphSetId)
-                obj.BaseGraph.Nodes.(tableColumn)(obj.BaseGraph.Nodes.Id==nodeId) = newGraphSetId;
+                outIds = reshape(iDecodeTags(obj.BaseGraph.Nodes.(tableColumn)(nodeIds)), ...
+                    size(nodeIds));
             end
         end
         
         function outColours = getNodeColours(obj)
             % Get the colours to be used in the graph plot
-            if any(~amsla.common.isNullId(obj.BaseGraph.Nodes.SubGraphId))
-                outColours = obj.BaseGraph.Nodes.SubGraphId;            
+            subGraphIds = iDecodeTags(obj.BaseGraph.Nodes.SubGraphId);
+            if any(~amsla.common.isNullId(subGraphIds))
+                outColours = subGraphIds;            
             else
                 outColours = zeros(height(obj.BaseGraph.Nodes), 1);
             end
@@ -491,23 +665,132 @@ end
 
 %% HELPER FUNCTIONS
 
-function outGraph = iInitialiseDataStructure(I, J, V)
+function [adjacency, isCompact] = iParseConstructorArguments(varargin)
+% Parse the optional inputs to the constructor.
+
+parser = inputParser;
+addParameter(parser, 'Adjacency', "eager", @(x) isStringScalar(x) || ischar(x));
+addParameter(parser, 'Compact', false, @(x) islogical(x) && isscalar(x));
+parse(parser, varargin{:});
+
+adjacency = string(validatestring(parser.Results.Adjacency, ["eager", "lazy"]));
+isCompact = parser.Results.Compact;
+end
+
+function outGraph = iInitialiseDataStructure(I, J, V, hasEagerAdjacency, isCompact)
 % Initialises the digraph object and the overall object
 outGraph = digraph(I, J, V);
+numNodes = numnodes(outGraph);
+numEdges = numedges(outGraph);
+
+if isCompact
+    assert(numEdges<intmax("int32"), "amsla:DataStructure:tooLargeForCompact", ...
+        "The graph has too many edges for the compact layout.");
+    [subGraphClass, timeSlotClass] = iTagClasses(numNodes);
+    outGraph.Nodes.Id = (int32(1):int32(numNodes))';
+    outGraph.Nodes.SubGraphId = zeros(numNodes, 1, subGraphClass);
+    outGraph.Edges.Id = (int32(1):int32(numEdges))';
+    outGraph.Edges.TimeSlot = zeros(numEdges, 1, timeSlotClass);
+    return;
+end
 
 % Set nodes
-numNodes = numnodes(outGraph);
 outGraph.Nodes.Id = (1:numNodes)';
-outGraph.Nodes.ParentsId = num2cell(amsla.common.nullId(numNodes, 1));
-outGraph.Nodes.ChildrenId = num2cell(amsla.common.nullId(numNodes, 1));
+if hasEagerAdjacency
+    rows = outGraph.Edges.EndNodes(:, 1);
+    columns = outGraph.Edges.EndNodes(:, 2);
+    outGraph.Nodes.ParentsId = iAdjacencyLists(rows, columns, numNodes);
+    outGraph.Nodes.ChildrenId = iAdjacencyLists(columns, rows, numNodes);
+else
+    outGraph.Nodes.ParentsId = num2cell(amsla.common.nullId(numNodes, 1));
+    outGraph.Nodes.ChildrenId = num2cell(amsla.common.nullId(numNodes, 1));
+end
 outGraph.Nodes.SubGraphId = amsla.common.nullId(numNodes, 1);
 
 % Set edges
-numEdges = numedges(outGraph);
 outGraph.Edges.Id = (1:numEdges)';
 outGraph.Edges.TimeSlot = amsla.common.nullId(numEdges, 1);
 end
 
+function adjacency = iAdjacencyLists(fromNodes, toNodes, numNodes)
+% Compute the list of the nodes connected to each node with a single sort.
+% The K-th list has the nodes toNodes(E) of the non-loop edges E for which
+% fromNodes(E) is K, in the order of the edges.
+
+isLoop = fromNodes==toNodes;
+[sortedNodes, sorter] = sort(fromNodes(~isLoop));
+connectedNodes = toNodes(~isLoop);
+connectedNodes = reshape(connectedNodes(sorter), 1, []);
+numConnected = accumarray(sortedNodes, 1, [numNodes, 1]);
+adjacency = reshape(mat2cell(connectedNodes, 1, numConnected'), [], 1);
+
+% Give empty lists the same size as those computed lazily: a node whose
+% only edge is its loop has a 0-by-0 list.
+numEdges = accumarray(fromNodes, 1, [numNodes, 1]);
+adjacency(numConnected==0 & numEdges==1) = {[]};
+end
+
+function [pointer, index] = iCompactAdjacency(fromNodes, toNodes, numNodes)
+% Group the nodes toNodes(E) of all the edges E by fromNodes(E), in the
+% order of the edges.
+
+[~, sorter] = sort(fromNodes);
+index = int32(toNodes(sorter));
+pointer = int32([1; cumsum(accumarray(fromNodes, 1, [numNodes, 1]))+1]);
+end
+
+function outIds = iCompactList(pointer, index, nodeId)
+% Nodes connected to a node in compact layout, without its loops. As in the
+% lists computed lazily, a node whose only edge is its loop gets a 0-by-0
+% list.
+
+outIds = double(reshape(index(pointer(nodeId):(pointer(nodeId+1)-1)), 1, []));
+outIds = outIds(outIds~=nodeId);
+end
+
+function [subGraphClass, timeSlotClass] = iTagClasses(numNodes)
+% Smallest integer types for the sub-graphs and the time-slots, which are
+% at most as many as the nodes. Time-slots can be negative and 0 is the null
+% ID.
+
+if numNodes<intmax("int16")
+    subGraphClass = "uint16";
+    timeSlotClass = "int16";
+else
+    subGraphClass = "uint32";
+    timeSlotClass = "int32";
+end
+end
+
+function tf = iFitsInTags(tags, tagClass)
+% Check that IDs can be stored in an integer type, where 0 is the null ID.
+
+isNull = amsla.common.isNullId(tags);
+tags = tags(~isNull);
+tf = all(tags==round(tags) & tags~=0 & ...
+    tags>=intmin(tagClass) & tags<=intmax(tagClass));
+end
+
+function tags = iEncodeTags(tags, tagClass)
+% Convert IDs to the type of their column. Null IDs become 0.
+
+if tagClass~="double"
+    tags(amsla.common.isNullId(tags)) = 0;
+    tags = cast(tags, tagClass);
+end
+end
+
+function tags = iDecodeTags(tags)
+% Convert IDs stored in any type to double. The 0 of integer types becomes
+% the null ID.
+
+if isinteger(tags)
+    isNull = tags==0;
+    tags = double(tags);
+    tags(isNull) = amsla.common.nullId();
+end
+end
+
 function tableColumn = iGetTableColumnByGraphSetType(graphSetType)
 validatestring(graphSetType, "Sub-graph");
 tableColumn = "SubGraphId";
@@ -7,6 +7,12 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
     %                        associated with nodes in the graph.
     %      tagOfNode       - Get the tag of a node.
     %      setTagOfNode    - Associate a node with a tag.
+    %      addTag          - Store a new type of tag next to the
+    %                        existing ones.
+    %
+    %   The tags are stored in a numeric array with one row per node, and
+    %   are read and written by indexing with the node IDs, which must be
+    %   1 to N.
     
     % Copyright 2018-2020 Andrea Picciau
     %
@@ -26,22 +32,32 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
         %The DataStructure object being wrapped
         DataStructure
         
-        %Maps nodes to tags
-        NodeTagMap
+        %Tags of the nodes, one column per tag name. Row K holds the tags
+        %of the node with ID K.
+        TagStore
+        
+        %Maps each tag name to its column of TagStore
+        TagColumn
     end
     
     %% PROTECTED
     
     methods(Access=protected)
+        function copiedObj = copyElement(obj)
+            %COPYELEMENT(D) Copy the decorator and the DataStructure it
+            %wraps, so that the copy shares no state with D.
+            
+            copiedObj = copyElement@amsla.common.DataStructureInterface(obj);
+            copiedObj.DataStructure = copy(obj.DataStructure);
+        end
+        
         function [tags, numOfNodes] = listOfTags(obj, tagName)
             %LISTOFTAGS(D, T) Obtain the list of tags associated with
             %nodes.
             
-            tagsPerNode = obj.NodeTagMap.(tagName).Tag;
+            tagsPerNode = obj.TagStore(:, obj.TagColumn.(tagName));
             
             tags = iRowVector(unique(tagsPerNode));
-            
-            tagsPerNode = reshape(tagsPerNode, [], 1);
             numOfNodes = iRowVector(accumarray(tagsPerNode, 1));
         end
         
@@ -49,27 +65,27 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
             %TAGOFNODE(D, TN, N) Get the tag named TN associated with the
             %node N.
             
-            [nodeIds, ~, invSorter] = unique(nodeIds);
-            tag = obj.NodeTagMap.(tagName).Tag(...
-                ismember(obj.NodeTagMap.(tagName).NodeId, nodeIds));
-            tag = iRowVector(tag(invSorter));
+            tag = iRowVector(obj.TagStore(nodeIds, obj.TagColumn.(tagName)));
         end
         
         function setTagOfNode(obj, tagName, nodeIds, tags)
             %SETTAGOFNODE(D, T, N) Set the tag named TN associated with the
-            %node of ID N.
+            %node of ID N. If a node appears more than once in N, the last
+            %tag is kept.
             
-            if isscalar(tags)
-                tags = tags*ones(size(nodeIds));
-            end
-            [uniqueNodes, sorter] = unique(nodeIds);
-            assert(numel(uniqueNodes)==numel(nodeIds), ...
-                "Ambiguous input.");
+            obj.TagStore(nodeIds, obj.TagColumn.(tagName)) = tags;
+        end
+        
+        function addTag(obj, tagName)
+            %ADDTAG(D, TN) Store a new tag named TN for every node, next to
+            %the existing ones. All the nodes start with a null tag.
+            
+            assert(~isfield(obj.TagColumn, tagName), ...
+                "amsla:DataStructureDecorator:duplicateTag", ...
+                "The tag """ + tagName + """ already exists.");
             
-            uniqueTags = tags(sorter);
-            obj.NodeTagMap.(tagName).Tag(...
-                ismember(obj.NodeTagMap.(tagName).NodeId, uniqueNodes)) = ...
-                iRowVector(uniqueTags)';
+            obj.TagColumn.(tagName) = size(obj.TagStore, 2)+1;
+            obj.TagStore(:, end+1) = amsla.common.nullId(size(obj.TagStore, 1), 1);
         end
     end
     
@@ -79,11 +95,15 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
         function obj = DataStructureDecorator(dataStructure, tagName)
             obj.DataStructure = dataStructure;
             
+            % Tags are indexed directly by node ID
             allNodes = iRowVector(dataStructure.listOfNodes());
-            obj.NodeTagMap = struct();
-            obj.NodeTagMap.(tagName) = struct( ...
-                'NodeId', allNodes, ...
-                'Tag', amsla.common.nullId(size(allNodes)));
+            assert(isequal(allNodes, 1:numel(allNodes)), ...
+                "amsla:DataStructureDecorator:nonDenseNodes", ...
+                "The node IDs should be 1 to N.");
+            
+            obj.TagStore = zeros(numel(allNodes), 0);
+            obj.TagColumn = struct();
+            obj.addTag(tagName);
         end
         
         % General
@@ -92,6 +112,14 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
             h = obj.DataStructure.plot(varargin{:});
         end
         
+        function footprint = memoryFootprint(obj)
+            %MEMORYFOOTPRINT(D) The memory used by the decorated
+            %DataStructure, plus that of the tags of the nodes.
+            
+            footprint = [obj.DataStructure.memoryFootprint(); ...
+                amsla.common.internal.footprintTable("Node tags", {obj.TagStore})];
+        end
+        
         % Graph operations
         
         function outIds = listOfNodes(obj)
@@ -118,6 +146,14 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
             outIds = obj.DataStructure.parentsOfNode(nodeIds);
         end
         
+        function [offsets, outIds] = parentsOfFrontier(obj, nodeIds)
+            [offsets, outIds] = obj.DataStructure.parentsOfFrontier(nodeIds);
+        end
+        
+        function [offsets, outIds] = childrenOfFrontier(obj, nodeIds)
+            [offsets, outIds] = obj.DataStructure.childrenOfFrontier(nodeIds);
+        end
+        
         function outIds = listOfEdges(obj)
             outIds = obj.DataStructure.listOfEdges();
         end
@@ -134,10 +170,14 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
             weight = obj.DataStructure.weightOfEdge(edgeIds);
         end
         
+        function setWeightOfEdge(obj, edgeIds, weights)
+            obj.DataStructure.setWeightOfEdge(edgeIds, weights);
+        end
+        
         % Sub-graph-level operations
         
         function varargout = listOfSubGraphs(obj)
-            [varargout{:}] = obj.DataStructure.listofSubGraphs();
+            [varargout{1:nargout}] = obj.DataStructure.listOfSubGraphs();
         end
         
         function outIds = subGraphOfNode(obj, nodeIds)
@@ -161,6 +201,14 @@ classdef(Abstract) DataStructureDecorator < amsla.common.DataStructureInterface
         function setTimeSlotOfEdge(obj, edgeIds, timeSlotIds)
             obj.DataStructure.setTimeSlotOfEdge(edgeIds, timeSlotIds);
         end
+        
+        function edgeIds = edgesInSubGraphAndTimeSlot(obj, subGraphId, timeSlotId)
+            edgeIds = obj.DataStructure.edgesInSubGraphAndTimeSlot(subGraphId, timeSlotId);
+        end
+        
+        function timeSlotIds = timeSlotsInSubGraph(obj, subGraphId)
+            timeSlotIds = obj.DataStructure.timeSlotsInSubGraph(subGraphId);
+        end
     end
 end
 
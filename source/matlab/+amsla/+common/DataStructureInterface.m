@@ -1,4 +1,4 @@
-classdef(Abstract) DataStructureInterface < handle
+classdef(Abstract) DataStructureInterface < matlab.mixin.Copyable
     %AMSLA.COMMON.DATASTRUCTUREINTERFACE Interface for DataStructure
     %objects.
     %
@@ -6,6 +6,10 @@ classdef(Abstract) DataStructureInterface < handle
     %      listOfNodes           - All the node IDs in the graph.
     %      parentsOfNode         - The parents of a given node.
     %      childrenOfNode        - The children of a given node.
+    %      parentsOfFrontier     - The parents of a set of nodes, as an
+    %                              offsets-indices pair.
+    %      childrenOfFrontier    - The children of a set of nodes, as an
+    %                              offsets-indices pair.
     %   
     %      listOfEdges           - All the edges ID in the graph.
     %      exitingEdgesOfNode    - Get the edges coming out of  a node.          
@@ -13,6 +17,7 @@ classdef(Abstract) DataStructureInterface < handle
     %      enteringNodeOfEdge    - Get the node that enters a 
     %      loopEdgesOfNode       - The looping edges for the given node.
     %      weightOfEdge          - The weight of a given edge.
+    %      setWeightOfEdge       - Change the weight of a given edge.
     %
     %      listOfSubGraphs       - Get the list of sub-graphs.
     %      subGraphOfNode        - Get the sub-graph to which a node belongs.
@@ -21,8 +26,18 @@ classdef(Abstract) DataStructureInterface < handle
     %      listOfTimeSlots       - Get the list of time-slots
     %      timeSlotOfEdge        - Get the time-slot to which an edge belongs.
     %      setTimeSlotOfEdge     - Assign an edge to a time-slot.
+    %      edgesInSubGraphAndTimeSlot - Get the edges of a sub-graph in a
+    %                              time-slot.
+    %      timeSlotsInSubGraph   - Get the time-slots used by a sub-graph.
     %
     %      plot                  - Plot the object.
+    %      memoryFootprint       - The memory used by each component of
+    %                              the object.
+    %      copy                  - A copy of the object that shares no
+    %                              state with the original.
+    %
+    %   Copies share the unchanged arrays of the original, so copying is
+    %   cheap and only the arrays written afterwards are duplicated.
     
     % Copyright 2019-2020 Andrea Picciau
     %
@@ -47,6 +62,8 @@ classdef(Abstract) DataStructureInterface < handle
         
         h = plot(obj, varargin)
         
+        footprint = memoryFootprint(obj)
+        
         % Node-level operations
         
         outIds = listOfNodes(obj)
@@ -55,6 +72,13 @@ classdef(Abstract) DataStructureInterface < handle
                 
         outIds = parentsOfNode(obj, nodeIds)
         
+        % Frontier-level operations. The parents (children) of the K-th
+        % node in nodeIds are outIds(offsets(K):offsets(K+1)-1).
+        
+        [offsets, outIds] = parentsOfFrontier(obj, nodeIds)
+        
+        [offsets, outIds] = childrenOfFrontier(obj, nodeIds)
+        
         % Edge-level operations
         
         outIds = listOfEdges(obj)
@@ -71,6 +95,8 @@ classdef(Abstract) DataStructureInterface < handle
         
         weight = weightOfEdge(obj, edgeId)
         
+        setWeightOfEdge(obj, edgeIds, weights)
+        
         % Sub-graph-level operations
         
         outIds = listOfSubGraphs(obj)
@@ -85,7 +111,11 @@ classdef(Abstract) DataStructureInterface < handle
         
         outIds = timeSlotOfEdge(obj, edgeIds)
         
-        setTimeSlotOfEdge(obj, edgeIds, timeSlotIds)        
+        setTimeSlotOfEdge(obj, edgeIds, timeSlotIds)
+        
+        edgeIds = edgesInSubGraphAndTimeSlot(obj, subGraphId, timeSlotId)
+        
+        timeSlotIds = timeSlotsInSubGraph(obj, subGraphId)
         
     end
     
@@ -0,0 +1,107 @@
+classdef FrozenSolver
+    %AMSLA.COMMON.FROZENSOLVER An immutable triangular solver, to be shared
+    %by workers that solve at the same time.
+    %
+    %   F = FREEZE(M) Export the analysed amsla.SparseMatrix M. See
+    %   amsla.SparseMatrix/freeze.
+    %
+    %   A frozen solver only holds the compiled plan of the solve: the
+    %   steps, the weights and the inverse of the diagonal. It has no
+    %   reference to the data structure, the partitioner or the scheduler
+    %   of the matrix, so it does not change when the matrix is analysed
+    %   again or its values are updated, and it can be used by several
+    %   threads or workers at once. It always solves on the CPU.
+    %
+    %   To solve on the workers of a parallel pool, send the solver once
+    %   with a parallel.pool.Constant, for example with SHARE:
+    %
+    %      C = share(F);
+    %      parfor k = 1:K
+    %          X(:, k) = C.Value.solve(B(:, k));
+    %      end
+    %
+    %   The workers of a thread-based pool share one copy of the solver.
+    %   The workers of a process-based pool receive one copy each, once.
+    %
+    %   FrozenSolver methods:
+    %      solve             - Solve a triangular linear system.
+    %      solveTranspose    - Solve the transposed system.
+    %      multiply          - Multiply the matrix by a vector.
+    %      share             - Wrap the solver in a parallel.pool.Constant.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(GetAccess=private, SetAccess=immutable)
+        
+        % Triangular solver without a plan on the GPU.
+        Solver
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Access=public)
+        
+        function obj = FrozenSolver(aSolver)
+            %FROZENSOLVER Construct a frozen solver. Use the FREEZE method
+            %of amsla.common.TriangularSolver instead.
+            
+            validateattributes(aSolver, {'amsla.common.TriangularSolver'}, {'scalar'});
+            obj.Solver = aSolver;
+        end
+        
+        function result = solve(obj, rhs)
+            %SOLVE Solve a triangular linear system of equations.
+            %
+            %   X = SOLVE(F, B) Solve the system with the right-hand side B.
+            %   B can be a vector, or a matrix with one right-hand side per
+            %   column.
+            
+            result = obj.Solver.solve(gather(rhs));
+        end
+        
+        function result = solveTranspose(obj, rhs)
+            %SOLVETRANSPOSE Solve the transposed triangular linear system.
+            %
+            %   X = SOLVETRANSPOSE(F, B) Solve the system with the transpose
+            %   of the matrix and the right-hand side B.
+            
+            result = obj.Solver.solveTranspose(rhs);
+        end
+        
+        function result = multiply(obj, x)
+            %MULTIPLY Multiply the matrix by a vector.
+            %
+            %   Y = MULTIPLY(F, X) Compute the product of the matrix and X.
+            
+            result = obj.Solver.multiply(x);
+        end
+        
+        function constant = share(obj)
+            %SHARE Wrap the solver in a parallel.pool.Constant.
+            %
+            %   C = SHARE(F) Send F to the workers of the current parallel
+            %   pool once. Use C.Value on the workers to solve.
+            
+            assert(exist("parallel.pool.Constant", "class")==8, ...
+                "amsla:FrozenSolver:parallelUnavailable", ...
+                "Sharing a solver requires Parallel Computing Toolbox.");
+            constant = parallel.pool.Constant(obj);
+        end
+        
+    end
+end
@@ -27,6 +27,14 @@ classdef(Abstract) PartitionerInterface < handle
         %Max number of nodes in a sub-graph
         MaxSubGraphSize
         
+        %True if independent parts of the graph can be partitioned on
+        %parallel workers
+        UseParallel
+        
+        %True if a plot of the partitioning algorithm is to be generated.
+        %Algorithms that update the plot in an inner loop check it first.
+        IsPlottingProgress
+        
     end
     
     properties(Abstract, GetAccess=protected, SetAccess=immutable)
@@ -43,9 +51,6 @@ classdef(Abstract) PartitionerInterface < handle
         %Progress plot manager.
         ProgressPlotter
         
-        %True if a plot of the partitioning algorithm is to be generated
-        IsPlottingProgress
-        
     end
     
     %% PUBLIC METHODS
@@ -57,6 +62,14 @@ classdef(Abstract) PartitionerInterface < handle
         
     end
     
+    methods(Abstract, Static)
+        
+        % True if the partitioner limits the size of the sub-graphs to the
+        % maximum size it is given
+        tf = usesMaxSubGraphSize()
+        
+    end
+    
     %% PROTECTED METHODS
     
     methods(Access=public)
@@ -64,7 +77,7 @@ classdef(Abstract) PartitionerInterface < handle
         function obj = PartitionerInterface(varargin)
             %PARTITIONERINTERFACE Class constructor.
             
-            [obj.MaxSubGraphSize, obj.IsPlottingProgress] = ...
+            [obj.MaxSubGraphSize, obj.IsPlottingProgress, obj.UseParallel] = ...
                 iParseConstructorArguments(varargin{:});
             if obj.IsPlottingProgress
                 obj.ProgressPlotter = amsla.common.internal.GraphPlotter();
@@ -85,13 +98,15 @@ end
 
 %% HELPER FUNCTIONS
 
-function [maxSubGraph, isPlottingProgress] = iParseConstructorArguments(varargin)
+function [maxSubGraph, isPlottingProgress, useParallel] = iParseConstructorArguments(varargin)
 parser = inputParser;
 addOptional(parser,'MaxSubGraph', 10, @isnumeric);
 addParameter(parser,'PlotProgress', false, @islogical);
+addParameter(parser,'UseParallel', false, @(x) islogical(x) && isscalar(x));
 
 parse(parser, varargin{:});
 
 maxSubGraph = parser.Results.MaxSubGraph;
 isPlottingProgress = parser.Results.PlotProgress;
+useParallel = parser.Results.UseParallel;
 end
\ No newline at end of file
@@ -2,11 +2,33 @@ classdef PartitioningResult
     %AMSLA.COMMON.PARTITIONINGRESULT Record the results of the partitioning
     %of a graph with the level-set algorithm.
     %
+    %   R = AMSLA.COMMON.PARTITIONINGRESULT(TF) Record whether the graph
+    %   was correctly partitioned.
+    %
+    %   R = AMSLA.COMMON.PARTITIONINGRESULT(TF, G, T) Also record the
+    %   statistics of the schedule of the DataStructure G, whose sub-graph
+    %   levels are in the table T computed by
+    %   amsla.common.internal.findSubGraphLevels.
+    %
     %   Properties of PARTITIONINGRESULT:
     %       WasPartitioned          - True if the graph was correctly
     %                                 partitioned.
+    %       SubGraphIds             - IDs of the sub-graphs.
+    %       SubGraphSizes           - Number of nodes of each sub-graph.
+    %       SubGraphSizeHistogram   - Number of sub-graphs of each size.
+    %       TimeSlotsPerSubGraph    - Number of time-slots of each
+    %                                 sub-graph.
+    %       NumSubGraphs            - Number of sub-graphs.
+    %       NumLevels               - Number of sub-graph levels.
+    %       ParallelismPerLevel     - Number of sub-graphs in each level.
+    %       AverageParallelism      - Average number of sub-graphs per
+    %                                 level.
+    %       CriticalPathLength      - Number of time-slots executed one
+    %                                 after the other by the solve.
+    %       NumExternalEdges        - Number of edges between nodes in
+    %                                 different sub-graphs.
     
-    % Copyright 2019 Andrea Picciau
+    % Copyright 2019-2020 Andrea Picciau
     %
     % Licensed under the Apache License, Version 2.0 (the "License");
     % you may not use this file except in compliance with the License.
@@ -25,23 +47,125 @@ classdef PartitioningResult
         % True if the graph was correctly partitioned.
         WasPartitioned
         
+        % IDs of the sub-graphs, in ascending order.
+        SubGraphIds = zeros(0, 1)
+        
+        % Number of nodes of each sub-graph in SubGraphIds.
+        SubGraphSizes = zeros(0, 1)
+        
+        % Table with the number of sub-graphs (Count) of each size (Size).
+        SubGraphSizeHistogram = table(zeros(0, 1), zeros(0, 1), ...
+            'VariableNames', {'Size', 'Count'})
+        
+        % Number of time-slots of each sub-graph in SubGraphIds.
+        TimeSlotsPerSubGraph = zeros(0, 1)
+        
+        % Number of edges exiting the nodes of each sub-graph in
+        % SubGraphIds, loops included.
+        EdgesPerSubGraph = zeros(0, 1)
+        
+        % Number of edges exiting the nodes of each sub-graph in
+        % SubGraphIds towards the nodes of other sub-graphs.
+        ExternalEdgesPerSubGraph = zeros(0, 1)
+        
+        % Level of each sub-graph in SubGraphIds, from 1 to NumLevels.
+        LevelOfSubGraph = zeros(0, 1)
+        
+        % Number of sub-graph levels.
+        NumLevels = 0
+        
+        % Number of sub-graphs in each sub-graph level.
+        ParallelismPerLevel = zeros(0, 1)
+        
+        % Number of time-slots on the longest chain of dependent
+        % operations: the sum over the levels of the largest number of
+        % time-slots of a sub-graph in the level.
+        CriticalPathLength = 0
+        
+        % Number of edges whose nodes are in different sub-graphs.
+        NumExternalEdges = 0
+        
+    end
+    
+    properties(Dependent)
+        
+        % Number of sub-graphs.
+        NumSubGraphs
+        
+        % Average number of sub-graphs per level.
+        AverageParallelism
+        
     end
     
     %% PUBLIC METHDOS
     
     methods(Access=public)
         
-        function obj = PartitioningResult(wasPartitioned)
+        function obj = PartitioningResult(wasPartitioned, aDataStructure, subGraphLevelsTable)
             %PARTITIONINGRESULT Construct an object that records the result
             %of the partitioning using one of the implemented algorithms.
             %
             %   PARTITIONINGRESULT(W) Record that the graph was
             %   partitioned:
             %   - successfully/non-succesfully (W).
+            %
+            %   PARTITIONINGRESULT(W, G, T) Also record the statistics of
+            %   the schedule of the DataStructure G, whose sub-graph levels
+            %   are in the table T.
             
             obj.WasPartitioned = wasPartitioned;
+            if nargin<2
+                return;
+            end
+            
+            nodeIds = aDataStructure.listOfNodes();
+            nodeSubGraphs = reshape(aDataStructure.subGraphOfNode(nodeIds), [], 1);
+            [subGraphIds, ~, subGraphOfNode] = unique(nodeSubGraphs);
+            numSubGraphs = numel(subGraphIds);
+            obj.SubGraphIds = subGraphIds;
+            obj.SubGraphSizes = accumarray(subGraphOfNode, 1, [numSubGraphs, 1]);
+            [sizes, ~, sizeOfSubGraph] = unique(obj.SubGraphSizes);
+            obj.SubGraphSizeHistogram = table(sizes, ...
+                accumarray(sizeOfSubGraph, 1, [numel(sizes), 1]), ...
+                'VariableNames', {'Size', 'Count'});
+            
+            % Time-slots of each sub-graph, counted on the edges exiting
+            % its nodes
+            edgeIds = aDataStructure.listOfEdges();
+            rows = reshape(aDataStructure.exitingNodeOfEdge(edgeIds), [], 1);
+            columns = reshape(aDataStructure.enteringNodeOfEdge(edgeIds), [], 1);
+            timeSlots = reshape(aDataStructure.timeSlotOfEdge(edgeIds), [], 1);
+            isScheduled = ~amsla.common.isNullId(timeSlots);
+            subGraphTimeSlots = unique( ...
+                [subGraphOfNode(rows(isScheduled)), timeSlots(isScheduled)], 'rows');
+            obj.TimeSlotsPerSubGraph = accumarray(subGraphTimeSlots(:, 1), 1, [numSubGraphs, 1]);
+            
+            isExternal = nodeSubGraphs(rows)~=nodeSubGraphs(columns);
+            obj.NumExternalEdges = nnz(isExternal);
+            obj.EdgesPerSubGraph = accumarray(subGraphOfNode(rows), 1, [numSubGraphs, 1]);
+            obj.ExternalEdgesPerSubGraph = accumarray(subGraphOfNode(rows(isExternal)), 1, ...
+                [numSubGraphs, 1]);
+            
+            % Levels
+            [~, levelPosition] = ismember(subGraphLevelsTable.SubGraphId, subGraphIds);
+            [~, ~, levelOfSubGraph] = unique(subGraphLevelsTable.SubGraphLevel);
+            numLevels = max([0; levelOfSubGraph]);
+            obj.NumLevels = numLevels;
+            obj.ParallelismPerLevel = accumarray(levelOfSubGraph, 1, [numLevels, 1]);
+            obj.LevelOfSubGraph = zeros(numSubGraphs, 1);
+            obj.LevelOfSubGraph(levelPosition) = levelOfSubGraph;
+            obj.CriticalPathLength = sum(accumarray(levelOfSubGraph, ...
+                obj.TimeSlotsPerSubGraph(levelPosition), [numLevels, 1], @max));
+        end
+        
+        function numSubGraphs = get.NumSubGraphs(obj)
+            numSubGraphs = numel(obj.SubGraphIds);
+        end
+        
+        function averageParallelism = get.AverageParallelism(obj)
+            averageParallelism = obj.NumSubGraphs/max(obj.NumLevels, 1);
         end
         
     end
     
-end
\ No newline at end of file
+end
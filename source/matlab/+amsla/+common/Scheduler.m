@@ -5,9 +5,15 @@ classdef Scheduler < handle
     %   S = AMSLA.COMMON.SCHEDULER(G) Create a scheduler object to operate
     %   on the sparse matrix represented by the graph G.
     %
+    %   S = AMSLA.COMMON.SCHEDULER(G, 'UseParallel', true) Schedule the
+    %   sub-graphs of G concurrently on the workers of a parallel pool, if
+    %   Parallel Computing Toolbox is available.
+    %
     %   Methods of Scheduler:
     %       scheduleOperations - Schedule the numerical operations in the
     %                            sparse matrix.
+    %       scheduleSubGraphs  - Schedule the numerical operations in some
+    %                            of the sub-graphs.
     
     % Copyright 2018-2020 Andrea Picciau
     %
@@ -30,8 +36,8 @@ classdef Scheduler < handle
         %Graph object representing a sparse matrix.
         DataStructure
         
-        %Schedulers for sub-graphs
-        SubGraphSchedulers
+        %True if the sub-graphs are scheduled on parallel workers
+        UseParallel
         
     end
     
@@ -39,14 +45,19 @@ classdef Scheduler < handle
     
     methods(Access=public)
         
-        function obj = Scheduler(aGraph)
+        function obj = Scheduler(aGraph, varargin)
             %SCHEDULER Create a scheduler object.
             
             validateattributes(aGraph, ...
                 {'amsla.common.DataStructureInterface'}, ...
                 {'scalar', 'nonempty'});
             
+            parser = inputParser;
+            addParameter(parser, 'UseParallel', false, @(x) islogical(x) && isscalar(x));
+            parse(parser, varargin{:});
+            
             obj.DataStructure = aGraph;
+            obj.UseParallel = parser.Results.UseParallel;
         end
         
         function scheduleOperations(obj)
@@ -57,15 +68,40 @@ classdef Scheduler < handle
             assert(~isempty(allSubGraphs) && ~any(iIsNullId(allSubGraphs)), ...
                 "Cannot carry out the scheduling on the graph");
             
-            numSubGraphs = numel(allSubGraphs);
-            obj.SubGraphSchedulers = cell(1, numSubGraphs);
+            obj.scheduleSubGraphs(allSubGraphs);
+        end
+        
+        function scheduleSubGraphs(obj, subGraphIds)
+            %SCHEDULESUBGRAPHS(A, SID) Distribute the numerical operations
+            %of the sub-graphs SID over time-slots. The edges of the other
+            %sub-graphs must already be assigned to time-slots.
+            
+            % Sub-graphs are independent: each one is scheduled on its own
+            % copy of the graph when running on parallel workers, and only
+            % the time-slots of the edges of its rows are brought back.
+            dataStructure = obj.DataStructure;
+            subGraphIds = reshape(subGraphIds, 1, []);
+            numSubGraphs = numel(subGraphIds);
+            edgesOfSubGraph = iEdgesOfSubGraphs(dataStructure, subGraphIds);
+            timeSlotsOfSubGraph = cell(numSubGraphs, 1);
+            numWorkers = amsla.common.internal.numParallelWorkers(obj.UseParallel);
+            parfor (k = 1:numSubGraphs, numWorkers)
+                timeSlotsOfSubGraph{k} = iScheduleSubGraph( ...
+                    dataStructure, subGraphIds(k), edgesOfSubGraph{k});
+            end
+            
             for k = 1:numSubGraphs
-                currSubGraph = allSubGraphs(k);
-                obj.SubGraphSchedulers{k} = ...
-                    amsla.common.internal.SubGraphScheduler(obj.DataStructure, currSubGraph);
+                isScheduled = ~iIsNullId(timeSlotsOfSubGraph{k});
+                if any(isScheduled)
+                    dataStructure.setTimeSlotOfEdge(edgesOfSubGraph{k}(isScheduled), ...
+                        timeSlotsOfSubGraph{k}(isScheduled));
+                end
             end
             
-            cellfun(@scheduleOperations, obj.SubGraphSchedulers);
+            if amsla.common.Tracer.isEnabled()
+                amsla.common.Tracer.count("edgesPerTimeSlot", ...
+                    iEdgesPerTimeSlot(timeSlotsOfSubGraph));
+            end
             
             assert(iAllEdgesAreAssigned(obj.DataStructure), ...
                 "amsla:Scheduler:incompleteAssignment", ...
@@ -94,6 +130,43 @@ timeSlots(enteringNodes==exitingNodes & weights==1) = [];
 tf = ~any(amsla.common.isNullId(timeSlots));
 end
 
+function edgesOfSubGraph = iEdgesOfSubGraphs(dataStructure, subGraphIds)
+% Group the edges by the sub-graph of their row.
+allEdges = reshape(dataStructure.listOfEdges(), [], 1);
+rows = dataStructure.exitingNodeOfEdge(allEdges);
+[~, positionOfEdge] = ismember(dataStructure.subGraphOfNode(rows), subGraphIds);
+positionOfEdge = reshape(positionOfEdge, [], 1);
+isInSubGraph = positionOfEdge>0;
+edgesOfSubGraph = accumarray(positionOfEdge(isInSubGraph), allEdges(isInSubGraph), ...
+    [numel(subGraphIds), 1], @(x) {reshape(sort(x), 1, [])});
+end
+
+function timeSlots = iScheduleSubGraph(dataStructure, subGraphId, edgeIds)
+% Schedule a sub-graph and return the time-slots of its edges.
+subGraphScheduler = amsla.common.internal.SubGraphScheduler(dataStructure, subGraphId);
+subGraphScheduler.scheduleOperations();
+timeSlots = zeros(1, 0);
+if ~isempty(edgeIds)
+    timeSlots = dataStructure.timeSlotOfEdge(edgeIds);
+end
+end
+
+function numEdges = iEdgesPerTimeSlot(timeSlotsOfSubGraph)
+% Number of edges in each time-slot of each sub-graph, as a row. External
+% edges are left out.
+numEdges = cell(1, numel(timeSlotsOfSubGraph));
+for k = 1:numel(timeSlotsOfSubGraph)
+    timeSlots = timeSlotsOfSubGraph{k};
+    timeSlots = reshape(timeSlots(timeSlots>0), [], 1);
+    numEdges{k} = zeros(1, 0);
+    if ~isempty(timeSlots)
+        counts = accumarray(timeSlots, 1);
+        numEdges{k} = reshape(counts(counts>0), 1, []);
+    end
+end
+numEdges = [zeros(1, 0), numEdges{:}];
+end
+
 function tf = iIsNullId(anId)
 tf = amsla.common.isNullId(anId);
 end
\ No newline at end of file
@@ -0,0 +1,304 @@
+classdef(Sealed) Tracer < handle
+    %AMSLA.COMMON.TRACER Record the time spent in the phases of the analysis
+    %and of the solve, and the counters of their inner loops.
+    %
+    %   AMSLA.COMMON.TRACER.START() Start recording, and discard the events
+    %   recorded so far.
+    %
+    %   AMSLA.COMMON.TRACER.STOP() Stop recording. The recorded events are
+    %   kept until the next START.
+    %
+    %   T = AMSLA.COMMON.TRACER.EVENTS() Return the recorded events as a
+    %   table with the variables Name, Type ("span" or "counter"), Start,
+    %   the time since START in seconds, Duration, in seconds, and Value,
+    %   the value of the counters.
+    %
+    %   T = AMSLA.COMMON.TRACER.SUMMARY() Return one row per name, with
+    %   the variables Name, Type, Count, Total and Maximum. For spans, Total
+    %   and Maximum are durations in seconds. For counters, they are values.
+    %
+    %   AMSLA.COMMON.TRACER.EXPORT(F) Write the events to the file F in the
+    %   Chrome trace event format, to be opened with chrome://tracing or
+    %   with Perfetto.
+    %
+    %   Recording is off by default. The instrumented code then costs one
+    %   function call per phase, and the inner loops check whether the
+    %   tracer is recording once, before they start. Phases are recorded
+    %   with:
+    %
+    %      t = amsla.common.Tracer.timestamp();
+    %      ...
+    %      amsla.common.Tracer.span("phase", t);
+    %
+    %   and counters with amsla.common.Tracer.count("counter", value).
+    %
+    %   Events are only recorded in the MATLAB client. The work done on the
+    %   workers of a parallel pool is part of the phase that started it.
+    %
+    %   Tracer methods:
+    %      start          - Start recording.
+    %      stop           - Stop recording.
+    %      isEnabled      - True while recording.
+    %      timestamp      - The start time of a span.
+    %      span           - Record a span.
+    %      count          - Record the values of a counter.
+    %      events         - The recorded events.
+    %      summary        - The total of each span and counter.
+    %      export         - Write the events in the Chrome trace format.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties(Access=private)
+        
+        % True while recording.
+        IsEnabled = false
+        
+        % Output of tic when recording started.
+        Origin
+        
+        % Number of recorded events. The arrays of the events have room
+        % for more, and only the first NumEvents elements are valid.
+        NumEvents = 0
+        
+        % Events: name, type, start and duration in seconds, value of the
+        % counters and arguments of the spans.
+        Names = strings(0, 1)
+        Types = strings(0, 1)
+        Starts = zeros(0, 1)
+        Durations = zeros(0, 1)
+        Values = zeros(0, 1)
+        SpanArgs = cell(0, 1)
+        
+    end
+    
+    properties(Constant, Access=private)
+        
+        % Number of events the arrays grow by at least.
+        MinCapacity = 1024
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods(Static)
+        
+        function start()
+            %START Start recording, and discard the recorded events.
+            
+            obj = amsla.common.Tracer.instance();
+            obj.NumEvents = 0;
+            obj.Names = strings(0, 1);
+            obj.Types = strings(0, 1);
+            obj.Starts = zeros(0, 1);
+            obj.Durations = zeros(0, 1);
+            obj.Values = zeros(0, 1);
+            obj.SpanArgs = cell(0, 1);
+            obj.Origin = tic;
+            obj.IsEnabled = true;
+        end
+        
+        function stop()
+            %STOP Stop recording.
+            
+            obj = amsla.common.Tracer.instance();
+            obj.IsEnabled = false;
+        end
+        
+        function tf = isEnabled()
+            %ISENABLED True while recording.
+            
+            obj = amsla.common.Tracer.instance();
+            tf = obj.IsEnabled;
+        end
+        
+        function startTime = timestamp()
+            %TIMESTAMP Get the start time of a span, to pass to SPAN. The
+            %start time is empty when the tracer is not recording.
+            
+            obj = amsla.common.Tracer.instance();
+            if obj.IsEnabled
+                startTime = toc(obj.Origin);
+            else
+                startTime = [];
+            end
+        end
+        
+        function span(name, startTime, spanArgs)
+            %SPAN Record a span.
+            %
+            %   SPAN(N, T) Record the span with name N, from the time T
+            %   returned by TIMESTAMP until now. Nothing is recorded if T is
+            %   empty.
+            %
+            %   SPAN(N, T, A) Also record the fields of the structure A as
+            %   the arguments of the span.
+            
+            if isempty(startTime)
+                return;
+            end
+            if nargin<3
+                spanArgs = struct();
+            end
+            obj = amsla.common.Tracer.instance();
+            if obj.IsEnabled
+                obj.append(name, "span", startTime, toc(obj.Origin)-startTime, NaN, spanArgs);
+            end
+        end
+        
+        function count(name, values)
+            %COUNT Record the values of a counter.
+            %
+            %   COUNT(N, V) Record one sample of the counter with name N for
+            %   each element of V, at the current time.
+            
+            obj = amsla.common.Tracer.instance();
+            if ~obj.IsEnabled
+                return;
+            end
+            currentTime = toc(obj.Origin);
+            for value = reshape(double(values), 1, [])
+                obj.append(name, "counter", currentTime, 0, value, struct());
+            end
+        end
+        
+        function eventTable = events()
+            %EVENTS Get the recorded events as a table.
+            
+            obj = amsla.common.Tracer.instance();
+            k = 1:obj.NumEvents;
+            eventTable = table(obj.Names(k), obj.Types(k), obj.Starts(k), ...
+                obj.Durations(k), obj.Values(k), ...
+                'VariableNames', {'Name', 'Type', 'Start', 'Duration', 'Value'});
+        end
+        
+        function summaryTable = summary()
+            %SUMMARY Get the number of events, the total and the maximum of
+            %each span and counter.
+            
+            eventTable = amsla.common.Tracer.events();
+            measures = eventTable.Duration;
+            isCounter = eventTable.Type=="counter";
+            measures(isCounter) = eventTable.Value(isCounter);
+            
+            [groups, names, types] = findgroups(eventTable.Name, eventTable.Type);
+            summaryTable = table(names, types, ...
+                iApplyPerGroup(@numel, measures, groups), ...
+                iApplyPerGroup(@sum, measures, groups), ...
+                iApplyPerGroup(@max, measures, groups), ...
+                'VariableNames', {'Name', 'Type', 'Count', 'Total', 'Maximum'});
+        end
+        
+        function export(fileName)
+            %EXPORT Write the events to a file in the Chrome trace event
+            %format. Times are in microseconds.
+            
+            obj = amsla.common.Tracer.instance();
+            traceEvents = cell(obj.NumEvents+1, 1);
+            traceEvents{1} = struct("name", "process_name", "ph", "M", ...
+                "pid", 1, "tid", 1, "args", struct("name", "amsla"));
+            for k = 1:obj.NumEvents
+                traceEvents{k+1} = obj.chromeEvent(k);
+            end
+            
+            fileId = fopen(fileName, 'w');
+            assert(fileId>0, ...
+                "amsla:Tracer:cannotWrite", ...
+                "Cannot write the trace to the file ""%s"".", fileName);
+            closeFile = onCleanup(@() fclose(fileId));
+            fprintf(fileId, '%s', jsonencode(struct( ...
+                "traceEvents", {traceEvents}, ...
+                "displayTimeUnit", "ms")));
+            clear closeFile;
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function obj = Tracer()
+            %TRACER Construct the tracer. Use the static methods instead.
+        end
+        
+        function append(obj, name, type, startTime, duration, value, spanArgs)
+            % Add an event, growing the arrays geometrically.
+            
+            k = obj.NumEvents+1;
+            if k>numel(obj.Starts)
+                capacity = max(obj.MinCapacity, 2*numel(obj.Starts));
+                obj.Names(capacity, 1) = "";
+                obj.Types(capacity, 1) = "";
+                obj.Starts(capacity, 1) = 0;
+                obj.Durations(capacity, 1) = 0;
+                obj.Values(capacity, 1) = 0;
+                obj.SpanArgs{capacity, 1} = [];
+            end
+            obj.Names(k) = name;
+            obj.Types(k) = type;
+            obj.Starts(k) = startTime;
+            obj.Durations(k) = duration;
+            obj.Values(k) = value;
+            obj.SpanArgs{k} = spanArgs;
+            obj.NumEvents = k;
+        end
+        
+        function event = chromeEvent(obj, k)
+            % Event K in the Chrome trace event format: a complete event for
+            % a span, a counter event for a counter.
+            
+            microseconds = 1e6;
+            if obj.Types(k)=="span"
+                event = struct("name", obj.Names(k), "ph", "X", ...
+                    "ts", obj.Starts(k)*microseconds, ...
+                    "dur", obj.Durations(k)*microseconds, ...
+                    "pid", 1, "tid", 1, "args", obj.SpanArgs{k});
+            else
+                event = struct("name", obj.Names(k), "ph", "C", ...
+                    "ts", obj.Starts(k)*microseconds, ...
+                    "pid", 1, "tid", 1, "args", struct("value", obj.Values(k)));
+            end
+        end
+        
+    end
+    
+    methods(Static, Access=private)
+        
+        function obj = instance()
+            % The tracer shared by all the instrumented code.
+            
+            persistent theTracer
+            if isempty(theTracer) || ~isvalid(theTracer)
+                theTracer = amsla.common.Tracer();
+            end
+            obj = theTracer;
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function result = iApplyPerGroup(fcn, values, groups)
+% Apply a function to the values of each group, as a column.
+
+if isempty(groups)
+    result = zeros(0, 1);
+else
+    result = reshape(splitapply(fcn, values, groups), [], 1);
+end
+end
@@ -4,6 +4,66 @@ classdef TriangularSolver
     %
     %   S = AMSLA.COMMON.TRIANGULARSOLVER(M) Create triangular solver for the
     %   sparse matrix M.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'Backend', B) Choose the
+    %   backend used to solve linear systems. B can be "auto" (default),
+    %   "native" or "matlab". "auto" uses the native kernel when it has
+    %   been built with amsla.common.internal.buildNativeKernels, and the
+    %   MATLAB implementation otherwise.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'Backend', "gpu") Solve linear
+    %   systems on the GPU. The plan is uploaded to the device once, when
+    %   the solver is created. The CUDA kernel is used if it has been built,
+    %   and the MATLAB implementation on gpuArray data otherwise. The output
+    %   of SOLVE is a gpuArray if the right-hand side is a gpuArray.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'NumThreads', T) Use up to T
+    %   threads to solve the independent sub-graphs of each sub-graph level
+    %   concurrently. The default is maxNumCompThreads. Threads are only
+    %   used by the native backend.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'Execution', E) Choose how the
+    %   native backend orders the sub-graphs on the threads. E can be:
+    %      "levels"       - Execute one sub-graph level at a time, and
+    %                       synchronise the threads at the end of each
+    %                       level (default).
+    %      "dependencies" - Start each sub-graph as soon as the sub-graphs
+    %                       it depends on are done. Threads take the
+    %                       ready sub-graphs from their own queue, or steal
+    %                       them from the others, and never wait for a
+    %                       whole level. This helps matrices whose levels
+    %                       have sub-graphs of very different sizes.
+    %   The other backends always execute one level at a time.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'SubGraphLevels', T) Use the
+    %   table of sub-graph levels T instead of computing it from M.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'Reorder', true) Renumber the
+    %   rows of the plan so that the rows of each sub-graph are contiguous,
+    %   ordered by time-slot. The right-hand sides and the solutions are
+    %   permuted automatically. The default is false.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'DenseBlocks', true) Execute
+    %   the dense triangular blocks at the end of the sub-graphs with dense
+    %   triangular solves and matrix products. See
+    %   amsla.common.internal.findDenseBlocks. The native and CUDA kernels
+    %   do not execute dense blocks, so the MATLAB implementation is used,
+    %   on the CPU or on gpuArray data. The default is false.
+    %
+    %   S = AMSLA.COMMON.TRIANGULARSOLVER(M, 'Precision', P) Choose the
+    %   precision of the solve. P can be:
+    %      "double" - Store the values and solve in double precision
+    %                 (default).
+    %      "single" - Store the values and solve in single precision. The
+    %                 solutions are single.
+    %      "mixed"  - Store the values in single precision, and accumulate
+    %                 in double precision. The solutions are double.
+    %   The native kernels only support "double". Other precisions use the
+    %   MATLAB implementation, on the CPU or on the GPU.
+    %
+    %   While amsla.common.Tracer is recording, the compilation of the plan
+    %   and each solve are recorded as spans. The MATLAB implementation also
+    %   records one span per sub-graph level.
     
     % Copyright 2020 Andrea Picciau
     %
@@ -23,12 +83,28 @@ classdef TriangularSolver
     
     properties(Access=private)
         
-        % Correspondence between sub-graphs and sub-graph levels for the
-        % given matrix.
-        SubGraphLevelsTable
+        % Execution plan of the solve, compiled from the data structure of
+        % the matrix.
+        Plan
+        
+        % Plan arrays passed to the native kernel, empty if the native
+        % kernel is not used.
+        NativePlan
+        
+        % Number of threads used by the native kernel.
+        NumThreads
+        
+        % Whether the native kernel follows the dependencies between the
+        % sub-graphs instead of the levels.
+        FollowDependencies
         
-        % Data structure of the matrix being used to solve the system.
-        DataStructure
+        % Precision of the solve: "double", "single" or "mixed".
+        Precision
+        
+        % Plan resident on the GPU, empty if the GPU is not used. It is a
+        % structure for the CUDA kernel, or a SolvePlan with gpuArray data
+        % for the MATLAB implementation.
+        GpuPlan
         
     end
     
@@ -36,31 +112,175 @@ classdef TriangularSolver
     
     methods(Access=public)
         
-        function obj = TriangularSolver(aDataStructure)
+        function obj = TriangularSolver(aDataStructure, varargin)
             %TRIANGULARSOLVER Construct a triangular solver object.
             
             validateattributes(aDataStructure, ...
-                {'amsla.common.DataStructure'}, ...
+                {'amsla.common.DataStructureInterface'}, ...
                 {'scalar', 'nonempty'});
-            obj.SubGraphLevelsTable =  ...
-                amsla.common.internal.findSubGraphLevels(aDataStructure);
-            obj.DataStructure = aDataStructure;
+            [backend, obj.NumThreads, subGraphLevelsTable, reorder, denseBlocks, obj.Precision, execution] = ...
+                iParseConstructorArguments(varargin{:});
+            obj.FollowDependencies = execution=="dependencies";
+            
+            startTime = amsla.common.Tracer.timestamp();
+            obj.Plan = amsla.common.internal.SolvePlan(aDataStructure, subGraphLevelsTable);
+            if reorder
+                obj.Plan = obj.Plan.reorder();
+            end
+            if denseBlocks
+                obj.Plan = obj.Plan.markDenseBlocks();
+            end
+            if obj.Precision~="double"
+                obj.Plan = obj.Plan.toSinglePrecision();
+            end
+            if iUseNativeKernel(backend, obj.Precision, denseBlocks)
+                obj.NativePlan = obj.Plan.nativePlan();
+            end
+            if iUseGpu(backend)
+                obj.GpuPlan = obj.uploadPlan();
+            end
+            amsla.common.Tracer.span("compilePlan", startTime, ...
+                struct("numLevels", obj.Plan.NumLevels, "backend", backend));
         end
         
         function result = solve(obj, rhs)
             %SOLVE Solve a triangular linear system of equations.
+            %
+            %   X = SOLVE(S, B) Solve the system with the right-hand side B.
+            %   B can be a vector, or a matrix with one right-hand side per
+            %   column.
+            
+            solveStart = amsla.common.Tracer.timestamp();
+            result = obj.Plan.toPlanOrder(obj.checkRightHandSide(rhs));
+            
+            if ~isempty(obj.GpuPlan)
+                backend = "gpu";
+                result = obj.solveOnGpu(result);
+                if ~isa(rhs, 'gpuArray')
+                    result = gather(result);
+                end
+            elseif obj.canUseNativeKernel(rhs)
+                backend = "native";
+                result = amsla.common.internal.forwardSubstitutionMex( ...
+                    obj.NativePlan, result, obj.NumThreads, false, obj.FollowDependencies);
+            else
+                backend = "matlab";
+                numLevels = obj.Plan.NumLevels;
+                isTracing = ~isempty(solveStart);
+                for currentLevel = 1:numLevels
+                    if isTracing
+                        levelStart = amsla.common.Tracer.timestamp();
+                    end
+                    result = obj.Plan.applyLevel(result, currentLevel);
+                    if isTracing
+                        amsla.common.Tracer.span("solveLevel", levelStart, ...
+                            struct("level", currentLevel));
+                    end
+                end
+            end
+            
+            result = reshape(obj.Plan.fromPlanOrder(result), size(rhs));
+            amsla.common.Tracer.span("solve", solveStart, ...
+                struct("backend", backend, "numRightHandSides", size(result, 2)));
+        end
+        
+        function result = solveTranspose(obj, rhs)
+            %SOLVETRANSPOSE Solve the transposed triangular linear system.
+            %
+            %   X = SOLVETRANSPOSE(S, B) Solve the system with the transpose
+            %   of the matrix and the right-hand side B, reusing the same
+            %   sub-graph levels and time-slots in reverse order. B can be a
+            %   vector, or a matrix with one right-hand side per column.
+            %
+            %   The native kernel solves the transposed system on a single
+            %   thread. Transposed systems are always solved on the CPU.
+            
+            solveStart = amsla.common.Tracer.timestamp();
+            result = obj.Plan.toPlanOrder(gather(obj.checkRightHandSide(rhs)));
+            
+            if obj.canUseNativeKernel(rhs)
+                backend = "native";
+                result = amsla.common.internal.forwardSubstitutionMex( ...
+                    obj.NativePlan, result, 1, true);
+            else
+                backend = "matlab";
+                numLevels = obj.Plan.NumLevels;
+                isTracing = ~isempty(solveStart);
+                for currentLevel = numLevels:-1:1
+                    if isTracing
+                        levelStart = amsla.common.Tracer.timestamp();
+                    end
+                    result = obj.Plan.applyLevelTranspose(result, currentLevel);
+                    if isTracing
+                        amsla.common.Tracer.span("solveLevel", levelStart, ...
+                            struct("level", currentLevel));
+                    end
+                end
+            end
             
-            result = rhs;
+            result = reshape(obj.Plan.fromPlanOrder(result), size(rhs));
+            amsla.common.Tracer.span("solveTranspose", solveStart, ...
+                struct("backend", backend, "numRightHandSides", size(result, 2)));
+        end
+        
+        function result = multiply(obj, x)
+            %MULTIPLY Multiply the matrix by a vector.
+            %
+            %   Y = MULTIPLY(S, X) Compute the product of the matrix and X,
+            %   using the same storage as the solve. X can be a vector, or
+            %   a matrix with one vector per column. The native kernel
+            %   computes the rows of independent sub-graphs concurrently.
+            %   Products are always computed on the CPU.
+            
+            result = obj.Plan.toPlanOrder(gather(obj.checkRightHandSide(x)));
+            
+            if obj.canUseNativeKernel(x) && ...
+                    amsla.common.internal.hasNativeKernel("sparseMatrixVectorMex")
+                result = amsla.common.internal.sparseMatrixVectorMex( ...
+                    obj.NativePlan, result, obj.NumThreads);
+            else
+                result = obj.Plan.multiply(result);
+            end
+            
+            result = reshape(obj.Plan.fromPlanOrder(result), size(x));
+        end
+        
+        function obj = updateValues(obj, edgeWeights)
+            %UPDATEVALUES Change the values of the matrix without analysing
+            %it again.
+            %
+            %   S = UPDATEVALUES(S, W) Replace the values of the matrix with
+            %   W. W(E) is the new weight of the edge with ID E.
             
-            numLevels = obj.numberOfLevels();
-            for currentLevel = 1:numLevels
-                subGraphIds = obj.subGraphsInLevel(currentLevel);
-                allResults = arrayfun(@(id) obj.traverseSubGraph(id, result), ...
-                    subGraphIds, ...
-                    'UniformOutput', false);
-                result = iUpdateVectorElements(result, allResults);
+            startTime = amsla.common.Tracer.timestamp();
+            obj.Plan = obj.Plan.updateWeights(edgeWeights);
+            if ~isempty(obj.NativePlan)
+                obj.NativePlan.Weights = obj.Plan.Weights;
+                obj.NativePlan.Diagonal = obj.Plan.Diagonal;
+                obj.NativePlan.InverseDiagonal = obj.Plan.InverseDiagonal;
             end
+            if ~isempty(obj.GpuPlan)
+                obj.GpuPlan = obj.uploadPlan();
+            end
+            amsla.common.Tracer.span("updateValues", startTime);
+        end
+        
+        function frozen = freeze(obj, varargin)
+            %FREEZE Export the solver for concurrent solves.
+            %
+            %   F = FREEZE(S) Return an amsla.common.FrozenSolver with the
+            %   plan of S, solving on the CPU with one thread.
+            %
+            %   F = FREEZE(S, 'NumThreads', T) Solve with up to T threads.
+            
+            parser = inputParser;
+            addParameter(parser, 'NumThreads', 1, ...
+                @(x) isnumeric(x) && isscalar(x) && x>=1 && x==round(x));
+            parse(parser, varargin{:});
             
+            obj.NumThreads = double(parser.Results.NumThreads);
+            obj.GpuPlan = [];
+            frozen = amsla.common.FrozenSolver(obj);
         end
     end
     
@@ -68,123 +288,117 @@ classdef TriangularSolver
     
     methods(Access=private)
         
-        function result = traverseSubGraph(obj, subGraphId, rhs)
-            % Traverse a given sub-graph time-slot by time-slot.
-            
-            % Find the time-slots for the current sub-graph.
-            timeSlotIds = obj.timeSlotsInSubGraph(subGraphId);
-            
-            % Initialise result with the right-hand side.
-            result = rhs;
-            
-            numTimeSlots = numel(timeSlotIds);
-            for k = 1:numTimeSlots
-                currentTimeSlot = timeSlotIds(k);
-                
-                % Get the data of edges
-                [enteringNodes, exitingNodes, weights] = ...
-                    obj.dataOfEdges(subGraphId, currentTimeSlot);
-                uniqueEnteringNodes = unique(enteringNodes);
-                
-                allResults = arrayfun(@(x) nIterateOverEnteringNodes(x, result), ...
-                    uniqueEnteringNodes, ...
-                    'UniformOutput', false);
-                result = iUpdateVectorElements(result, allResults);
+        function result = checkRightHandSide(obj, rhs)
+            % Check the size of a right-hand side and turn it into one full
+            % column per system.
+            
+            if isvector(rhs) && numel(rhs)==obj.Plan.NumRows
+                result = full(reshape(rhs, [], 1));
+            else
+                validateattributes(rhs, {'numeric'}, ...
+                    {'nonempty', '2d', 'nrows', obj.Plan.NumRows});
+                result = full(rhs);
             end
             
-            function result = nIterateOverEnteringNodes(currNode, result)
-                % Iterate over the entering edges of a node (equivalent
-                % to the elements in a given row in the matrix).
-                relevantEdges = find(enteringNodes==currNode);
-                
-                currRow = currNode;
-                relevantColumns = exitingNodes(relevantEdges);
-                nonLoopingColumns = relevantColumns(relevantColumns~=currNode);
-                loopingColumn = relevantColumns(relevantColumns==currNode);
-                
-                % Non-looping and looping edges cannot be mixed in the same
-                % time slot.
-                assert( ...
-                    (numel(loopingColumn)==1 && numel(nonLoopingColumns)==0) || ...
-                    (numel(loopingColumn)==0 && numel(nonLoopingColumns)>0), ...
-                    "Looping and non-looping edges cannot be mixed in the same time slot");
-                
-                relevantWeights = weights(relevantEdges);
-                
-                if isempty(loopingColumn)
-                    result(currRow) = result(currRow)-sum(...
-                        relevantWeights.*result(nonLoopingColumns), ...
-                        'all');
-                else
-                    result(currRow) = result(currRow)/relevantWeights;
-                end
+            % The class of the right-hand side sets the precision in
+            % which the plan is executed.
+            if obj.Precision=="single"
+                result = single(result);
+            elseif obj.Precision=="mixed"
+                result = double(result);
             end
         end
         
-        function [enteringNodes, exitingNodes, weights] = dataOfEdges(obj, subGraphId, timeSlotId)
-            %DATAOFEDGES Retrieve the data of the edges in the given sub-graph
-            %and time-slot.
+        function gpuPlan = uploadPlan(obj)
+            % Copy the plan to the GPU, in the form used by the CUDA kernel
+            % if it has been built and the plan has no dense blocks.
             
-            edgeIds = obj.DataStructure.edgesInSubGraphAndTimeSlot(subGraphId, timeSlotId);
-            weights = obj.DataStructure.weightOfEdge(edgeIds);
-            exitingNodes = obj.DataStructure.enteringNodeOfEdge(edgeIds);
-            enteringNodes = obj.DataStructure.exitingNodeOfEdge(edgeIds);
+            if amsla.common.internal.hasNativeKernel("forwardSubstitutionGpuMex") && ...
+                    obj.Precision=="double" && isempty(obj.Plan.DenseBlocks)
+                gpuPlan = rmfield(obj.Plan.nativePlan(), ...
+                    ["SuccessorPointer", "Successors", "NumPredecessors", "Diagonal"]);
+                for fieldName = string(fieldnames(gpuPlan))'
+                    if ~ismember(fieldName, ["NumRows", "NumLevels", "NumSteps", "LevelPointer"])
+                        gpuPlan.(fieldName) = gpuArray(gpuPlan.(fieldName));
+                    end
+                end
+            else
+                gpuPlan = obj.Plan.onDevice();
+            end
         end
         
-        function subGraphIds = subGraphsInLevel(obj, levelId)
-            %SUBGRAPHSINLEVEL Retrieve the IDs of the sub-graphs in a given
-            %sub-graph level.
+        function result = solveOnGpu(obj, result)
+            % Solve on the GPU, one kernel launch per sub-graph level.
             
-            isLevel = obj.SubGraphLevelsTable.SubGraphLevel==levelId;
-            subGraphIds = obj.SubGraphLevelsTable.SubGraphId(isLevel);
+            result = gpuArray(result);
+            if isstruct(obj.GpuPlan)
+                result = amsla.common.internal.forwardSubstitutionGpuMex(obj.GpuPlan, double(result));
+            else
+                for currentLevel = 1:obj.GpuPlan.NumLevels
+                    result = obj.GpuPlan.applyLevel(result, currentLevel);
+                end
+            end
         end
         
-        function numLevels = numberOfLevels(obj)
-            %NUMBEROFLEVELS Number of sub-graph levels.
+        function tf = canUseNativeKernel(obj, rhs)
+            % The native kernel only handles real double data.
             
-            numLevels = numel(unique(obj.SubGraphLevelsTable.SubGraphLevel));
+            tf = ~isempty(obj.NativePlan) && isa(rhs, 'double') && isreal(rhs);
         end
         
-        function timeSlotIDs = timeSlotsInSubGraph(obj, subGraphId)
-            %TIMESLOTSINSUBGRAPH Time-slots in the given sub-graph.
-            
-            timeSlotIDs = obj.DataStructure.timeSlotsInSubGraph(subGraphId);
-        end
     end
 end
 
 %% HELPER FUNCTIONS
 
-function outData = iUpdateVectorElements(initialValue, currentResults)
-% Updates a vector (initialValue) given multiple results (currentResults).
+function [backend, numThreads, subGraphLevelsTable, reorder, denseBlocks, precision, execution] = iParseConstructorArguments(varargin)
+% Parse the optional inputs to the constructor.
 
-validateattributes(initialValue, {'numeric'}, {'nonempty', 'vector'});
-validateattributes(currentResults, {'cell'}, {'nonempty'});
+parser = inputParser;
+addParameter(parser, 'Backend', "auto", @(x) isStringScalar(x) || ischar(x));
+addParameter(parser, 'NumThreads', [], ...
+    @(x) isempty(x) || (isnumeric(x) && isscalar(x) && x>=1 && x==round(x)));
+addParameter(parser, 'SubGraphLevels', [], @(x) isempty(x) || istable(x));
+addParameter(parser, 'Reorder', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser, 'DenseBlocks', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser, 'Precision', "double", @(x) isStringScalar(x) || ischar(x));
+addParameter(parser, 'Execution', "levels", @(x) isStringScalar(x) || ischar(x));
+parse(parser, varargin{:});
 
-currentResults = cell2mat(reshape(currentResults, 1, []));
-currentResultsSize = size(currentResults);
-initialValueSize = size(initialValue);
+backend = validatestring(parser.Results.Backend, ["auto", "native", "matlab", "gpu"]);
+numThreads = parser.Results.NumThreads;
+if isempty(numThreads)
+    numThreads = maxNumCompThreads();
+end
+numThreads = double(numThreads);
+subGraphLevelsTable = parser.Results.SubGraphLevels;
+reorder = parser.Results.Reorder;
+denseBlocks = parser.Results.DenseBlocks;
+precision = validatestring(parser.Results.Precision, ["double", "single", "mixed"]);
+execution = validatestring(parser.Results.Execution, ["levels", "dependencies"]);
+end
 
-if any(currentResultsSize==1)
-    outData = currentResults;
-else
-    whichChanged = currentResults~=initialValue;
-    [rowIndices, colIndices] = find(whichChanged);
-    elementIndices = sub2ind(size(currentResults), rowIndices, colIndices);
-    
-    outData = initialValue;
-    
-    % Corner case: nothing to change, return initialValue.
-    if isempty(elementIndices)
-        return;
-    end
-    
-    if initialValueSize(2)~=1
-        % initialValue is a row vector: index by column.
-        outData(colIndices) = currentResults(elementIndices);
-    else
-        % initialValue is not a row vector: index by row.
-        outData(rowIndices) = currentResults(elementIndices);
-    end
+function tf = iUseNativeKernel(backend, precision, denseBlocks)
+% Decide whether to use the native kernel.
+
+isAvailable = amsla.common.internal.hasNativeKernel("forwardSubstitutionMex");
+assert(isAvailable || backend~="native", ...
+    "amsla:TriangularSolver:nativeUnavailable", ...
+    "The native kernel is not available. Build it with amsla.common.internal.buildNativeKernels.");
+assert(precision=="double" || backend~="native", ...
+    "amsla:TriangularSolver:nativePrecision", ...
+    "The native kernel only solves in double precision.");
+assert(~denseBlocks || backend~="native", ...
+    "amsla:TriangularSolver:nativeDenseBlocks", ...
+    "The native kernel does not execute dense blocks.");
+tf = isAvailable && backend~="matlab" && precision=="double" && ~denseBlocks;
+end
+
+function tf = iUseGpu(backend)
+% Decide whether to use the GPU.
+
+tf = backend=="gpu";
+assert(~tf || (exist("canUseGPU", "file")==2 && canUseGPU()), ...
+    "amsla:TriangularSolver:gpuUnavailable", ...
+    "There is no GPU that MATLAB can use.");
 end
-end
\ No newline at end of file
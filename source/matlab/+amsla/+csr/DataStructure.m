@@ -0,0 +1,578 @@
+classdef DataStructure < amsla.common.DataStructureInterface
+    %AMSLA.CSR.DATASTRUCTURE Implementation of a graph object that stores
+    %the edges in compressed sparse row (CSR) form, with a transposed
+    %(CSC) index. Nodes can be associated with sub-graphs, and edges can be
+    %associated with time-slots.
+    %
+    %	G = AMSLA.CSR.DATASTRUCTURE(I,J,V) Construct a DataStructure object
+    %   given the row indices (I), column indices (J), and values (V) of the
+    %   edges in the graph.
+    %
+    %   Edge IDs follow the order of the edges sorted by row and then by
+    %   column, as in amsla.common.DataStructure. Queries about the
+    %   adjacency of a node cost O(degree), while queries about the end
+    %   nodes and the weight of an edge cost O(1).
+    %
+    %	G = AMSLA.CSR.DATASTRUCTURE.FROMCOMPRESSEDROWS(P, C, V) Construct
+    %	a DataStructure object from the compressed rows of a matrix. See
+    %	fromCompressedRows.
+    %
+    %   DataStructure edge/node-level methods:
+    %      listOfNodes           - Get the list of the IDs of all the nodes
+    %                              in the graph.
+    %      childrenOfNode        - Get the children of a node.
+    %      parentsOfNode         - Get the parents of a node.
+    %      childrenOfFrontier    - Get the children of a set of nodes.
+    %      parentsOfFrontier     - Get the parents of a set of nodes.
+    %      listOfEdges           - Get the list of the IDs of all the edges
+    %                              in the graph.
+    %      exitingEdgesOfNode    - Get the edges coming out of  a node.
+    %      enteringEdgesOfNode   - Get the edges entering a node.
+    %      exitingNodeOfEdge     - Get the node at the end of an edge.
+    %      enteringNodeOfEdge    - Get the node at the start end of an edge.
+    %      loopEdgesOfNode       - Get the edges entering and exiting the
+    %                              same node.
+    %      weightOfEdge          - Get the weight of an edge.
+    %      setWeightOfEdge       - Change the weight of an edge.
+    %
+    %   DataStructure sub-graph-level methods:
+    %      listOfSubGraphs       - Get the list of sub-graphs.
+    %      subGraphOfNode        - Get the sub-graph to which a node
+    %                              belongs.
+    %      setSubGraphOfNode     - Assign a node to a sub-graph.
+    %
+    %   DataStructure time-slot-level methods:
+    %      listOfTimeSlots              - Get all the time-slot IDs in the
+    %                                     graph.
+    %      edgesInSubGraphAndTimeSlot   - Get the edges in the given
+    %                                     time-slot for the given
+    %                                     sub-graph.
+    %      timeSlotsInSubGraph          - Get a list of all the time-slots
+    %                                     in the graph.
+    %      timeSlotOfEdge               - Get the time-slot ID of one or
+    %                                     more edges.
+    %      setTimeSlotOfEdge            - Get the time-slot ID of one or
+    %                                     more edges.
+    %
+    %   Other DataStructure methods:
+    %      plot                  - Plot a DataStructure.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PROPERTIES
+    
+    properties (Access=private)
+        
+        %Number of nodes in the graph.
+        NumNodes
+        
+        %Position of the first edge of each row in the edge arrays. The
+        %edges of row K are RowPointer(K):RowPointer(K+1)-1.
+        RowPointer
+        
+        %Row index of each edge.
+        RowIndex
+        
+        %Column index of each edge.
+        ColumnIndex
+        
+        %Weight of each edge.
+        Values
+        
+        %Position of the first edge of each column in TransposedEdgeId.
+        ColumnPointer
+        
+        %Edge IDs sorted by column first and then by row.
+        TransposedEdgeId
+        
+        %ID of the edge looping over each node, 0 if there is none.
+        LoopEdgeId
+        
+        %ID of the sub-graph to which each node belongs.
+        SubGraphId
+        
+        %ID of the time-slot to which each edge belongs.
+        TimeSlot
+        
+        %Nodes grouped by sub-graph. Built on demand and cleared every
+        %time the assignment of nodes to sub-graphs changes.
+        SubGraphIndex
+        
+    end
+    
+    %% PUBLIC METHODS
+    
+    methods (Access=public)
+        
+        %% General
+        
+        function obj = DataStructure(I, J, V)
+            %DATASTRUCTURE Construct a DataStructure object.
+            
+            if nargin==0
+                return;
+            end
+            
+            requiredAttributes = {'vector', 'nonsparse', 'finite', 'nonempty', 'numel', numel(I)};
+            validateattributes(I, {'numeric'}, [requiredAttributes, {'positive', 'integer'}]);
+            validateattributes(J, {'numeric'}, [requiredAttributes, {'positive', 'integer'}]);
+            validateattributes(V, {'numeric'}, requiredAttributes);
+            
+            obj.initialiseCompressedStorage(I, J, V);
+        end
+        
+        function h = plot(obj, varargin)
+            %PLOT(G) Produce a plot of the graph.
+            %
+            %   H = PLOT(G) Produces the plot of the graph and returns the
+            %   handle to the plot object.
+            %
+            %   H = PLOT(G, AH) Produces the plot of the graph using the
+            %   given axes handle.
+            
+            baseGraph = digraph(obj.RowIndex, obj.ColumnIndex, obj.Values, obj.NumNodes);
+            basePlotArguments = { ...
+                flipedge(baseGraph), ...
+                'Layout', 'force', ...
+                'NodeCData', obj.getNodeColours(), ...
+                'EdgeColor', [0.859, 0.859, 0.859] };
+            
+            if nargin>1
+                axesHandle = varargin{1};
+                h = plot(axesHandle, basePlotArguments{:});
+            else
+                h = plot(basePlotArguments{:});
+            end
+        end
+        
+        function footprint = memoryFootprint(obj)
+            %MEMORYFOOTPRINT(G) Get the memory used by each component of
+            %the graph.
+            %
+            %   T = MEMORYFOOTPRINT(G) Return a table with the name of each
+            %   component (Component) and the bytes it uses (Bytes). The
+            %   total is sum(T.Bytes).
+            
+            footprint = amsla.common.internal.footprintTable( ...
+                ["Row pointer", "Row index", "Column index", "Values", ...
+                "Column pointer", "Transposed edge IDs", "Loop edge IDs", ...
+                "Sub-graphs", "Time-slots", "Sub-graph index"], ...
+                {obj.RowPointer, obj.RowIndex, obj.ColumnIndex, obj.Values, ...
+                obj.ColumnPointer, obj.TransposedEdgeId, obj.LoopEdgeId, ...
+                obj.SubGraphId, obj.TimeSlot, obj.SubGraphIndex});
+        end
+        
+        %% Graph operations
+        
+        function outIds = listOfNodes(obj)
+            %LISTOFNODES(G) Get the IDs of all the nodes in the graph.
+            outIds = 1:obj.NumNodes;
+        end
+        
+        function outIds = childrenOfNode(obj, nodeIds)
+            %CHILDRENOFNODE(G, NODEID) Get the IDs of the children of
+            %one or more nodes in the graph.
+            outIds = iApplyPerNode(@obj.childrenOfOneNode, nodeIds);
+        end
+        
+        function outIds = parentsOfNode(obj, nodeIds)
+            %PARENTSOFNODE(G, NODEID) Get the IDs of the parents of one or
+            % more nodes in the graph.
+            outIds = iApplyPerNode(@obj.parentsOfOneNode, nodeIds);
+        end
+        
+        function [offsets, outIds] = childrenOfFrontier(obj, nodeIds)
+            %CHILDRENOFFRONTIER(G, NODEID) Get the IDs of the children of
+            %a set of nodes as an offsets-indices pair.
+            
+            nodeIds = reshape(nodeIds, [], 1);
+            positions = amsla.common.internal.expandRanges( ...
+                obj.ColumnPointer(nodeIds), obj.ColumnPointer(nodeIds+1)-1);
+            [offsets, outIds] = obj.frontierOfEdges(nodeIds, ...
+                obj.ColumnPointer(nodeIds+1)-obj.ColumnPointer(nodeIds), ...
+                obj.RowIndex(obj.TransposedEdgeId(positions)));
+        end
+        
+        function [offsets, outIds] = parentsOfFrontier(obj, nodeIds)
+            %PARENTSOFFRONTIER(G, NODEID) Get the IDs of the parents of a
+            %set of nodes as an offsets-indices pair.
+            
+            nodeIds = reshape(nodeIds, [], 1);
+            edgeIds = amsla.common.internal.expandRanges( ...
+                obj.RowPointer(nodeIds), obj.RowPointer(nodeIds+1)-1);
+            [offsets, outIds] = obj.frontierOfEdges(nodeIds, ...
+                obj.RowPointer(nodeIds+1)-obj.RowPointer(nodeIds), ...
+                obj.ColumnIndex(edgeIds));
+        end
+        
+        function outIds = listOfEdges(obj)
+            %LISTOFEDGES(G) Get the IDs of all the edges in the graph.
+            outIds = 1:numel(obj.Values);
+        end
+        
+        function outIds = exitingEdgesOfNode(obj, nodeIds)
+            %EXITINGEDGESOFNODE(G, NODEID) Get the IDs of the edges exiting
+            % one or more nodes in the graph.
+            outIds = iApplyPerEdgeSet(@obj.exitingEdgesOfOneNode, nodeIds);
+        end
+        
+        function outIds = enteringEdgesOfNode(obj, nodeIds)
+            %ENTERINGEDGESOFNODE(G, NODE) Get the IDs of edges entering one or
+            %more nodes in the graph.
+            outIds = iApplyPerEdgeSet(@obj.enteringEdgesOfOneNode, nodeIds);
+        end
+        
+        function outIds = exitingNodeOfEdge(obj, edgeIds)
+            %EXITINNODEOFEDGE(G, EDGE) Get the IDs of nodes at the end node
+            %of one or more edges in the graph.
+            outIds = reshape(obj.RowIndex(edgeIds), size(edgeIds));
+        end
+        
+        function outIds = enteringNodeOfEdge(obj, edgeIds)
+            %ENTERINGNODEOFEDGE(G, EDGE) Get the IDs of nodes at the start
+            %node of one or more edges in the graph.
+            outIds = reshape(obj.ColumnIndex(edgeIds), size(edgeIds));
+        end
+        
+        function outIds = loopEdgesOfNode(obj, nodeIds)
+            %LOOPEDGESOFNODE(G, NODE) Get the IDs of edges looping over one
+            %or more nodes in the graph.
+            
+            outIds = reshape(obj.LoopEdgeId(nodeIds), size(nodeIds));
+            if isscalar(nodeIds)
+                outIds = outIds(outIds>0);
+                outIds = reshape(outIds, 1, []);
+            else
+                assert(all(outIds>0), ...
+                    "amsla:csr:DataStructure:noLoopEdge", ...
+                    "One or more nodes do not have a loop edge.");
+            end
+        end
+        
+        function value = weightOfEdge(obj, edgeIds)
+            %WEIGHTOFEDGE(G, EDGEID) Get the weight of one or more edges.
+            value = reshape(obj.Values(edgeIds), [], 1);
+        end
+        
+        function setWeightOfEdge(obj, edgeIds, weights)
+            %SETWEIGHTOFEDGE(G, EDGEID, W) Change the weight of one or more
+            %edges. The sparsity pattern of the graph does not change.
+            obj.Values(edgeIds) = weights;
+        end
+        
+        %% Sub-graph level operations
+        
+        function varargout = listOfSubGraphs(obj)
+            %LISFOFSUBGRAPHS(G) Get the IDs of sub-graphs in the graph.
+            %
+            %   S = LISFOFSUBGRAPHS(G) Get only the IDs of the
+            %   sub-graphs.
+            %
+            %   [S, NS] = LISFOFSUBGRAPHS(G) Get the IDs and the number of
+            %   nodes in each sub-graph.
+            
+            outIds = [];
+            numelSubGraphs = [];
+            if ~any(amsla.common.isNullId(obj.SubGraphId))
+                [outIds, ~, whichSubGraph] = unique(obj.SubGraphId);
+                outIds = iRow(outIds);
+                numelSubGraphs = iRow(accumarray(whichSubGraph, 1));
+            end
+            varargout{1} = outIds;
+            if nargout==2
+                varargout{2} = numelSubGraphs;
+            end
+        end
+        
+        function outIds = subGraphOfNode(obj, nodeIds)
+            %SUBGRAPHOFNODE(G, ID) Get the sub-graph IDs of one or more nodes.
+            outIds = reshape(obj.SubGraphId(nodeIds), size(nodeIds));
+        end
+        
+        function outIds = setSubGraphOfNode(obj, nodeIds, subGraphIds)
+            %SETSUBGRAPHOFNODE(G, ID) Set the component IDs of one or more nodes.
+            
+            % Managing the scalar case of subGraphIds
+            if isscalar(subGraphIds)
+                subGraphIds = subGraphIds*ones(size(nodeIds));
+            elseif isempty(subGraphIds)
+                subGraphIds = amsla.common.nullId(size(nodeIds));
+            end
+            
+            % Check assumption on subGraphIds
+            validateattributes(subGraphIds, {'numeric'}, {'vector'});
+            iCheckAssignmentAmbiguity(nodeIds, subGraphIds);
+            
+            % As in amsla.common.DataStructure, all the nodes must be in the
+            % graph
+            assert(all(nodeIds>=1 & nodeIds<=obj.NumNodes & nodeIds==round(nodeIds)), ...
+                "amsla:csr:DataStructure:nodeNotInGraph", ...
+                "One or more nodes are not in the graph.");
+            obj.SubGraphId(nodeIds) = subGraphIds;
+            obj.SubGraphIndex = [];
+            
+            outIds = reshape(subGraphIds, size(nodeIds));
+        end
+        
+        %% Time-slot operations
+        
+        function timeSlotIds = listOfTimeSlots(obj)
+            %LISTOFTIMESLOTS Get all the time-slots in the graph
+            
+            timeSlotIds = unique(iRow(obj.TimeSlot));
+        end
+        
+        function edgeIds = edgesInSubGraphAndTimeSlot(obj, subGraphId, timeSlotId)
+            %EDGESINSUBGRAPHANDTIMESLOT(G, GID) Get the time-slot IDs in the current
+            %sub-graph.
+            
+            edgeIds = obj.edgesInSubGraph(subGraphId);
+            edgeIds = edgeIds(ismember(obj.TimeSlot(edgeIds), timeSlotId));
+        end
+        
+        function timeSlotIds = timeSlotsInSubGraph(obj, subGraphId)
+            %TIMESLOTSINSUBGRAPH(G, GID) Get the time-slot IDs in the current
+            %sub-graph.
+            
+            timeSlotIds = obj.TimeSlot(obj.edgesInSubGraph(subGraphId));
+            % Remove null IDs
+            timeSlotIds(amsla.common.isNullId(timeSlotIds)) = [];
+            timeSlotIds = unique(timeSlotIds);
+        end
+        
+        function outIds = timeSlotOfEdge(obj, edgeIds)
+            %TIMESLOTOFEDGE(G, ID) Get the time-slot IDs of one or more edges.
+            outIds = obj.TimeSlot(edgeIds);
+        end
+        
+        function setTimeSlotOfEdge(obj, edgeIds, timeSlotIds)
+            %SETTIMESLOTOFEDGE(G, ID) Assign one or more edges to the given
+            %time-slot IDs.
+            obj.TimeSlot(edgeIds) = timeSlotIds;
+        end
+        
+    end
+    
+    methods (Static)
+        
+        function obj = fromCompressedRows(rowPointer, columnIndex, values)
+            %FROMCOMPRESSEDROWS Construct a DataStructure object from
+            %compressed rows.
+            %
+            %   G = FROMCOMPRESSEDROWS(P, C, V) Construct the graph whose
+            %   edges in row K are P(K):P(K+1)-1, with columns C and
+            %   weights V. The edges of each row must be sorted by column,
+            %   so that the storage is used as it is, without sorting or
+            %   copying the triplets.
+            
+            numNodes = numel(rowPointer)-1;
+            validateattributes(rowPointer, {'numeric'}, {'vector', 'nonsparse', 'positive', ...
+                'integer', 'nondecreasing', 'numel', max(numNodes+1, 2)});
+            numEdges = rowPointer(end)-1;
+            requiredAttributes = {'vector', 'nonsparse', 'finite', 'nonempty', 'numel', numEdges};
+            validateattributes(columnIndex, {'numeric'}, ...
+                [requiredAttributes, {'positive', 'integer', '<=', numNodes}]);
+            validateattributes(values, {'numeric'}, requiredAttributes);
+            
+            rowPointer = reshape(double(rowPointer), [], 1);
+            rowIndex = repelem((1:numNodes)', diff(rowPointer));
+            columnIndex = reshape(double(columnIndex), [], 1);
+            isRowStart = false(numEdges, 1);
+            isRowStart(rowPointer(rowPointer<=numEdges)) = true;
+            assert(rowPointer(1)==1 && all([true; diff(columnIndex)>0] | isRowStart), ...
+                "amsla:csr:DataStructure:unsortedRows", ...
+                "The edges of each row should be sorted by column.");
+            
+            obj = amsla.csr.DataStructure();
+            obj.initialiseFromSortedEdges(rowPointer, rowIndex, columnIndex, ...
+                reshape(double(values), [], 1), numNodes);
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods (Access=private)
+        
+        function initialiseCompressedStorage(obj, I, J, V)
+            % Sort the edges by row and then by column, and build the
+            % compressed row and column indices.
+            
+            I = reshape(double(I), [], 1);
+            J = reshape(double(J), [], 1);
+            V = reshape(double(V), [], 1);
+            
+            numNodes = max([I; J]);
+            
+            [sortedEdges, sorter] = sortrows([I, J]);
+            obj.initialiseFromSortedEdges( ...
+                iPointerFromIndex(sortedEdges(:, 1), numNodes), ...
+                sortedEdges(:, 1), sortedEdges(:, 2), V(sorter), numNodes);
+        end
+        
+        function initialiseFromSortedEdges(obj, rowPointer, rowIndex, columnIndex, values, numNodes)
+            % Store the edges, already sorted by row and then by column,
+            % and build the column index.
+            
+            startTime = amsla.common.Tracer.timestamp();
+            obj.NumNodes = numNodes;
+            obj.RowPointer = rowPointer;
+            obj.RowIndex = rowIndex;
+            obj.ColumnIndex = columnIndex;
+            obj.Values = values;
+            
+            % Transposed index. The sort is stable, so the edges of each
+            % column stay sorted by row.
+            [~, obj.TransposedEdgeId] = sort(obj.ColumnIndex);
+            obj.ColumnPointer = iPointerFromIndex(obj.ColumnIndex, numNodes);
+            
+            % Loop edges
+            isLoop = obj.RowIndex==obj.ColumnIndex;
+            obj.LoopEdgeId = zeros(numNodes, 1);
+            obj.LoopEdgeId(obj.RowIndex(isLoop)) = find(isLoop);
+            
+            % Sub-graphs and time-slots
+            obj.SubGraphId = amsla.common.nullId(numNodes, 1);
+            obj.TimeSlot = amsla.common.nullId(numel(values), 1);
+            obj.SubGraphIndex = [];
+            amsla.common.Tracer.span("buildDataStructure", startTime, ...
+                struct("numEdges", numel(values)));
+        end
+        
+        function outIds = childrenOfOneNode(obj, nodeId)
+            % Rows of the edges in the column of the node.
+            outIds = iRow(obj.RowIndex(obj.exitingEdgesOfOneNode(nodeId)));
+        end
+        
+        function outIds = parentsOfOneNode(obj, nodeId)
+            % Columns of the edges in the row of the node.
+            outIds = iRow(obj.ColumnIndex(obj.enteringEdgesOfOneNode(nodeId)));
+        end
+        
+        function edgeIds = enteringEdgesOfOneNode(obj, nodeId)
+            % Non-loop edges in the row of the node.
+            edgeIds = obj.RowPointer(nodeId):(obj.RowPointer(nodeId+1)-1);
+            edgeIds = reshape(edgeIds(edgeIds~=obj.LoopEdgeId(nodeId)), 1, []);
+        end
+        
+        function edgeIds = exitingEdgesOfOneNode(obj, nodeId)
+            % Non-loop edges in the column of the node.
+            edgeIds = obj.TransposedEdgeId( ...
+                obj.ColumnPointer(nodeId):(obj.ColumnPointer(nodeId+1)-1));
+            edgeIds = reshape(edgeIds(edgeIds~=obj.LoopEdgeId(nodeId)), 1, []);
+        end
+        
+        function [offsets, adjacentIds] = frontierOfEdges(~, nodeIds, numEdges, adjacentIds)
+            % Remove the loop edges from the concatenated edges of a set
+            % of nodes, and compute the offsets of each node.
+            
+            offsets = [1; cumsum(numEdges)+1];
+            isKept = adjacentIds ~= ...
+                nodeIds(amsla.common.internal.segmentIds(offsets));
+            offsets = amsla.common.internal.filterSegments(offsets, isKept);
+            adjacentIds = adjacentIds(isKept);
+        end
+        
+        function edgeIds = edgesInSubGraph(obj, subGraphId)
+            % Edges in the rows of the nodes in the given sub-graph, sorted
+            % by edge ID.
+            
+            nodeIds = obj.nodesInSubGraph(subGraphId);
+            edgeIds = amsla.common.internal.expandRanges( ...
+                obj.RowPointer(nodeIds), obj.RowPointer(nodeIds+1)-1);
+        end
+        
+        function nodeIds = nodesInSubGraph(obj, subGraphId)
+            % Nodes in the given sub-graph, sorted by ID.
+            
+            if isempty(obj.SubGraphIndex)
+                [sortedSubGraphs, sortedNodes] = sort(obj.SubGraphId);
+                isAssigned = ~amsla.common.isNullId(sortedSubGraphs);
+                [subGraphIds, firstNode] = unique(sortedSubGraphs(isAssigned), 'first');
+                obj.SubGraphIndex = struct( ...
+                    'SubGraphIds', subGraphIds, ...
+                    'Pointer', [firstNode; nnz(isAssigned)+1], ...
+                    'Nodes', sortedNodes(isAssigned));
+            end
+            
+            index = obj.SubGraphIndex;
+            position = find(index.SubGraphIds==subGraphId, 1);
+            if isempty(position)
+                nodeIds = zeros(0, 1);
+            else
+                nodeIds = index.Nodes(index.Pointer(position):(index.Pointer(position+1)-1));
+            end
+        end
+        
+        function outColours = getNodeColours(obj)
+            % Get the colours to be used in the graph plot
+            if any(~amsla.common.isNullId(obj.SubGraphId))
+                outColours = obj.SubGraphId;
+            else
+                outColours = zeros(obj.NumNodes, 1);
+            end
+        end
+        
+    end
+    
+end
+
+%% HELPER FUNCTIONS
+
+function pointer = iPointerFromIndex(sortedIndex, numNodes)
+% Compute the compressed pointer array of an index sorted in ascending
+% order.
+numPerNode = accumarray(sortedIndex, 1, [numNodes, 1]);
+pointer = [1; cumsum(numPerNode)+1];
+end
+
+function outIds = iApplyPerNode(perNodeFunction, nodeIds)
+% Query one or more nodes. Scalar inputs return an array, vector inputs a
+% row cell array.
+if isscalar(nodeIds)
+    outIds = perNodeFunction(nodeIds);
+else
+    outIds = arrayfun(perNodeFunction, reshape(nodeIds, 1, []), ...
+        'UniformOutput', false);
+end
+end
+
+function outIds = iApplyPerEdgeSet(perNodeFunction, nodeIds)
+% Query the edges of one or more nodes. Scalar inputs return an array,
+% vector inputs a cell array of the same size as the input.
+if isscalar(nodeIds)
+    outIds = perNodeFunction(nodeIds);
+else
+    outIds = arrayfun(perNodeFunction, nodeIds, 'UniformOutput', false);
+end
+end
+
+function iCheckAssignmentAmbiguity(ids, assignTo)
+% Check that there is no ambiguity between nodes with indices IDS and the
+% sub-graphs to which they're being assigned (assignTo).
+
+ids = reshape(ids, [], 1);
+assignTo = reshape(assignTo, [], 1);
+
+uniqueCouples = unique([ids, assignTo], "rows");
+uniqueIds = unique(ids);
+
+assert(size(uniqueCouples, 1)==size(uniqueIds,1), ...
+    "Ambiguous assignment");
+end
+
+function dataOut = iRow(dataIn)
+dataOut = amsla.common.rowVector(dataIn);
+end
@@ -0,0 +1,44 @@
+classdef Partitioner < amsla.levelSet.Partitioner
+    %AMSLA.CSR.PARTITIONER Construct an object that carries out the
+    %partitioning of a matrix stored in the compressed sparse row format.
+    %
+    %   A = PARTITIONER(G, []) Partition the sparse matrix defined by the
+    %   amsla.csr.DataStructure object G according to the level-set
+    %   algorithm.
+    %
+    %   A = PARTITIONER(__, 'Plot', true) Plot the progress of the
+    %   partitioning algorithm.
+    %
+    %   Methods of Partitioner:
+    %       partition        - Partitions the matrix according to the
+    %                          level-set algorithm.
+    %
+    %   See also AMSLA.LEVELSET.PARTITIONER
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% PUBLIC METHDOS
+    
+    methods(Access=public)
+        
+        function obj = Partitioner(dataStructure, varargin)
+            %PARTITIONER Construct an object that executes the
+            %analysis of a CSR matrix according to the level-set algorithm.
+            
+            obj@amsla.levelSet.Partitioner(dataStructure, varargin{:});
+        end
+        
+    end
+end
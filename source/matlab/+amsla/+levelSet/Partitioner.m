@@ -58,6 +58,17 @@ classdef Partitioner < amsla.common.PartitionerInterface & ...
         
     end
     
+    methods(Static)
+        
+        function tf = usesMaxSubGraphSize()
+            %USESMAXSUBGRAPHSIZE The level-set algorithm ignores the
+            %maximum sub-graph size.
+            
+            tf = false;
+        end
+        
+    end
+    
     %% PROTECTED METHODS
     
     methods(Access=protected)
@@ -92,8 +103,10 @@ classdef Partitioner < amsla.common.PartitionerInterface & ...
             
             assert(all(~iIsNullId(subGraphIds)), ...
                 "Assigning to an invalid sub-graph ID");
-            obj.DataStructure.setSubGraphOfNode(nodeIds, subGraphIds);            
-            obj.updateProgressPlot();
+            obj.DataStructure.setSubGraphOfNode(nodeIds, subGraphIds);
+            if obj.IsPlottingProgress
+                obj.updateProgressPlot();
+            end
         end
         
     end    
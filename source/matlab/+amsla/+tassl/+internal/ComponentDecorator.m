@@ -7,6 +7,13 @@ classdef ComponentDecorator < amsla.common.DataStructureDecorator
     %                             graph.
     %      componentsOfNode     - Get the ID of the component of nodes.
     %      setComponentOfNode   - Associate a node with a component.
+    %      mergeComponents      - Merge components into another one.
+    %      compactComponents    - Renumber the components from 1 to N.
+    %
+    %   Component IDs are the roots of a disjoint-set forest with path
+    %   compression: merging two components only links their roots, and
+    %   the IDs stored in the nodes are only rewritten by
+    %   compactComponents.
     
     % Copyright 2018-2020 Andrea Picciau
     %
@@ -29,6 +36,14 @@ classdef ComponentDecorator < amsla.common.DataStructureDecorator
         
     end
     
+    properties(Access=private)
+        
+        % Parent of each component ID in the disjoint-set forest. A
+        % component is a root if it is its own parent.
+        ParentComponent = zeros(0, 1)
+        
+    end
+    
     %% PUBLIC METHODS
     
     methods(Access=public)
@@ -46,20 +61,88 @@ classdef ComponentDecorator < amsla.common.DataStructureDecorator
             %LISTOFCOMPONENTS(D) Retireve a list of component IDs in the
             %graph.
             
-            [componentId, numOfNodes] = obj.listOfTags(obj.TagName);
+            allComponents = obj.componentOfNode(obj.listOfNodes());
+            allComponents = allComponents(~amsla.common.isNullId(allComponents));
+            [componentId, ~, position] = unique(allComponents);
+            componentId = reshape(componentId, 1, []);
+            numOfNodes = reshape(accumarray(reshape(position, [], 1), 1, ...
+                [numel(componentId), 1]), 1, []);
         end
         
         function componentId = componentOfNode(obj, nodeId)
             %COMPONENTOFNODE(D, NID) Get the component ID of node NID.
             
-            componentId = obj.tagOfNode(obj.TagName, nodeId);
+            componentId = obj.rootComponent(obj.tagOfNode(obj.TagName, nodeId));
         end
         
         function setComponentOfNode(obj, nodeId, componentId)
             %SETCOMPONENTOFNODE(D, NID, CID) Associate node NID with the
             %component CID.
             
+            obj.addComponents(componentId);
             obj.setTagOfNode(obj.TagName, nodeId, componentId);
-        end 
+        end
+        
+        function mergeComponents(obj, componentIds, intoComponentId)
+            %MERGECOMPONENTS(D, CIDS, CID) Merge the components CIDS into
+            %the component CID.
+            
+            assert(isscalar(intoComponentId), ...
+                "New component ID should be a scalar.");
+            
+            obj.addComponents([reshape(componentIds, 1, []), intoComponentId]);
+            roots = obj.rootComponent(componentIds);
+            obj.ParentComponent(roots) = obj.rootComponent(intoComponentId);
+        end
+        
+        function compactComponents(obj)
+            %COMPACTCOMPONENTS(D) Renumber the components from 1 to N, in
+            %ascending order of ID, and store the new IDs in the nodes.
+            
+            allNodes = obj.listOfNodes();
+            allComponents = obj.componentOfNode(allNodes);
+            isAssigned = ~amsla.common.isNullId(allComponents);
+            [~, ~, newComponents] = unique(allComponents(isAssigned));
+            
+            obj.ParentComponent = reshape(1:max([0; newComponents]), [], 1);
+            obj.setTagOfNode(obj.TagName, allNodes(isAssigned), newComponents);
+        end
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function addComponents(obj, componentIds)
+            % Make sure that every component ID is a node of the forest.
+            
+            componentIds = componentIds(~amsla.common.isNullId(componentIds));
+            numComponents = numel(obj.ParentComponent);
+            maxComponent = max([numComponents; componentIds(:)]);
+            if maxComponent>numComponents
+                obj.ParentComponent((numComponents+1):maxComponent, 1) = ...
+                    (numComponents+1):maxComponent;
+            end
+        end
+        
+        function roots = rootComponent(obj, componentIds)
+            % Find the roots of the given components and point every
+            % component on the way directly to its root.
+            
+            roots = componentIds;
+            isValid = ~amsla.common.isNullId(componentIds);
+            current = reshape(componentIds(isValid), [], 1);
+            visited = current;
+            next = obj.ParentComponent(current);
+            while any(next~=current)
+                current = next;
+                visited = [visited, current]; %#ok<AGROW>
+                next = obj.ParentComponent(current);
+            end
+            
+            obj.ParentComponent(visited) = repmat(current, 1, size(visited, 2));
+            roots(isValid) = current;
+        end
+        
     end
-end
\ No newline at end of file
+end
@@ -34,7 +34,7 @@ classdef ComponentPartitioner < amsla.common.BreadthFirstSearch
             
             obj = obj@amsla.common.BreadthFirstSearch(dataStructure);
             obj.executeAlgorithm();
-            obj.minimiseComponentRange();
+            obj.DataStructure.compactComponents();
         end
         
         function mergeComponents(obj, minSize)
@@ -45,11 +45,11 @@ classdef ComponentPartitioner < amsla.common.BreadthFirstSearch
             
             [oldComponentIds, newComponentIds] = ...
                 iMergeSmallComponents(componentIds, componentSizes, minSize);
-            for k = 1:numel(oldComponentIds)
-                obj.changeComponentId(oldComponentIds(k), newComponentIds(k));
+            for k = find(oldComponentIds~=newComponentIds)
+                obj.DataStructure.mergeComponents(oldComponentIds(k), newComponentIds(k));
             end
             
-            obj.minimiseComponentRange();
+            obj.DataStructure.compactComponents();
         end
         
     end
@@ -71,11 +71,8 @@ classdef ComponentPartitioner < amsla.common.BreadthFirstSearch
             %assigned to a component.
             
             % Find children of current nodes
-            nodeIds = obj.selectChildrenIfReady(currentNodeIds, @isNodeReady);
-            
-            function tf = isNodeReady(parentNodes)
-                tf = ~any(iIsNullId(obj.DataStructure.componentOfNode(parentNodes)));
-            end
+            nodeIds = obj.selectChildrenIfAllParentsAssigned(currentNodeIds, ...
+                @componentOfNode);
         end
         
         function componentIds = computeTags(obj, currentNodeIds)
@@ -92,7 +89,7 @@ classdef ComponentPartitioner < amsla.common.BreadthFirstSearch
                 nextComponentId = min(compId);
                 if numel(compId)>1
                     otherComponentIds = compId(compId~=nextComponentId);
-                    obj.changeComponentId(otherComponentIds, nextComponentId);
+                    obj.DataStructure.mergeComponents(otherComponentIds, nextComponentId);
                 end
             end
         end
@@ -109,32 +106,6 @@ classdef ComponentPartitioner < amsla.common.BreadthFirstSearch
     
     methods(Access=private)
         
-        function minimiseComponentRange(obj)
-            %Make sure the components are numbered from 1 to N.
-            
-            allComponents = unique(obj.DataStructure.listOfComponents());
-            numComp = numel(allComponents);
-            newIds = 1:numComp;
-            for k = 1:numComp
-                obj.changeComponentId(allComponents(k), newIds(k));
-            end
-        end
-        
-        function changeComponentId(obj, oldComponentIds, newComponentId)
-            %CHANGECOMPONENTID(P, OLDID, NEWID) Replace component IDs with
-            %another one.
-            
-            assert(isscalar(newComponentId), ...
-                "New component ID should be a scalar.");
-            
-            listOfNodes = obj.DataStructure.listOfNodes();
-            listOfComponents = obj.DataStructure.componentOfNode(listOfNodes);
-            selOldComponent = ismember(listOfComponents, oldComponentIds);
-            
-            obj.DataStructure.setComponentOfNode( ...
-                listOfNodes(selOldComponent), newComponentId);
-        end
-        
         function nodeIds = rootNodes(obj)
             %ROOTNODES(P) Root nodes in the whole graph.
             
@@ -196,9 +167,9 @@ for k = 1:numSmallComponents
     
     for j = (k+1):numSmallComponents
         % Check if the component can be merged
-        if  iIsNullId(newSmallComponentIds(j)) && currNewComponentSize+smallComponentSize(j) <= maxSize
+        if  iIsNullId(newSmallComponentIds(j)) && currNewComponentSize+smallComponentsSizes(j) <= maxSize
             newSmallComponentIds(j) = currNewSmallComponentId;
-            currNewComponentSize = currNewComponentSize + smallComponentSize(j);
+            currNewComponentSize = currNewComponentSize + smallComponentsSizes(j);
         end
     end
 end
@@ -5,6 +5,10 @@ classdef Partitioner < amsla.common.PartitionerInterface
     %   P = AMSLA.TASSL.PARTITIONER(G, MAXSIZE) Create a partitioner for the
     %   graph G and request that the maximum size of sub-graphs is MAXSIZE.
     %
+    %   P = AMSLA.TASSL.PARTITIONER(G, MAXSIZE, 'UseParallel', true)
+    %   Partition the components of G concurrently on the workers of a
+    %   parallel pool, if Parallel Computing Toolbox is available.
+    %
     %   Methods of Partitioner:
     %       partition        - Partitions the matrix according to the TASSL
     %                          algorithm.
@@ -58,23 +62,41 @@ classdef Partitioner < amsla.common.PartitionerInterface
             maxSubGraphSize = obj.MaxSubGraphSize;
             
             % Partition into components
+            startTime = amsla.common.Tracer.timestamp();
             compPartitioner = amsla.tassl.internal.ComponentPartitioner(graph);
+            amsla.common.Tracer.span("componentDiscovery", startTime);
             obj.updateProgressPlot();
             
+            startTime = amsla.common.Tracer.timestamp();
             compPartitioner.mergeComponents(maxSubGraphSize);
+            amsla.common.Tracer.span("mergeComponents", startTime);
             obj.updateProgressPlot();
             
-            % Partition into sub-graphs
-            subGraphPartitioners = iGraphPartitioners(graph, maxSubGraphSize);
-            cellfun(@partitionComponent, subGraphPartitioners);
+            % Partition into sub-graphs. Components are independent: each
+            % one is partitioned on its own copy of the graph when running
+            % on parallel workers, and only the sub-graphs of its nodes are
+            % brought back. Only the components partitioned in the client
+            % have their own span.
+            startTime = amsla.common.Tracer.timestamp();
+            [componentIds, nodesOfComponent] = iNodesOfComponents(graph);
+            numComponents = numel(componentIds);
+            subGraphsOfComponent = cell(numComponents, 1);
+            numSubGraphs = zeros(numComponents, 1);
+            numWorkers = amsla.common.internal.numParallelWorkers(obj.UseParallel);
+            parfor (k = 1:numComponents, numWorkers)
+                [subGraphsOfComponent{k}, numSubGraphs(k)] = iPartitionComponent( ...
+                    graph, maxSubGraphSize, componentIds(k), nodesOfComponent{k});
+            end
+            amsla.common.Tracer.span("partitionComponents", startTime, ...
+                struct("numComponents", numComponents, "numWorkers", numWorkers));
             obj.updateProgressPlot();
             
             % Re-number sub-graphs
-            numSubGraphs = cellfun(@numberOfSubGraphs, subGraphPartitioners, ...
-                'UniformOutput', true);
             startingSubGraphs = iStartingSubGraphs(numSubGraphs);
-            for k = 1:numel(subGraphPartitioners)
-                subGraphPartitioners{k}.renumberSubGraphsStartingFrom(startingSubGraphs(k));
+            for k = 1:numComponents
+                currentSubGraphs = subGraphsOfComponent{k};
+                graph.setSubGraphOfNode(nodesOfComponent{k}, ...
+                    currentSubGraphs-min(currentSubGraphs)+startingSubGraphs(k));
             end
             obj.updateProgressPlot();
             
@@ -83,6 +105,17 @@ classdef Partitioner < amsla.common.PartitionerInterface
         
     end
     
+    methods(Static)
+        
+        function tf = usesMaxSubGraphSize()
+            %USESMAXSUBGRAPHSIZE The TASSL algorithm limits the size of the
+            %sub-graphs.
+            
+            tf = true;
+        end
+        
+    end
+    
 end
 
 %% HELPER FUNCTIONS
@@ -95,15 +128,24 @@ for k = 2:numel(numSubGraphs)
 end
 end
 
-function subGraphPartitioners = iGraphPartitioners(graph, maxSubGraphSize)
-% Initialise sub-graphs
-allComponents = graph.listOfComponents();
-numComponents = numel(allComponents);
-subGraphPartitioners = cell(numComponents, 1);
-for k = 1:numComponents
-    currComponent = allComponents(k);
-    subGraphPartitioners{k} = ...
-        amsla.tassl.internal.SubGraphPartitioner( ...
-        graph, maxSubGraphSize, currComponent);
+function [componentIds, nodesOfComponent] = iNodesOfComponents(graph)
+% Group the nodes of the graph by component.
+componentIds = reshape(graph.listOfComponents(), [], 1);
+allNodes = reshape(graph.listOfNodes(), [], 1);
+[~, positionOfNode] = ismember(graph.componentOfNode(allNodes), componentIds);
+nodesOfComponent = accumarray(reshape(positionOfNode, [], 1), allNodes, ...
+    [numel(componentIds), 1], @(x) {reshape(sort(x), 1, [])});
+end
+
+function [subGraphIds, numSubGraphs] = iPartitionComponent(graph, maxSubGraphSize, componentId, nodeIds)
+% Partition a component and return the sub-graphs of its nodes.
+startTime = amsla.common.Tracer.timestamp();
+subGraphPartitioner = amsla.tassl.internal.SubGraphPartitioner( ...
+    graph, maxSubGraphSize, componentId);
+subGraphPartitioner.partitionComponent();
+subGraphIds = graph.subGraphOfNode(nodeIds);
+numSubGraphs = subGraphPartitioner.numberOfSubGraphs();
+amsla.common.Tracer.span("partitionComponent", startTime, ...
+    struct("componentId", componentId, "numNodes", numel(nodeIds), ...
+    "numSubGraphs", numSubGraphs));
 end
-end
\ No newline at end of file
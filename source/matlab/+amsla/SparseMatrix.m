@@ -6,6 +6,22 @@ classdef SparseMatrix
     %
     %   M = AMSLA.SPARSEMATRIX(A, FORMAT) Create a sparse matrix in the
     %   format FORMAT from MATLAB's sparse matrix A.
+    %
+    %   M = AMSLA.SPARSEMATRIX(__, 'Compact', true) Store the data
+    %   structure in its compact layout, if the format has one. The layout
+    %   is kept when the values, the sparsity pattern or the format of the
+    %   matrix change. See amsla.common.DataStructure.
+    %
+    %   M = AMSLA.SPARSEMATRIX.FROMFILE(F, FORMAT) Create a sparse matrix in
+    %   the format FORMAT from the lower triangle of the matrix in the file
+    %   F. See fromFile.
+    %
+    %   F = FREEZE(M) Export the analysed matrix M as an immutable solver
+    %   that parallel workers can share. See freeze.
+    %
+    %   M = UPDATEPATTERN(M, I, J, V, IR, JR) Add and remove elements of the
+    %   analysed matrix M, and analyse again only the part of M that
+    %   changed. See updatePattern.
     
     % Copyright 2019-2020 Andrea Picciau
     %
@@ -35,6 +51,10 @@ classdef SparseMatrix
         %Data structure associated with the storage format.
         DataStructure
         
+        %Whether the data structure uses its compact layout, in the
+        %formats that have one.
+        IsCompact = false
+        
         %Partitioner used to analyse the matrix.
         Partitioner
         
@@ -44,6 +64,17 @@ classdef SparseMatrix
         %Solver used for linear systems
         Solver
         
+        %Edge ID of each of the elements passed to the constructor, in the
+        %order in which they were passed.
+        EdgeOfInput
+        
+        %Settings and result of the last analysis, used to analyse the
+        %matrix again when its sparsity pattern changes: the maximum
+        %sub-graph size (MaxSize), the use of parallel workers
+        %(UseParallel), the options of the solver (SolverOptions) and the
+        %table of sub-graph levels (SubGraphLevels).
+        Analysis
+        
     end
     
     %% PUBLIC METHODS
@@ -53,25 +84,139 @@ classdef SparseMatrix
         function obj = SparseMatrix(varargin)
             %SPARSEMATRIX Construct an instance of this class
             
-            [I, J, V, obj.Format] = ...
+            if nargin==0
+                return;
+            end
+            
+            [I, J, V, obj.Format, obj.IsCompact] = ...
                 iParseConstructorArguments(varargin{:});
-            objConstructor = iGetPackageObject("DataStructure", obj.Format);
-            obj.DataStructure = objConstructor(I, J, V);
+            obj.DataStructure = iNewDataStructure(obj.Format, obj.IsCompact, I, J, V);
+            obj.EdgeOfInput = iEdgeOfInput(I, J);
         end
         
         function [obj, partitioningResults] = analyse(obj, varargin)
             %ANALYSE Analyse the input matrix.
+            %
+            %   M = ANALYSE(M, S) Analyse the matrix with sub-graphs of
+            %   maximum size S.
+            %
+            %   M = ANALYSE(M, "Auto") Choose the format and the maximum
+            %   sub-graph size that give the fastest solve on this machine,
+            %   then analyse the matrix with them. The choice is stored and
+            %   reused for matrices with a similar structure. See
+            %   amsla.common.internal.AutoTuner.
+            %
+            %   [M, R] = ANALYSE(__) Also return the statistics of the
+            %   schedule as an amsla.common.PartitioningResult.
+            %
+            %   M = ANALYSE(__, 'NumThreads', T) Solve linear systems with
+            %   up to T threads.
+            %
+            %   M = ANALYSE(__, 'Execution', "dependencies") Start each
+            %   sub-graph of a native solve as soon as the sub-graphs it
+            %   depends on are done, instead of one level at a time. See
+            %   amsla.common.TriangularSolver.
+            %
+            %   M = ANALYSE(__, 'UseParallel', true) Partition and schedule
+            %   independent parts of the matrix on the workers of a parallel
+            %   pool, if Parallel Computing Toolbox is available.
+            %
+            %   M = ANALYSE(__, 'Reorder', true) Renumber the rows and
+            %   columns after the analysis, so that the rows of each
+            %   sub-graph are contiguous and ordered by time-slot. Right-hand
+            %   sides and solutions keep the original numbering.
+            %
+            %   M = ANALYSE(__, 'DenseBlocks', true) Solve the dense
+            %   triangular blocks at the end of the sub-graphs with dense
+            %   kernels. See amsla.common.TriangularSolver.
+            %
+            %   M = ANALYSE(__, 'Precision', P) Solve in "double" (default),
+            %   "single" or "mixed" precision. See
+            %   amsla.common.TriangularSolver.
+            %
+            %   M = ANALYSE(__, 'CacheFolder', F) Store the result of the
+            %   analysis in the folder F. If the folder already contains the
+            %   analysis of a matrix with the same sparsity pattern, format
+            %   and maximum sub-graph size, load it instead of analysing the
+            %   matrix again.
+            %
+            %   The phases of the analysis are recorded by amsla.common.Tracer
+            %   while it is recording.
+            
+            analysisStart = amsla.common.Tracer.timestamp();
+            [maxSize, plotProgress, solverOptions, cacheFolder, useParallel] = ...
+                iParseAnalyseArguments(varargin{:});
+            
+            % The auto-tuner returns the matrix it analysed with the chosen
+            % configuration, unless the configuration was stored
+            tunedMatrix = [];
+            if isStringScalar(maxSize) || ischar(maxSize)
+                [format, maxSize, tunedMatrix] = obj.tuneFormatAndSize();
+                if isempty(tunedMatrix)
+                    obj = obj.changeFormat(format);
+                else
+                    obj.Format = tunedMatrix.Format;
+                    obj.DataStructure = tunedMatrix.DataStructure;
+                    obj.Partitioner = tunedMatrix.Partitioner;
+                    obj.Scheduler = tunedMatrix.Scheduler;
+                end
+            end
             
-            [maxSize, plotProgress] = iParseAnalyseArguments(varargin{:});
+            isCached = false;
+            if ~isempty(cacheFolder)
+                cache = amsla.common.internal.AnalysisCache(cacheFolder);
+                cacheKey = cache.keyOf(obj.DataStructure, obj.Format, maxSize);
+                [isCached, cacheEntry] = cache.load(cacheKey);
+            end
             
-            obj = obj.setupAnalysisAccordingToFormat(maxSize, plotProgress);
-            partitioningResults = obj.Partitioner.partition();
-            obj.Scheduler.scheduleOperations();
-            obj.Solver = amsla.common.TriangularSolver(obj.DataStructure);
+            if isCached
+                subGraphLevelsTable = amsla.common.internal.AnalysisCache.restore( ...
+                    cacheEntry, obj.DataStructure);
+                wasPartitioned = true;
+            elseif ~isempty(tunedMatrix)
+                subGraphLevelsTable = tunedMatrix.Analysis.SubGraphLevels;
+                wasPartitioned = true;
+                if ~isempty(cacheFolder)
+                    cache.save(cacheKey, obj.DataStructure, subGraphLevelsTable);
+                end
+            else
+                obj = obj.setupAnalysisAccordingToFormat(maxSize, plotProgress, useParallel);
+                startTime = amsla.common.Tracer.timestamp();
+                partitionerResults = obj.Partitioner.partition();
+                wasPartitioned = partitionerResults.WasPartitioned;
+                amsla.common.Tracer.span("partition", startTime, struct("format", obj.Format));
+                
+                startTime = amsla.common.Tracer.timestamp();
+                obj.Scheduler.scheduleOperations();
+                amsla.common.Tracer.span("schedule", startTime);
+                
+                startTime = amsla.common.Tracer.timestamp();
+                subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(obj.DataStructure);
+                amsla.common.Tracer.span("findSubGraphLevels", startTime, ...
+                    struct("numSubGraphs", height(subGraphLevelsTable)));
+                if ~isempty(cacheFolder)
+                    cache.save(cacheKey, obj.DataStructure, subGraphLevelsTable);
+                end
+            end
+            
+            partitioningResults = amsla.common.PartitioningResult(wasPartitioned, ...
+                obj.DataStructure, subGraphLevelsTable);
+            obj.Solver = amsla.common.TriangularSolver(obj.DataStructure, ...
+                "SubGraphLevels", subGraphLevelsTable, solverOptions{:});
+            obj.Analysis = struct( ...
+                "MaxSize", maxSize, ...
+                "UseParallel", useParallel, ...
+                "SolverOptions", {solverOptions}, ...
+                "SubGraphLevels", subGraphLevelsTable);
+            amsla.common.Tracer.span("analyse", analysisStart, ...
+                struct("isCached", isCached));
         end
         
         function result = solve(obj, rhs)
             %SOLVE solve a linear system with the sparse matrix.
+            %
+            %   X = SOLVE(M, B) Solve the system with the right-hand side B.
+            %   B can be n-by-k to solve for k right-hand sides at once.
             
             assert(~isempty(obj.Solver), ...
                 "amsla:AnalysisRequired", ...
@@ -79,13 +224,359 @@ classdef SparseMatrix
             result = obj.Solver.solve(rhs);
         end
         
+        function result = solveTranspose(obj, rhs)
+            %SOLVETRANSPOSE solve a linear system with the transpose of the
+            %sparse matrix.
+            %
+            %   X = SOLVETRANSPOSE(M, B) Solve the system M'*X = B, reusing
+            %   the analysis of M. To solve with an upper-triangular matrix
+            %   U, create M from U.' and call SOLVETRANSPOSE.
+            
+            assert(~isempty(obj.Solver), ...
+                "amsla:AnalysisRequired", ...
+                "Cannot solve a linear system without analysis");
+            result = obj.Solver.solveTranspose(rhs);
+        end
+        
+        function result = spmv(obj, x)
+            %SPMV multiply the sparse matrix by a vector.
+            %
+            %   Y = SPMV(M, X) Compute the product of M and X. X can be
+            %   n-by-k to multiply k vectors at once. The product uses the
+            %   storage of the analysed matrix: the rows of each sub-graph
+            %   are a block, and the blocks are computed in parallel by the
+            %   native kernel.
+            
+            assert(~isempty(obj.Solver), ...
+                "amsla:AnalysisRequired", ...
+                "Cannot multiply the matrix without analysis");
+            result = obj.Solver.multiply(x);
+        end
+        
+        function result = mtimes(obj, x)
+            %MTIMES multiply the sparse matrix by a vector.
+            %
+            %   Y = M*X is the same as SPMV(M, X).
+            
+            assert(isa(obj, "amsla.SparseMatrix") && ~isa(x, "amsla.SparseMatrix"), ...
+                "amsla:SparseMatrix:unsupportedProduct", ...
+                "Only the product of a sparse matrix and a vector is supported");
+            result = obj.spmv(x);
+        end
+        
+        function frozen = freeze(obj, varargin)
+            %FREEZE Export the analysed matrix for concurrent solves.
+            %
+            %   F = FREEZE(M) Return an amsla.common.FrozenSolver with the
+            %   compiled schedule and values of M. F is immutable and does
+            %   not refer to the graph of M, so it can be sent to parallel
+            %   workers cheaply and used while M is analysed again.
+            %
+            %   F = FREEZE(M, 'NumThreads', T) Let each solve of F use up
+            %   to T threads. The default is 1, for one solve per worker.
+            
+            assert(~isempty(obj.Solver), ...
+                "amsla:AnalysisRequired", ...
+                "Cannot freeze a matrix without analysis");
+            frozen = obj.Solver.freeze(varargin{:});
+        end
+        
+        function footprint = memoryFootprint(obj)
+            %MEMORYFOOTPRINT Get the memory used by the storage of the
+            %matrix.
+            %
+            %   T = MEMORYFOOTPRINT(M) Return a table with the name of each
+            %   component of the data structure of M (Component) and the
+            %   bytes it uses (Bytes).
+            
+            footprint = obj.DataStructure.memoryFootprint();
+        end
+        
+        function obj = updateValues(obj, varargin)
+            %UPDATEVALUES Change the values of the matrix, keeping its
+            %sparsity pattern and the result of the analysis.
+            %
+            %   M = UPDATEVALUES(M, V) Replace the values of the matrix with
+            %   V. V must have one element for each element passed to the
+            %   constructor, in the same order.
+            %
+            %   M = UPDATEVALUES(M, A) Replace the values of the matrix with
+            %   those of MATLAB's sparse matrix A. The non-zeros of A must be
+            %   in the sparsity pattern of M.
+            %
+            %   M = UPDATEVALUES(M, I, J, V) Replace the values of the
+            %   elements in rows I and columns J with V. All the other
+            %   elements keep their values.
+            %
+            %   The values of the unit diagonal elements that were not
+            %   scheduled by the analysis cannot be changed.
+            
+            [edgeIds, values] = obj.edgesToUpdate(varargin{:});
+            
+            % The solver can reject the new values, so it is updated first.
+            % The data structure is a handle shared with the copies of the
+            % matrix: the new values go into a copy of it, which shares all
+            % the other arrays with the original.
+            if ~isempty(obj.Solver)
+                allEdges = obj.DataStructure.listOfEdges();
+                allWeights = obj.DataStructure.weightOfEdge(allEdges);
+                [~, positionOfEdge] = ismember(edgeIds, allEdges);
+                allWeights(positionOfEdge) = values;
+                obj.Solver = obj.Solver.updateValues(allWeights);
+            end
+            obj.DataStructure = copy(obj.DataStructure);
+            obj.DataStructure.setWeightOfEdge(edgeIds, values);
+        end
+        
+        function [obj, partitioningResults] = updatePattern(obj, addedRows, addedColumns, addedValues, removedRows, removedColumns)
+            %UPDATEPATTERN Add and remove elements of the matrix, and
+            %analyse again only the part of the matrix that changed.
+            %
+            %   M = UPDATEPATTERN(M, I, J, V) Add the elements in rows I and
+            %   columns J, with values V, to the analysed matrix M.
+            %
+            %   M = UPDATEPATTERN(M, I, J, V, IR, JR) Also remove the
+            %   elements in rows IR and columns JR. Any of the inputs can be
+            %   empty.
+            %
+            %   [M, R] = UPDATEPATTERN(__) Also return the statistics of the
+            %   schedule as an amsla.common.PartitioningResult.
+            %
+            %   The sub-graphs of the changed elements, and the sub-graphs
+            %   between them, are partitioned again on their own, with the
+            %   partitioner of the format and the settings of the last
+            %   analysis. See amsla.common.internal.findAffectedSubGraphs.
+            %   The other sub-graphs and the time-slots of their edges stay
+            %   as they are, and the table of sub-graph levels is patched
+            %   instead of computed again. Formats with small sub-graphs,
+            %   like "tassl", analyse much less of the matrix again than
+            %   formats whose sub-graphs span the whole matrix, like
+            %   "levelSet".
+            %
+            %   The size of the matrix cannot change, the new elements must
+            %   be in its lower triangle and its diagonal elements cannot be
+            %   removed. After the update, the elements passed to
+            %   updateValues follow the order of the rows and then of the
+            %   columns.
+            
+            assert(~isempty(obj.Solver), ...
+                "amsla:AnalysisRequired", ...
+                "Cannot update the pattern of a matrix without analysis");
+            if nargin<5
+                removedRows = zeros(0, 1);
+                removedColumns = zeros(0, 1);
+            end
+            
+            oldGraph = obj.DataStructure;
+            edgeIds = oldGraph.listOfEdges();
+            [rows, columns] = iEdgeEndNodes(oldGraph);
+            values = reshape(oldGraph.weightOfEdge(edgeIds), [], 1);
+            timeSlots = reshape(oldGraph.timeSlotOfEdge(edgeIds), [], 1);
+            numNodes = numel(oldGraph.listOfNodes());
+            [added, removed] = iParsePatternChange(numNodes, [rows, columns], ...
+                addedRows, addedColumns, addedValues, removedRows, removedColumns);
+            
+            % New data structure, with the sub-graphs of the old one
+            isKept = ~ismember([rows, columns], removed, 'rows');
+            newGraph = iNewDataStructure(obj.Format, obj.IsCompact, ...
+                [rows(isKept); added(:, 1)], ...
+                [columns(isKept); added(:, 2)], ...
+                [values(isKept); added(:, 3)]);
+            nodeIds = reshape(newGraph.listOfNodes(), [], 1);
+            assert(numel(nodeIds)==numNodes, ...
+                "amsla:updatePattern:sizeChanged", ...
+                "The size of the matrix cannot change.");
+            oldSubGraphs = reshape(oldGraph.subGraphOfNode(nodeIds), [], 1);
+            newGraph.setSubGraphOfNode(nodeIds, oldSubGraphs);
+            
+            changedNodes = unique([added(:, 1); added(:, 2); removed(:, 1); removed(:, 2)]);
+            affectedIds = amsla.common.internal.findAffectedSubGraphs(newGraph, changedNodes);
+            isAffectedNode = ismember(oldSubGraphs, affectedIds);
+            
+            % The edges of the other sub-graphs keep their time-slots
+            [newRows, newColumns] = iEdgeEndNodes(newGraph);
+            [~, newEdgeOfKept] = ismember([rows(isKept), columns(isKept)], ...
+                [newRows, newColumns], 'rows');
+            keptTimeSlots = timeSlots(isKept);
+            isRestored = ~isAffectedNode(rows(isKept)) & ~amsla.common.isNullId(keptTimeSlots);
+            if any(isRestored)
+                newGraph.setTimeSlotOfEdge(newEdgeOfKept(isRestored), keptTimeSlots(isRestored));
+            end
+            
+            % The partitioner and the scheduler work on the new graph
+            obj.DataStructure = newGraph;
+            obj = obj.setupAnalysisAccordingToFormat(obj.Analysis.MaxSize, false, ...
+                obj.Analysis.UseParallel);
+            
+            % Partition and schedule the affected sub-graphs again
+            startTime = amsla.common.Tracer.timestamp();
+            addedIds = obj.partitionRegion(newGraph, nodeIds(isAffectedNode), max(oldSubGraphs));
+            amsla.common.Tracer.span("partition", startTime, ...
+                struct("format", obj.Format, "numNodes", nnz(isAffectedNode)));
+            
+            startTime = amsla.common.Tracer.timestamp();
+            obj.Scheduler.scheduleSubGraphs(addedIds);
+            amsla.common.Tracer.span("schedule", startTime);
+            
+            startTime = amsla.common.Tracer.timestamp();
+            subGraphLevelsTable = amsla.common.internal.patchSubGraphLevels(newGraph, ...
+                obj.Analysis.SubGraphLevels, affectedIds, addedIds);
+            amsla.common.Tracer.span("findSubGraphLevels", startTime, ...
+                struct("numSubGraphs", height(subGraphLevelsTable)));
+            
+            obj.EdgeOfInput = reshape(1:numel(newRows), [], 1);
+            obj.Analysis.SubGraphLevels = subGraphLevelsTable;
+            partitioningResults = amsla.common.PartitioningResult(true, ...
+                newGraph, subGraphLevelsTable);
+            obj.Solver = amsla.common.TriangularSolver(newGraph, ...
+                "SubGraphLevels", subGraphLevelsTable, obj.Analysis.SolverOptions{:});
+        end
+        
+    end
+    
+    methods(Static)
+        
+        function obj = fromFile(fileName, format, varargin)
+            %FROMFILE Create a sparse matrix from a file.
+            %
+            %   M = AMSLA.SPARSEMATRIX.FROMFILE(F, FORMAT) Read the lower
+            %   triangle of the matrix in the Matrix Market file or binary
+            %   CSR dump F, and store it in the format FORMAT. See
+            %   amsla.common.internal.readMatrixFile for the supported files.
+            %
+            %   M = AMSLA.SPARSEMATRIX.FROMFILE(__, 'ChunkSize', S) Read the
+            %   file S elements at a time.
+            %
+            %   The file is read in chunks, straight into compressed rows.
+            %   Formats whose data structure can be built from compressed
+            %   rows, such as "csr", use them as they are, without an
+            %   intermediate copy of the triplets. The elements passed to
+            %   updateValues follow the order of the rows and then of the
+            %   columns.
+            
+            validateattributes(format, {'string', 'char'}, {'nonempty', 'scalartext'});
+            obj = amsla.SparseMatrix();
+            obj.Format = validatestring(format, iGetSupportedFormats());
+            
+            [rowPointer, columnIndex, values] = ...
+                amsla.common.internal.readMatrixFile(fileName, varargin{:});
+            obj.DataStructure = iDataStructureFromCompressedRows(obj.Format, ...
+                rowPointer, columnIndex, values);
+            obj.EdgeOfInput = reshape(1:numel(values), [], 1);
+        end
+        
     end
     
     %% PRIVATE METHDOS
     
     methods(Access=private)
         
-        function obj = setupAnalysisAccordingToFormat(obj, maxSize, plotProgress)
+        function [format, maxSize, tunedMatrix] = tuneFormatAndSize(obj)
+            % Choose the best format and maximum sub-graph size with the
+            % auto-tuner, and get the matrix it analysed with them.
+            
+            edgeIds = obj.DataStructure.listOfEdges();
+            [rows, columns] = iEdgeEndNodes(obj.DataStructure);
+            values = obj.DataStructure.weightOfEdge(edgeIds);
+            tuner = amsla.common.internal.AutoTuner("Compact", obj.IsCompact);
+            [format, maxSize, tunedMatrix] = tuner.tune(rows, columns, values, iGetSupportedFormats());
+        end
+        
+        function obj = changeFormat(obj, format)
+            % Store the matrix in a different format. Edge IDs follow the
+            % same order in all the formats, so EdgeOfInput still holds.
+            
+            if format==obj.Format
+                return;
+            end
+            edgeIds = obj.DataStructure.listOfEdges();
+            [rows, columns] = iEdgeEndNodes(obj.DataStructure);
+            values = obj.DataStructure.weightOfEdge(edgeIds);
+            obj.Format = format;
+            obj.DataStructure = iNewDataStructure(format, obj.IsCompact, rows, columns, values);
+            obj.Solver = [];
+        end
+        
+        function [edgeIds, values] = edgesToUpdate(obj, varargin)
+            % Parse the inputs to updateValues and find the edges to update.
+            
+            if nargin==2 && issparse(varargin{1})
+                sparseMatrix = varargin{1};
+                [rows, columns] = iEdgeEndNodes(obj.DataStructure);
+                numNodes = numel(obj.DataStructure.listOfNodes());
+                validateattributes(sparseMatrix, {'numeric'}, ...
+                    {'size', [numNodes, numNodes]});
+                [I, J] = find(sparseMatrix);
+                assert(all(ismember([I, J], [rows, columns], 'rows')), ...
+                    "amsla:updateValues:patternChanged", ...
+                    "The sparsity pattern of the matrix cannot change.");
+                edgeIds = obj.DataStructure.listOfEdges();
+                values = full(sparseMatrix(sub2ind(size(sparseMatrix), rows, columns)));
+            elseif nargin==2
+                values = varargin{1};
+                validateattributes(values, {'numeric'}, ...
+                    {'vector', 'nonsparse', 'finite', 'numel', numel(obj.EdgeOfInput)});
+                edgeIds = obj.EdgeOfInput;
+            elseif nargin==4
+                [I, J, values] = deal(varargin{:});
+                requiredAttributes = {'vector', 'nonsparse', 'finite', 'numel', numel(I)};
+                validateattributes(I, {'numeric'}, requiredAttributes);
+                validateattributes(J, {'numeric'}, requiredAttributes);
+                validateattributes(values, {'numeric'}, requiredAttributes);
+                [rows, columns] = iEdgeEndNodes(obj.DataStructure);
+                [isInPattern, edgeIds] = ismember( ...
+                    [reshape(I, [], 1), reshape(J, [], 1)], [rows, columns], 'rows');
+                assert(all(isInPattern), ...
+                    "amsla:updateValues:patternChanged", ...
+                    "The sparsity pattern of the matrix cannot change.");
+            else
+                error("amsla:badInputs", "Bad inputs to updateValues");
+            end
+            values = reshape(double(full(values)), [], 1);
+            edgeIds = reshape(edgeIds, [], 1);
+        end
+        
+        function subGraphIds = partitionRegion(obj, aGraph, nodeIds, lastSubGraphId)
+            % Partition the nodes NODEIDS of the graph on their own, with
+            % the partitioner of the format, and give them new sub-graph
+            % IDs after LASTSUBGRAPHID. The edges that leave the region are
+            % ignored: a node without edges inside the region is a
+            % sub-graph on its own.
+            
+            edgeIds = aGraph.listOfEdges();
+            [rows, columns] = iEdgeEndNodes(aGraph);
+            isInternal = ismember(rows, nodeIds) & ismember(columns, nodeIds);
+            
+            % The local graph numbers the nodes with internal edges in the
+            % same order as the graph.
+            isConnected = ismember(nodeIds, [rows(isInternal); columns(isInternal)]);
+            localNodes = nodeIds(isConnected);
+            localIdOfNode = zeros(max([0; nodeIds]), 1);
+            localIdOfNode(localNodes) = 1:numel(localNodes);
+            
+            newSubGraphs = zeros(numel(nodeIds), 1);
+            if any(isInternal)
+                localGraph = iNewDataStructure(obj.Format, obj.IsCompact, ...
+                    localIdOfNode(rows(isInternal)), ...
+                    localIdOfNode(columns(isInternal)), ...
+                    reshape(aGraph.weightOfEdge(edgeIds(isInternal)), [], 1));
+                partitionerConstructor = iGetPackageObject("Partitioner", obj.Format);
+                localPartitioner = partitionerConstructor(localGraph, ...
+                    obj.Analysis.MaxSize, ...
+                    "UseParallel", obj.Analysis.UseParallel);
+                localPartitioner.partition();
+                [~, ~, localSubGraphs] = unique(localGraph.subGraphOfNode(1:numel(localNodes)));
+                newSubGraphs(isConnected) = localSubGraphs;
+            end
+            numLocalSubGraphs = max([0; newSubGraphs]);
+            newSubGraphs(~isConnected) = numLocalSubGraphs + (1:nnz(~isConnected));
+            newSubGraphs = newSubGraphs + lastSubGraphId;
+            
+            aGraph.setSubGraphOfNode(nodeIds, newSubGraphs);
+            subGraphIds = unique(newSubGraphs);
+        end
+        
+        function obj = setupAnalysisAccordingToFormat(obj, maxSize, plotProgress, useParallel)
             % Choose partitioner and scheduler according to the storage
             % format.
             
@@ -93,10 +584,12 @@ classdef SparseMatrix
             obj.Partitioner = partitionerConstructor(...
                 obj.DataStructure, ...
                 maxSize, ...
-                "PlotProgress", plotProgress);
+                "PlotProgress", plotProgress, ...
+                "UseParallel", useParallel);
             
             schedulerConstructor = iGetPackageObject("Scheduler", obj.Format);
-            obj.Scheduler = schedulerConstructor(obj.DataStructure);
+            obj.Scheduler = schedulerConstructor(obj.DataStructure, ...
+                "UseParallel", useParallel);
         end
         
     end
@@ -104,10 +597,10 @@ end
 
 %% HELPER METHODS
 
-function [I, J, V, format] = iParseConstructorArguments(varargin)
+function [I, J, V, format, isCompact] = iParseConstructorArguments(varargin)
 % Parse the inputs to the constructor
 
-if nargin==2
+if nargin==2 || (nargin>2 && issparse(varargin{1}))
     % If the input is a sparse MATLAB matrix, extract row indices, column
     % indices, and values
     sparseMatrix = varargin{1};
@@ -116,7 +609,8 @@ if nargin==2
     [I, J, V] = find(sparseMatrix);
     
     format = varargin{2};
-elseif nargin==4
+    options = varargin(3:end);
+elseif nargin>=4
     % Input is the matrix elements in the coordinate form
     I = varargin{1};
     J = varargin{2};
@@ -128,6 +622,7 @@ elseif nargin==4
     validateattributes(V, {'numeric'}, requiredAttributes);
     
     format = varargin{4};
+    options = varargin(5:end);
 else
     error("amsla:badInputs", "Bad inputs to the matrix constructor");
 end
@@ -135,19 +630,122 @@ end
 % Validate the matrix format
 validateattributes(format, {'string', 'char'}, {'nonempty', 'scalartext'});
 format = validatestring(format, iGetSupportedFormats());
+
+parser = inputParser;
+addParameter(parser, 'Compact', false, @(x) islogical(x) && isscalar(x));
+parse(parser, options{:});
+isCompact = parser.Results.Compact;
 end
 
-function [maxSize, plotProgress] = iParseAnalyseArguments(varargin)
+function edgeOfInput = iEdgeOfInput(I, J)
+% Find the edge ID of each element passed to the constructor. Edges are
+% sorted by row and then by column.
+
+[~, sorter] = sortrows([reshape(double(I), [], 1), reshape(double(J), [], 1)]);
+edgeOfInput = zeros(numel(sorter), 1);
+edgeOfInput(sorter) = 1:numel(sorter);
+end
+
+function aDataStructure = iNewDataStructure(format, isCompact, rows, columns, values)
+% Create the data structure of a format from the triplet ROWS, COLUMNS,
+% VALUES, in its compact layout if requested and the format has one.
+
+objConstructor = iGetPackageObject("DataStructure", format);
+if isCompact && ismember("isCompact", methods(func2str(objConstructor)))
+    aDataStructure = objConstructor(rows, columns, values, "Compact", true);
+else
+    aDataStructure = objConstructor(rows, columns, values);
+end
+end
+
+function aDataStructure = iDataStructureFromCompressedRows(format, rowPointer, columnIndex, values)
+% Create the data structure of a format from compressed rows, without
+% expanding them to triplets if the format supports it.
+
+objConstructor = iGetPackageObject("DataStructure", format);
+className = func2str(objConstructor);
+if ismember("fromCompressedRows", methods(className))
+    aDataStructure = feval(className + ".fromCompressedRows", rowPointer, columnIndex, values);
+else
+    rowIndex = repelem(reshape(1:(numel(rowPointer)-1), [], 1), diff(rowPointer));
+    aDataStructure = objConstructor(rowIndex, columnIndex, values);
+end
+end
+
+function [added, removed] = iParsePatternChange(numNodes, pattern, addedRows, addedColumns, addedValues, removedRows, removedColumns)
+% Parse the inputs to updatePattern. ADDED has the rows, columns and values
+% of the new elements, REMOVED the rows and columns of the removed ones.
+
+indexAttributes = {'integer', 'positive', '<=', numNodes};
+validateattributes(addedRows, {'numeric'}, indexAttributes);
+validateattributes(addedColumns, {'numeric'}, indexAttributes);
+validateattributes(addedValues, {'numeric'}, {'finite'});
+validateattributes(removedRows, {'numeric'}, indexAttributes);
+validateattributes(removedColumns, {'numeric'}, indexAttributes);
+assert(numel(addedColumns)==numel(addedRows) && numel(addedValues)==numel(addedRows) && ...
+    numel(removedColumns)==numel(removedRows), ...
+    "amsla:badInputs", "Bad inputs to updatePattern");
+
+added = [reshape(double(addedRows), [], 1), reshape(double(addedColumns), [], 1), ...
+    reshape(double(full(addedValues)), [], 1)];
+removed = [reshape(double(removedRows), [], 1), reshape(double(removedColumns), [], 1)];
+
+assert(~any(ismember(added(:, 1:2), pattern, 'rows')) && ...
+    size(unique(added(:, 1:2), 'rows'), 1)==size(added, 1), ...
+    "amsla:updatePattern:alreadyInPattern", ...
+    "The elements to add must not be in the sparsity pattern of the matrix.");
+assert(all(ismember(removed, pattern, 'rows')), ...
+    "amsla:updatePattern:notInPattern", ...
+    "The elements to remove must be in the sparsity pattern of the matrix.");
+assert(all(added(:, 1)>=added(:, 2)), ...
+    "amsla:updatePattern:notLowerTriangular", ...
+    "The elements to add must be in the lower triangle of the matrix.");
+assert(all(removed(:, 1)~=removed(:, 2)), ...
+    "amsla:updatePattern:diagonalRemoved", ...
+    "The diagonal elements of the matrix cannot be removed.");
+end
+
+function [rows, columns] = iEdgeEndNodes(aDataStructure)
+% Row and column of every edge of a data structure, sorted by edge ID.
+
+edgeIds = aDataStructure.listOfEdges();
+rows = reshape(aDataStructure.exitingNodeOfEdge(edgeIds), [], 1);
+columns = reshape(aDataStructure.enteringNodeOfEdge(edgeIds), [], 1);
+end
+
+function [maxSize, plotProgress, solverOptions, cacheFolder, useParallel] = iParseAnalyseArguments(varargin)
 % Parse the inputs to the method "analyse"
 
 parser = inputParser;
-addOptional(parser,'MaxSize', [], @(x) isnumeric(x) && isscalar(x));
+addOptional(parser,'MaxSize', [], ...
+    @(x) (isnumeric(x) && isscalar(x)) || (iIsText(x) && strcmpi(x, "auto")));
 addParameter(parser,'PlotProgress', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser,'NumThreads', [], @(x) isempty(x) || (isnumeric(x) && isscalar(x)));
+addParameter(parser,'CacheFolder', "", @(x) isStringScalar(x) || ischar(x));
+addParameter(parser,'Reorder', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser,'UseParallel', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser,'DenseBlocks', false, @(x) islogical(x) && isscalar(x));
+addParameter(parser,'Precision', "double", @(x) isStringScalar(x) || ischar(x));
+addParameter(parser,'Execution', "levels", @(x) isStringScalar(x) || ischar(x));
 
 parse(parser, varargin{:});
 
 maxSize = parser.Results.MaxSize;
 plotProgress = parser.Results.PlotProgress;
+solverOptions = {'NumThreads', parser.Results.NumThreads, ...
+    'Reorder', parser.Results.Reorder, ...
+    'DenseBlocks', parser.Results.DenseBlocks, ...
+    'Precision', parser.Results.Precision, ...
+    'Execution', parser.Results.Execution};
+useParallel = parser.Results.UseParallel;
+cacheFolder = string(parser.Results.CacheFolder);
+if cacheFolder==""
+    cacheFolder = [];
+end
+end
+
+function tf = iIsText(x)
+tf = isStringScalar(x) || ischar(x);
 end
 
 function formatList = iGetSupportedFormats()
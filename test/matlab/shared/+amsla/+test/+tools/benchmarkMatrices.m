@@ -0,0 +1,135 @@
+function matrices = benchmarkMatrices()
+%AMSLA.TEST.TOOLS.BENCHMARKMATRICES Lower-triangular matrices for the
+%performance tests.
+%
+%   M = AMSLA.TEST.TOOLS.BENCHMARKMATRICES() Return a structure whose
+%   fields are function handles. Each handle takes no inputs and returns a
+%   sparse, lower-triangular matrix with a non-zero diagonal. The structure
+%   can be used as a test parameter.
+%
+%   The matrices are read from the Matrix Market files (*.mtx) in the
+%   folder named by the environment variable AMSLA_BENCHMARK_MATRICES.
+%   Matrices that are not lower-triangular, or that have zeros on the
+%   diagonal, are replaced by their strictly lower triangle plus a
+%   diagonally dominant diagonal.
+%
+%   When the variable is not set, synthetic matrices with the structure of
+%   circuit, FEM and power-network factors are generated instead. Their
+%   number of rows goes from 10^3 up to the value of the environment
+%   variable AMSLA_BENCHMARK_MAX_ROWS, which defaults to 10^4 and can be
+%   raised to 10^6.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+matrixFolder = getenv("AMSLA_BENCHMARK_MATRICES");
+if ~isempty(matrixFolder)
+    matrices = iMatricesFromFolder(matrixFolder);
+else
+    matrices = iSyntheticMatrices(iMaxRows());
+end
+end
+
+%% HELPER FUNCTIONS
+
+function matrices = iMatricesFromFolder(matrixFolder)
+% One test parameter for each Matrix Market file in the folder.
+
+files = dir(fullfile(matrixFolder, "*.mtx"));
+assert(~isempty(files), "amsla:test:noBenchmarkMatrices", ...
+    "No Matrix Market files in folder '%s'.", matrixFolder);
+
+matrices = struct();
+for k = 1:numel(files)
+    fileName = fullfile(files(k).folder, files(k).name);
+    [~, name] = fileparts(fileName);
+    matrices.(matlab.lang.makeValidName(name)) = ...
+        @() iLowerTriangularFactor(amsla.test.tools.readMatrixMarket(fileName));
+end
+end
+
+function matrices = iSyntheticMatrices(maxRows)
+% Synthetic matrices of increasing size.
+
+generators = struct( ...
+    "Circuit", @iCircuit, ...
+    "Fem",     @iFem, ...
+    "Power",   @iPowerNetwork);
+sizes = 10.^(3:6);
+sizes = sizes(sizes<=maxRows);
+
+matrices = struct();
+for generatorName = string(fieldnames(generators))'
+    for numRows = sizes
+        generator = generators.(generatorName);
+        matrices.(generatorName + "_" + numRows) = @() generator(numRows);
+    end
+end
+end
+
+function maxRows = iMaxRows()
+maxRows = str2double(getenv("AMSLA_BENCHMARK_MAX_ROWS"));
+if isnan(maxRows)
+    maxRows = 1e4;
+end
+end
+
+function L = iLowerTriangularFactor(A)
+% Keep the lower triangle of a matrix. Replace the diagonal with one that
+% makes the matrix diagonally dominant, so that the solution is bounded.
+
+if istril(A) && all(diag(A)~=0)
+    L = A;
+    return;
+end
+strictlyLower = tril(A, -1);
+numRows = size(A, 1);
+diagonal = full(sum(abs(strictlyLower), 2)) + 1;
+L = strictlyLower + spdiags(diagonal, 0, numRows, numRows);
+end
+
+function L = iCircuit(numRows)
+% Circuit-like factor: mostly short-range connections, plus a few hub
+% nodes (e.g. supply rails) connected to many rows.
+
+rng(0, "twister");
+numHubs = max(1, round(numRows/1000));
+rows = repelem((2:numRows)', 3);
+columns = ceil(rand(size(rows)).*(rows-1));
+isHub = rand(size(rows))<0.05;
+columns(isHub) = randi(min(numHubs, numRows-1), nnz(isHub), 1);
+columns = min(columns, rows-1);
+L = iLowerTriangularFactor(sparse(rows, columns, 1-2*rand(size(rows)), numRows, numRows));
+end
+
+function L = iFem(numRows)
+% FEM-like factor: incomplete Cholesky factor of a 2-D Laplacian.
+
+gridSize = ceil(sqrt(numRows));
+A = delsq(numgrid("S", gridSize+2));
+L = ichol(A);
+end
+
+function L = iPowerNetwork(numRows)
+% Power-network-like factor: nodes connected to their geographic
+% neighbours, plus sparse long-distance transmission lines.
+
+rng(0, "twister");
+rows = repelem((2:numRows)', 2);
+columns = rows - randi(20, size(rows));
+isLongDistance = rand(size(rows))<0.01;
+columns(isLongDistance) = ceil(rand(nnz(isLongDistance), 1).*(rows(isLongDistance)-1));
+columns = max(columns, 1);
+L = iLowerTriangularFactor(sparse(rows, columns, 1-2*rand(size(rows)), numRows, numRows));
+end
@@ -29,4 +29,10 @@ function tol = computeTolerance(toleranceType, complexityFcn, varargin)
     % See the License for the specific language governing permissions and
     % limitations under the License.
     
-end
\ No newline at end of file
+    validatestring(toleranceType, ["Absolute", "Relative"]);
+    assert(~isempty(varargin), ...
+        "amsla:computeTolerance:noData", ...
+        "At least one input is required to compute the tolerance.");
+    
+    tol = eps(class(varargin{1}))*complexityFcn(varargin{:});
+end
@@ -0,0 +1,57 @@
+function A = readMatrixMarket(fileName)
+%AMSLA.TEST.TOOLS.READMATRIXMARKET Read a sparse matrix from a Matrix
+%Market file.
+%
+%   A = AMSLA.TEST.TOOLS.READMATRIXMARKET(F) Read the sparse matrix in the
+%   Matrix Market file F. Only the "coordinate" layout is supported, with
+%   "real", "integer" or "pattern" fields and "general" or "symmetric"
+%   symmetry. Pattern matrices get unit values.
+
+% Copyright 2020 Andrea Picciau
+%
+% Licensed under the Apache License, Version 2.0 (the "License");
+% you may not use this file except in compliance with the License.
+% You may obtain a copy of the License at
+%
+%    http://www.apache.org/licenses/LICENSE-2.0
+%
+% Unless required by applicable law or agreed to in writing, software
+% distributed under the License is distributed on an "AS IS" BASIS,
+% WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+% See the License for the specific language governing permissions and
+% limitations under the License.
+
+fileId = fopen(fileName, "r");
+assert(fileId>=0, "amsla:test:cannotOpenFile", "Cannot open file '%s'.", fileName);
+closeFile = onCleanup(@() fclose(fileId));
+
+% Header
+header = lower(strsplit(strtrim(fgetl(fileId))));
+assert(numel(header)==5 && header{1}=="%%matrixmarket" && ...
+    header{2}=="matrix" && header{3}=="coordinate", ...
+    "amsla:test:badMatrixMarket", "Unsupported Matrix Market file '%s'.", fileName);
+field = validatestring(header{4}, ["real", "integer", "pattern"]);
+symmetry = validatestring(header{5}, ["general", "symmetric"]);
+
+% Skip the comments, then read the size line
+sizeLine = fgetl(fileId);
+while startsWith(sizeLine, "%")
+    sizeLine = fgetl(fileId);
+end
+matrixSize = sscanf(sizeLine, "%d %d %d");
+
+% Entries
+if field=="pattern"
+    entries = textscan(fileId, "%f %f");
+    entries{3} = ones(size(entries{1}));
+else
+    entries = textscan(fileId, "%f %f %f");
+end
+[I, J, V] = entries{:};
+
+if symmetry=="symmetric"
+    isOffDiagonal = I~=J;
+    [I, J, V] = deal([I; J(isOffDiagonal)], [J; I(isOffDiagonal)], [V; V(isOffDiagonal)]);
+end
+A = sparse(I, J, V, matrixSize(1), matrixSize(2));
+end
@@ -5,6 +5,10 @@ function currentResults = runAllAmslaPerformanceTests()
 %   TR = RUNALLAMSLAPERFORMANCETESTS() Execute all the available tests. 
 %       Returns the test results.
 %
+%   The matrices of the benchmarks are chosen with the environment
+%   variables AMSLA_BENCHMARK_MATRICES and AMSLA_BENCHMARK_MAX_ROWS. See
+%   amsla.test.tools.benchmarkMatrices.
+%
 
 % Copyright 2018-2020 Andrea Picciau
 %
@@ -0,0 +1,155 @@
+classdef test_AnalysisPhases < amsla.test.tools.AmslaPerformanceTest
+    %TEST_ANALYSISPHASES Performance tests for each phase of the analysis
+    %and for the solve, on realistic lower-triangular factors.
+    %
+    %   The matrices come from amsla.test.tools.benchmarkMatrices: set the
+    %   environment variable AMSLA_BENCHMARK_MATRICES to a folder of Matrix
+    %   Market files to measure them, or AMSLA_BENCHMARK_MAX_ROWS to change
+    %   the size of the synthetic matrices.
+    %
+    %   Each phase is measured separately: partition, schedule,
+    %   findSubGraphLevels, compilation of the solve plan and solve. The
+    %   GFLOP/s and the effective bandwidth of the solve are logged.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% SETUP/TEARDOWN
+    
+    methods(TestClassSetup)
+        
+        function suppressWarningAboutSize(testCase)
+            % Suppress the warning about sub-graph size in the levelSet
+            % case.
+            
+            testCase.applyFixture(iSuppressWarning("amsla:levelSet:sizeIgnored"));
+        end
+        
+    end
+    
+    %% TEST SPECS
+    
+    properties(TestParameter)
+        
+        Matrix = amsla.test.tools.benchmarkMatrices();
+        
+        LevelSetFormat = struct( ...
+            "LevelSet", { "levelSet" }, ...
+            "Csr",      { "csr" });
+        
+        MaxSize = struct( ...
+            "MaxSize16",   { 16 }, ...
+            "MaxSize64",   { 64 }, ...
+            "MaxSize256",  { 256 }, ...
+            "MaxSize1024", { 1024 });
+        
+    end
+    
+    methods(Test)
+        
+        function measureLevelSetPhases(testCase, Matrix, LevelSetFormat)
+            % Measure the phases of the formats based on the level-set
+            % analysis, which does not depend on the maximum sub-graph size.
+            
+            testCase.measurePhases(Matrix(), LevelSetFormat, []);
+        end
+        
+        function measureTasslPhases(testCase, Matrix, MaxSize)
+            % Measure the phases of the TASSL analysis, which partitions the
+            % matrix into sub-graphs of bounded size.
+            
+            testCase.measurePhases(Matrix(), "tassl", MaxSize);
+        end
+        
+    end
+    
+    %% PRIVATE METHODS
+    
+    methods(Access=private)
+        
+        function measurePhases(testCase, data, format, maxSize)
+            % Measure each phase of the analysis and the solve.
+            
+            [I, J, V] = find(data);
+            dataStructureConstructor = iPackageObject("DataStructure", format);
+            partitionerConstructor = iPackageObject("Partitioner", format);
+            schedulerConstructor = iPackageObject("Scheduler", format);
+            dataStructure = dataStructureConstructor(I, J, V);
+            rhs = ones(size(data, 1), 1);
+            
+            testCase.startMeasuring("partition");
+            partitioner = partitionerConstructor(dataStructure, maxSize);
+            partitioner.partition();
+            testCase.stopMeasuring("partition");
+            
+            testCase.startMeasuring("schedule");
+            scheduler = schedulerConstructor(dataStructure);
+            scheduler.scheduleOperations();
+            testCase.stopMeasuring("schedule");
+            
+            testCase.startMeasuring("findSubGraphLevels");
+            subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(dataStructure);
+            testCase.stopMeasuring("findSubGraphLevels");
+            
+            testCase.startMeasuring("compile");
+            solver = amsla.common.TriangularSolver(dataStructure, ...
+                "SubGraphLevels", subGraphLevelsTable);
+            testCase.stopMeasuring("compile");
+            
+            testCase.startMeasuring("solve");
+            solveTimer = tic();
+            result = solver.solve(rhs); %#ok<NASGU>
+            solveTime = toc(solveTimer);
+            testCase.stopMeasuring("solve");
+            
+            testCase.logSolveThroughput(data, solveTime);
+        end
+        
+        function logSolveThroughput(testCase, data, solveTime)
+            % Log the GFLOP/s and the effective bandwidth of a solve. Each
+            % off-diagonal is a multiply and a subtract, and each diagonal
+            % is a multiply by its reciprocal. Each element reads its value,
+            % its column index and one entry of the solution; each row reads
+            % the right-hand side and writes the solution.
+            
+            numRows = size(data, 1);
+            numElements = nnz(data);
+            flops = 2*(numElements-numRows) + numRows;
+            bytes = 8*3*numElements + 8*2*numRows;
+            
+            testCase.log(matlab.unittest.Verbosity.Concise, sprintf( ...
+                "%d rows, %d non-zeros: %.3f GFLOP/s, %.3f GB/s", ...
+                numRows, numElements, flops/solveTime/1e9, bytes/solveTime/1e9));
+        end
+        
+    end
+    
+end
+
+%% HELPER FUNCTION
+
+function fixture = iSuppressWarning(warningId)
+fixture = matlab.unittest.fixtures.SuppressedWarningsFixture(warningId);
+end
+
+function objectConstructor = iPackageObject(objectName, formatName)
+% Get the constructor of an object of a format, falling back to the common
+% package like amsla.SparseMatrix does.
+
+fullObjectName = "amsla." + formatName + "." + objectName;
+if ~exist(fullObjectName, "class")
+    fullObjectName = "amsla.common." + objectName;
+end
+objectConstructor = str2func(fullObjectName);
+end
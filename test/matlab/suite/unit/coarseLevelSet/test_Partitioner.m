@@ -0,0 +1,86 @@
+classdef test_Partitioner < amsla.test.shared.PartitionerTests
+    %TEST_PARTITIONER Tests for the class amsla.coarseLevelSet.Partitioner
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    methods(Access=protected, Static)
+        
+        function analyserObject = createPartitionerObject(underlyingObject, maxSize)
+            analyserObject = amsla.coarseLevelSet.Partitioner(underlyingObject, maxSize);
+        end
+        
+    end
+    
+    methods(Test)
+        
+        function chainIsMergedIntoFewSubGraphs(testCase)
+            % Check that the levels of a bidiagonal matrix, which has one
+            % node per level, are merged into as few sub-graphs as the
+            % maximum work allows, in order.
+            
+            numRows = 50;
+            A = spdiags(ones(numRows, 2), [-1, 0], numRows, numRows);
+            [I, J, V] = find(A);
+            aGraph = amsla.common.DataStructure(I, J, V);
+            
+            partitioner = amsla.coarseLevelSet.Partitioner(aGraph, 10);
+            partitioner.partition();
+            
+            subGraphs = aGraph.subGraphOfNode(1:numRows);
+            testCase.verifyTrue(all(diff(subGraphs)>=0), ...
+                "Consecutive levels should be merged in order.");
+            testCase.verifyEqual(subGraphs(1:5), ones(1, 5), ...
+                "The first row has one element and the next have two.");
+            testCase.verifyEqual(max(subGraphs), 1 + ceil((numRows-5)/5));
+        end
+        
+        function wideLevelIsNotMerged(testCase)
+            % Check that a level with more elements than the maximum keeps
+            % its own sub-graph.
+            
+            A = speye(20);
+            A(20, 1:19) = 1;
+            [I, J, V] = find(A);
+            aGraph = amsla.common.DataStructure(I, J, V);
+            
+            partitioner = amsla.coarseLevelSet.Partitioner(aGraph, 10);
+            partitioner.partition();
+            
+            testCase.verifyEqual(aGraph.subGraphOfNode(1:20), [ones(1, 19), 2]);
+        end
+        
+        function coarseLevelsSolveCorrectly(testCase)
+            % Check that a matrix analysed with coarse levels gives the same
+            % solution as MATLAB's backslash, with fewer levels than the
+            % level-set algorithm.
+            
+            rng('default');
+            numRows = 200;
+            A = spdiags([rand(numRows, 3), 4*ones(numRows, 1)], [-3, -2, -1, 0], numRows, numRows);
+            rhs = ones(numRows, 1);
+            
+            coarseMatrix = amsla.SparseMatrix(A, "coarseLevelSet");
+            [coarseMatrix, coarseResult] = coarseMatrix.analyse(64);
+            levelSetMatrix = amsla.SparseMatrix(A, "levelSet");
+            [~, levelSetResult] = levelSetMatrix.analyse();
+            
+            testCase.verifyEqual(coarseMatrix.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong solution with coarse levels.");
+            testCase.verifyLessThan(coarseResult.NumLevels, levelSetResult.NumLevels/4);
+        end
+        
+    end
+end
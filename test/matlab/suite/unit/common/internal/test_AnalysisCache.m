@@ -0,0 +1,119 @@
+classdef test_AnalysisCache < amsla.test.tools.AmslaTest
+    %TEST_ANALYSISCACHE Tests for amsla.common.internal.AnalysisCache
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        Format = struct( ...
+            'Tassl', { "tassl" }, ...
+            'Csr',   { "csr" });
+    end
+    
+    methods(Test)
+        
+        function keyDependsOnlyOnPatternFormatAndSize(testCase)
+            % Check that the key ignores the values of the matrix, but not
+            % its sparsity pattern, format and maximum sub-graph size.
+            
+            cache = amsla.common.internal.AnalysisCache(iTemporaryFolder(testCase));
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V);
+            key = cache.keyOf(aGraph, "tassl", 3);
+            
+            testCase.verifyEqual( ...
+                cache.keyOf(amsla.common.DataStructure(I, J, 2*V), "tassl", 3), key, ...
+                "The key should not depend on the values of the matrix.");
+            testCase.verifyNotEqual( ...
+                cache.keyOf(amsla.common.DataStructure(I(2:end), J(2:end), V(2:end)), "tassl", 3), key, ...
+                "The key should depend on the sparsity pattern.");
+            testCase.verifyNotEqual(cache.keyOf(aGraph, "csr", 3), key, ...
+                "The key should depend on the format.");
+            testCase.verifyNotEqual(cache.keyOf(aGraph, "tassl", 4), key, ...
+                "The key should depend on the maximum sub-graph size.");
+        end
+        
+        function restoreReproducesAnalysis(testCase)
+            % Check that restoring a saved entry assigns the same sub-graphs
+            % and time-slots as the original analysis.
+            
+            cache = amsla.common.internal.AnalysisCache(iTemporaryFolder(testCase));
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            analysedGraph = amsla.common.DataStructure(I, J, V);
+            amsla.test.tools.tasslAnalysis(analysedGraph, 3);
+            key = cache.keyOf(analysedGraph, "tassl", 3);
+            cache.save(key, analysedGraph, ...
+                amsla.common.internal.findSubGraphLevels(analysedGraph));
+            
+            [isCached, entry] = cache.load(key);
+            testCase.assertTrue(isCached, "The entry was not found in the cache.");
+            restoredGraph = amsla.common.DataStructure(I, J, V);
+            amsla.common.internal.AnalysisCache.restore(entry, restoredGraph);
+            
+            testCase.verifyEqual( ...
+                restoredGraph.subGraphOfNode(restoredGraph.listOfNodes()), ...
+                analysedGraph.subGraphOfNode(analysedGraph.listOfNodes()), ...
+                "The sub-graphs were not restored.");
+            testCase.verifyEqual( ...
+                restoredGraph.timeSlotOfEdge(restoredGraph.listOfEdges()), ...
+                analysedGraph.timeSlotOfEdge(analysedGraph.listOfEdges()), ...
+                "The time-slots were not restored.");
+        end
+        
+        function missingEntryIsNotCached(testCase)
+            % Check that loading a key that was never saved fails.
+            
+            cache = amsla.common.internal.AnalysisCache(iTemporaryFolder(testCase));
+            testCase.verifyFalse(cache.load("0123"));
+        end
+        
+        function analyseLoadsCachedResult(testCase, Format)
+            % Check that a second analysis with the same cache folder gives
+            % the same solution as the first one.
+            
+            folder = iTemporaryFolder(testCase);
+            W = gallery("wathen", 3, 3);
+            A = tril(W) + speye(size(W));
+            rhs = ones(size(A, 1), 1);
+            
+            firstMatrix = amsla.SparseMatrix(A, Format);
+            firstMatrix = firstMatrix.analyse(3, "CacheFolder", folder);
+            testCase.verifyNumElements(dir(fullfile(folder, "*.mat")), 1, ...
+                "The analysis was not stored in the cache.");
+            
+            % A cache miss would partition the matrix again
+            testCase.addTeardown(@() amsla.common.Tracer.stop());
+            amsla.common.Tracer.start();
+            secondMatrix = amsla.SparseMatrix(A, Format);
+            secondMatrix = secondMatrix.analyse(3, "CacheFolder", folder);
+            amsla.common.Tracer.stop();
+            eventTable = amsla.common.Tracer.events();
+            testCase.verifyTrue(ismember("analyse", eventTable.Name), ...
+                "The analysis was not traced.");
+            testCase.verifyFalse(ismember("partition", eventTable.Name), ...
+                "The cached analysis was not reused.");
+            
+            testCase.verifyEqual(secondMatrix.solve(rhs), firstMatrix.solve(rhs), ...
+                "The cached analysis gives a different solution.");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function folder = iTemporaryFolder(testCase)
+fixture = testCase.applyFixture(matlab.unittest.fixtures.TemporaryFolderFixture);
+folder = string(fixture.Folder);
+end
@@ -0,0 +1,137 @@
+classdef test_AutoTuner < amsla.test.tools.AmslaTest
+    %TEST_AUTOTUNER Tests for amsla.common.internal.AutoTuner
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% SETUP/TEARDOWN
+    
+    methods(TestMethodSetup)
+        
+        function preserveStoredConfigurations(testCase)
+            % Restore the configurations stored by the user after each
+            % test.
+            
+            group = "amsla";
+            name = "AutoTunerConfigurations";
+            if ispref(group, name)
+                storedConfigurations = getpref(group, name);
+                testCase.addTeardown(@() setpref(group, name, storedConfigurations));
+            else
+                testCase.addTeardown(@() amsla.common.internal.AutoTuner.forgetStored());
+            end
+            amsla.common.internal.AutoTuner.forgetStored();
+        end
+        
+    end
+    
+    %% TEST METHODS
+    
+    methods(Test)
+        
+        function machineProfileIsPositive(testCase)
+            % Check that all the properties of the machine are positive.
+            
+            profile = amsla.common.internal.machineProfile();
+            
+            for fieldName = ["NumCores", "L1CacheSize", "L2CacheSize", "LLCacheSize", "Bandwidth"]
+                testCase.verifyGreaterThan(profile.(fieldName), 0, ...
+                    "Property '" + fieldName + "' should be positive.");
+            end
+        end
+        
+        function tunedConfigurationIsValid(testCase)
+            % Check that the tuner chooses one of the given formats, with a
+            % valid maximum sub-graph size.
+            
+            [I, J, V] = find(iMatrix());
+            formats = ["levelSet", "tassl"];
+            tuner = amsla.common.internal.AutoTuner("NumTrials", 1);
+            
+            [format, maxSize] = tuner.tune(I, J, V, formats);
+            
+            testCase.verifyTrue(ismember(format, formats), ...
+                "The tuner chose a format that was not given.");
+            testCase.verifyTrue(isempty(maxSize) || maxSize>=1, ...
+                "The tuner chose an invalid maximum sub-graph size.");
+        end
+        
+        function storedConfigurationIsReused(testCase)
+            % Check that the configuration chosen for a matrix is reused for
+            % the same matrix, without searching again.
+            
+            [I, J, V] = find(iMatrix());
+            tuner = amsla.common.internal.AutoTuner("NumTrials", 1);
+            [format, maxSize] = tuner.tune(I, J, V, ["levelSet", "tassl"]);
+            
+            % An invalid list of formats would make a new search fail
+            [storedFormat, storedMaxSize] = tuner.tune(I, J, V, [format, "notAFormat"]);
+            
+            testCase.verifyEqual(storedFormat, format);
+            testCase.verifyEqual(storedMaxSize, maxSize);
+        end
+        
+        function tunedMatrixIsAnalysed(testCase)
+            % Check that the tuner returns the matrix it analysed with the
+            % chosen configuration, ready to solve.
+            
+            A = iMatrix();
+            [I, J, V] = find(A);
+            tuner = amsla.common.internal.AutoTuner("NumTrials", 1, "UseStored", false);
+            
+            [~, ~, matrix] = tuner.tune(I, J, V, ["levelSet", "tassl"]);
+            
+            rhs = ones(size(A, 1), 1);
+            testCase.verifyClass(matrix, ?amsla.SparseMatrix);
+            testCase.verifyEqual(matrix.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6, ...
+                "Wrong output of the matrix analysed by the tuner.");
+        end
+        
+        function partitionersStateTheirUseOfMaxSize(testCase)
+            % Check that the partitioners that use a maximum sub-graph size
+            % say so.
+            
+            testCase.verifyFalse(amsla.levelSet.Partitioner.usesMaxSubGraphSize());
+            testCase.verifyFalse(amsla.csr.Partitioner.usesMaxSubGraphSize());
+            testCase.verifyTrue(amsla.tassl.Partitioner.usesMaxSubGraphSize());
+            testCase.verifyTrue(amsla.coarseLevelSet.Partitioner.usesMaxSubGraphSize());
+        end
+        
+        function autoAnalysisSolvesCorrectly(testCase)
+            % Check that a matrix analysed with the auto-tuner gives the
+            % same solution as MATLAB's backslash.
+            
+            A = iMatrix();
+            rhs = ones(size(A, 1), 1);
+            matrix = amsla.SparseMatrix(A, "tassl");
+            matrix = matrix.analyse("Auto");
+            
+            testCase.verifyEqual(matrix.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6, ...
+                "Wrong output after the analysis with the auto-tuner.");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+W = gallery('wathen', 3, 3);
+A = tril(W) + speye(size(W));
+end
@@ -0,0 +1,113 @@
+classdef test_ScheduleSimulator < amsla.test.tools.AmslaTest
+    %TEST_SCHEDULESIMULATOR Tests for amsla.common.internal.ScheduleSimulator
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        
+        AnalysisAlgorithm = struct( ...
+            'LevelSet', { @(ds) amsla.test.tools.levelSetAnalysis(ds) }, ...
+            'Tassl',    { @(ds) amsla.test.tools.tasslAnalysis(ds, 3) });
+        
+    end
+    
+    %% TEST METHODS
+    
+    methods(Test)
+        
+        function levelTimesAddUpToTotal(testCase, AnalysisAlgorithm)
+            % Check that the prediction has one row per level, and that the
+            % times of the levels add up to the total time.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            simulator = iSimulator(4);
+            
+            prediction = simulator.simulate(aGraph, levelsTable);
+            
+            levels = prediction.Levels;
+            testCase.verifyEqual(height(levels), max(levelsTable.SubGraphLevel));
+            testCase.verifyEqual(sum(levels.NumSubGraphs), height(levelsTable));
+            testCase.verifyEqual(prediction.TotalTime, sum(levels.Time), ...
+                "RelTol", 1e-12);
+            testCase.verifyGreaterThanOrEqual(levels.Imbalance, 1 - 1e-12, ...
+                "A level cannot be better than perfectly balanced.");
+            testCase.verifyLessThanOrEqual(levels.NumCores, 4);
+        end
+        
+        function oneCoreRunsSubGraphsInSequence(testCase, AnalysisAlgorithm)
+            % Check that, on one core, each level takes the time of all its
+            % sub-graphs plus a barrier.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            barrierCost = 1e-3;
+            simulator = iSimulator(1, "BarrierCost", barrierCost);
+            
+            prediction = simulator.simulate(aGraph, levelsTable);
+            
+            levels = prediction.Levels;
+            testCase.verifyEqual(levels.Time, levels.Work + barrierCost, ...
+                "RelTol", 1e-12);
+            testCase.verifyEqual(levels.Imbalance, ones(height(levels), 1), ...
+                "RelTol", 1e-12);
+        end
+        
+        function moreCoresAreNotSlower(testCase, AnalysisAlgorithm)
+            % Check that adding cores with their own bandwidth never makes
+            % the predicted solve slower.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            
+            oneCore = iSimulator(1).simulate(aGraph, levelsTable);
+            manyCores = iSimulator(8).simulate(aGraph, levelsTable);
+            
+            testCase.verifyLessThanOrEqual(manyCores.TotalTime, oneCore.TotalTime*(1 + 1e-12));
+        end
+        
+        function partitioningResultGivesSamePrediction(testCase)
+            % Check that simulating the statistics of an analysis gives the
+            % same prediction as simulating the data structure.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph( ...
+                @(ds) amsla.test.tools.tasslAnalysis(ds, 3));
+            result = amsla.common.PartitioningResult(true, aGraph, levelsTable);
+            simulator = iSimulator(2);
+            
+            testCase.verifyEqual(simulator.simulate(result), ...
+                simulator.simulate(aGraph, levelsTable));
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function [aGraph, levelsTable] = iAnalysedSimpleGraph(analysisAlgorithm)
+[aGraph, ~, ~, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+analysisAlgorithm(aGraph);
+levelsTable = amsla.common.internal.findSubGraphLevels(aGraph);
+end
+
+function simulator = iSimulator(numCores, varargin)
+% A machine where each core has the same bandwidth, whatever the number of
+% cores.
+
+simulator = amsla.common.internal.ScheduleSimulator( ...
+    "NumCores", numCores, ...
+    "L2CacheSize", 256*2^10, ...
+    "LLCacheSize", 8*2^20, ...
+    "Bandwidth", numCores*1e9, ...
+    "CoreBandwidth", 1e9, ...
+    varargin{:});
+end
@@ -0,0 +1,217 @@
+classdef test_SolvePlan < amsla.test.tools.AmslaTest
+    %TEST_SOLVEPLAN Tests for amsla.common.internal.SolvePlan
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        AnalysisAlgorithm = struct( ...
+            'LevelSet', { @(ds) amsla.test.tools.levelSetAnalysis(ds) }, ...
+            'Tassl',    { @(ds) amsla.test.tools.tasslAnalysis(ds, 3) });
+    end
+    
+    methods(Test)
+        
+        function stepsMatchTimeSlotsOfSubGraphs(testCase, AnalysisAlgorithm)
+            % Check that the plan has one step for each time-slot of each
+            % sub-graph, in ascending order of time-slot.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            
+            for k = 1:numel(plan.SubGraphIds)
+                stepIds = plan.SubGraphPointer(k):(plan.SubGraphPointer(k+1)-1);
+                testCase.verifyEqual( ...
+                    plan.TimeSlotIds(stepIds), ...
+                    aGraph.timeSlotsInSubGraph(plan.SubGraphIds(k)), ...
+                    "The steps do not match the time-slots of the sub-graph.");
+            end
+        end
+        
+        function subGraphsAreSortedByLevel(testCase, AnalysisAlgorithm)
+            % Check that the sub-graphs in the plan follow the sub-graph
+            % levels.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            levelsTable = amsla.common.internal.findSubGraphLevels(aGraph);
+            
+            for levelId = 1:plan.NumLevels
+                subGraphIds = plan.SubGraphIds(plan.LevelPointer(levelId):(plan.LevelPointer(levelId+1)-1));
+                testCase.verifyEqual( ...
+                    subGraphIds, ...
+                    sort(levelsTable.SubGraphId(levelsTable.SubGraphLevel==levelId)), ...
+                    "The sub-graphs in a level are not what was expected.");
+            end
+        end
+        
+        function dependenciesMatchSubGraphLevels(testCase, AnalysisAlgorithm)
+            % Check that the successors of each sub-graph in the plan are
+            % the downstream sub-graphs found with the sub-graph levels,
+            % and that they are always in a later level.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            levelsTable = amsla.common.internal.findSubGraphLevels(aGraph);
+            
+            levelOfPosition = repelem((1:plan.NumLevels)', diff(plan.LevelPointer));
+            for k = 1:numel(plan.SubGraphIds)
+                successors = plan.Successors(plan.SuccessorPointer(k):(plan.SuccessorPointer(k+1)-1));
+                expectedIds = levelsTable.ToSubGraphId{levelsTable.SubGraphId==plan.SubGraphIds(k)};
+                testCase.verifyEqual( ...
+                    sort(plan.SubGraphIds(successors)), ...
+                    sort(reshape(expectedIds, [], 1)), ...
+                    "The successors of a sub-graph are not its downstream sub-graphs.");
+                testCase.verifyTrue(all(levelOfPosition(successors)>levelOfPosition(k)), ...
+                    "A sub-graph depends on a sub-graph of the same or a later level.");
+            end
+            testCase.verifyEqual(plan.NumPredecessors, ...
+                accumarray(plan.Successors, 1, [numel(plan.SubGraphIds), 1]));
+        end
+        
+        function allScheduledEdgesAreInThePlan(testCase, AnalysisAlgorithm)
+            % Check that every edge assigned to a time-slot appears exactly
+            % once in the plan.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            
+            edgeIds = aGraph.listOfEdges();
+            isScheduled = ~amsla.common.isNullId(aGraph.timeSlotOfEdge(edgeIds));
+            testCase.verifyEqual( ...
+                sort([plan.EdgeIds; plan.DiagonalEdgeIds]), ...
+                reshape(edgeIds(isScheduled), [], 1), ...
+                "The edges in the plan are not the scheduled ones.");
+        end
+        
+        function reorderedSubGraphsAreContiguous(testCase, AnalysisAlgorithm)
+            % Check that, after renumbering, the rows computed by each
+            % sub-graph are contiguous and sorted by step.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            plan = plan.reorder();
+            
+            testCase.verifyEqual(sort(plan.Permutation), (1:plan.NumRows)', ...
+                "The renumbering is not a permutation.");
+            for k = 1:numel(plan.SubGraphIds)
+                stepIds = plan.SubGraphPointer(k):(plan.SubGraphPointer(k+1)-1);
+                rows = [];
+                for s = stepIds
+                    rows = [rows; ...
+                        plan.UpdateRows(plan.RowPointer(s):(plan.RowPointer(s+1)-1)); ...
+                        plan.DiagonalRows(plan.DiagonalPointer(s):(plan.DiagonalPointer(s+1)-1))]; %#ok<AGROW>
+                end
+                rows = unique(rows);
+                testCase.verifyEqual(rows, (min(rows):max(rows))', ...
+                    "The rows of a sub-graph are not contiguous.");
+            end
+        end
+        
+        function reorderedPlanKeepsSolution(testCase, AnalysisAlgorithm)
+            % Check that the renumbered plan gives the same solution, once
+            % converted back to the original numbering.
+            
+            aGraph = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            reorderedPlan = plan.reorder();
+            
+            rhs = (1:plan.NumRows)';
+            expectedOutput = rhs;
+            actualOutput = reorderedPlan.toPlanOrder(rhs);
+            for levelId = 1:plan.NumLevels
+                expectedOutput = plan.applyLevel(expectedOutput, levelId);
+                actualOutput = reorderedPlan.applyLevel(actualOutput, levelId);
+            end
+            testCase.verifyEqual(reorderedPlan.fromPlanOrder(actualOutput), expectedOutput, ...
+                "AbsTol", 1e-12, ...
+                "The renumbered plan gives a different solution.");
+        end
+        
+        function denseTriangleIsOneDenseBlock(testCase)
+            % Check that a dense lower triangle in a single sub-graph is
+            % found as one dense block.
+            
+            aGraph = iAnalysedDenseGraph(0);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            plan = plan.markDenseBlocks();
+            
+            testCase.assertNumElements(plan.DenseBlocks, 1, ...
+                "A dense triangle should be a single dense block.");
+            testCase.verifyEqual(sort(plan.DenseBlocks.Rows), (1:plan.NumRows)', ...
+                "The dense block does not cover the whole triangle.");
+            testCase.verifyTrue(istril(plan.DenseTriangles{1}), ...
+                "The triangle of the dense block is not lower triangular.");
+        end
+        
+        function denseBlocksKeepSolution(testCase)
+            % Check that executing the dense blocks with dense kernels gives
+            % the same solution as executing their steps, for the system and
+            % its transpose.
+            
+            aGraph = iAnalysedDenseGraph(10);
+            plan = amsla.common.internal.SolvePlan(aGraph);
+            densePlan = plan.markDenseBlocks("MinSize", 4);
+            testCase.assumeNotEmpty(densePlan.DenseBlocks);
+            
+            rhs = reshape(1:(2*plan.NumRows), [], 2);
+            expectedOutput = rhs;
+            actualOutput = rhs;
+            for levelId = 1:plan.NumLevels
+                expectedOutput = plan.applyLevel(expectedOutput, levelId);
+                actualOutput = densePlan.applyLevel(actualOutput, levelId);
+            end
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", 1e-10, ...
+                "The dense blocks give a different solution.");
+            
+            expectedOutput = rhs;
+            actualOutput = rhs;
+            for levelId = plan.NumLevels:-1:1
+                expectedOutput = plan.applyLevelTranspose(expectedOutput, levelId);
+                actualOutput = densePlan.applyLevelTranspose(actualOutput, levelId);
+            end
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", 1e-10, ...
+                "The dense blocks give a different solution of the transposed system.");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function aGraph = iAnalysedSimpleGraph(analysisAlgorithm)
+[~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+V(I==J) = 2;
+aGraph = amsla.common.DataStructure(I, J, V);
+analysisAlgorithm(aGraph);
+end
+
+function aGraph = iAnalysedDenseGraph(numSparseRows)
+% A bidiagonal matrix followed by a dense trailing triangle of 24 rows,
+% which depends on the last row of the bidiagonal part.
+rng('default');
+numDenseRows = 24;
+S = spdiags([-0.5*ones(numSparseRows, 1), 2*ones(numSparseRows, 1)], [-1, 0], ...
+    numSparseRows, numSparseRows);
+D = tril(rand(numDenseRows), -1)/numDenseRows + 2*eye(numDenseRows);
+A = blkdiag(S, sparse(D));
+if numSparseRows>0
+    A((numSparseRows+1):end, numSparseRows) = 0.1;
+end
+[I, J, V] = find(A);
+aGraph = amsla.common.DataStructure(I, J, V);
+amsla.test.tools.tasslAnalysis(aGraph, 64);
+end
@@ -0,0 +1,78 @@
+classdef test_findAffectedSubGraphs < amsla.test.tools.AmslaTest
+    %TEST_FINDAFFECTEDSUBGRAPHS Tests for
+    %amsla.common.internal.findAffectedSubGraphs
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    methods(Test)
+        
+        function subGraphsOfTheNodesAreAffected(testCase)
+            % Check that the sub-graphs of the nodes are returned when there
+            % is no path between them.
+            
+            aGraph = iSimpleGraphWithSubGraphs();
+            
+            actualIds = amsla.common.internal.findAffectedSubGraphs(aGraph, [2, 10]);
+            
+            testCase.verifyEqual(actualIds, [1; 4]);
+        end
+        
+        function subGraphsBetweenTheNodesAreAffected(testCase)
+            % Check that a sub-graph on a path that leaves the sub-graphs of
+            % the nodes and comes back is also returned.
+            
+            numNodes = 5;
+            I = [1:numNodes, 2:numNodes];
+            J = [1:numNodes, 1:(numNodes-1)];
+            aGraph = amsla.common.DataStructure(I, J, ones(size(I)));
+            aGraph.setSubGraphOfNode(1:numNodes, 1:numNodes);
+            
+            actualIds = amsla.common.internal.findAffectedSubGraphs(aGraph, [2, 4]);
+            
+            testCase.verifyEqual(actualIds, [2; 3; 4], ...
+                "Sub-graph 3 is between sub-graphs 2 and 4.");
+        end
+        
+        function dependenciesStayADagAfterSplitting(testCase)
+            % Check that splitting the affected sub-graphs of a partitioned
+            % matrix into one sub-graph per node keeps the dependencies
+            % between the sub-graphs a DAG.
+            
+            rng('default');
+            A = tril(sprand(60, 60, 0.08)) + speye(60);
+            [I, J, V] = find(A);
+            aGraph = amsla.common.DataStructure(I, J, V);
+            amsla.test.tools.tasslAnalysis(aGraph, 8);
+            
+            affectedIds = amsla.common.internal.findAffectedSubGraphs(aGraph, [5, 40]);
+            nodeIds = aGraph.listOfNodes();
+            subGraphs = aGraph.subGraphOfNode(nodeIds);
+            isAffected = ismember(subGraphs, affectedIds);
+            aGraph.setSubGraphOfNode(nodeIds(isAffected), max(subGraphs) + (1:nnz(isAffected)));
+            
+            testCase.verifyWarningFree(@() amsla.common.internal.findSubGraphLevels(aGraph));
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function aGraph = iSimpleGraphWithSubGraphs()
+aGraph = amsla.test.tools.getSimpleLowerTriangularMatrix();
+aGraph.setSubGraphOfNode( ...
+    [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11], ...
+    [1, 1, 1, 2, 2, 3, 3, 3, 4,  4,  4]);
+end
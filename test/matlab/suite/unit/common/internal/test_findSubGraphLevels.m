@@ -39,6 +39,10 @@ classdef test_findSubGraphLevels < amsla.test.tools.AmslaTest
             'InputGraph',       { iChain_LevelSet() }, ...
             'ExpectedOutput',   { iChain_LevelSet_Expected() }), ...
             ...
+            'SkipEdge', struct( ...
+            'InputGraph',       { iSkipEdge() }, ...
+            'ExpectedOutput',   { iSkipEdge_Expected() }), ...
+            ...
             'SingleNode', struct( ...
             'InputGraph',       { iSingleNode() }, ...
             'ExpectedOutput',   { iSingleNode_Expected() }));
@@ -191,6 +195,25 @@ subGraphLevel   =  1:numNodes;
 expectedTable = iOutputTable(subGraphId, toSubGraphId, subGraphLevel);
 end
 
+function aGraph = iSkipEdge()
+% Sub-graph 3 depends on sub-graph 1 directly and through sub-graph 2, so it
+% is on the level after the longest path.
+J = [1, 1, 1, 2, 2, 3];
+I = [1, 2, 3, 2, 3, 3];
+V = ones(size(J));
+aGraph = amsla.common.DataStructure(I, J, V);
+aGraph.setSubGraphOfNode( ...
+    [1, 2, 3], ...
+    [1, 2, 3]);
+end
+
+function expectedTable = iSkipEdge_Expected()
+subGraphId      =  [1, 2, 3];
+toSubGraphId    =  {[2, 3], 3, iEmpty(0, 1)};
+subGraphLevel   =  [1, 2, 3];
+expectedTable = iOutputTable(subGraphId, toSubGraphId, subGraphLevel);
+end
+
 function aGraph = iSingleNode()
 J = 1;
 I = 1;
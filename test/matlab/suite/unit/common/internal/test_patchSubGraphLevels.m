@@ -0,0 +1,72 @@
+classdef test_patchSubGraphLevels < amsla.test.tools.AmslaTest
+    %TEST_PATCHSUBGRAPHLEVELS Tests for
+    %amsla.common.internal.patchSubGraphLevels
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        
+        SplitNodes = struct( ...
+            'First',  { 1 }, ...
+            'Middle', { [12, 30] }, ...
+            'Last',   { 60 });
+        
+    end
+    
+    %% TEST METHODS
+    
+    methods(Test)
+        
+        function patchedTableMatchesFullComputation(testCase, SplitNodes)
+            % Check that splitting the affected sub-graphs into one
+            % sub-graph per node and patching the table gives the same
+            % table as computing it again.
+            
+            aGraph = iAnalysedGraph();
+            oldTable = amsla.common.internal.findSubGraphLevels(aGraph);
+            
+            removedIds = amsla.common.internal.findAffectedSubGraphs(aGraph, SplitNodes);
+            addedIds = iSplitSubGraphs(aGraph, removedIds);
+            
+            actualTable = amsla.common.internal.patchSubGraphLevels(aGraph, ...
+                oldTable, removedIds, addedIds);
+            testCase.verifyEqual(actualTable, ...
+                amsla.common.internal.findSubGraphLevels(aGraph));
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+A = tril(sprand(60, 60, 0.05), -1) + 4*speye(60);
+end
+
+function aGraph = iAnalysedGraph()
+[I, J, V] = find(iMatrix());
+aGraph = amsla.common.DataStructure(I, J, V);
+amsla.test.tools.tasslAnalysis(aGraph, 8);
+end
+
+function addedIds = iSplitSubGraphs(aGraph, subGraphIds)
+% Give each node of the sub-graphs its own new sub-graph.
+nodeIds = aGraph.listOfNodes();
+subGraphs = aGraph.subGraphOfNode(nodeIds);
+isSplit = ismember(subGraphs, subGraphIds);
+addedIds = max(subGraphs) + (1:nnz(isSplit));
+aGraph.setSubGraphOfNode(nodeIds(isSplit), addedIds);
+end
@@ -0,0 +1,141 @@
+classdef test_readMatrixFile < amsla.test.tools.AmslaTest
+    %TEST_READMATRIXFILE Tests for amsla.common.internal.readMatrixFile
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        
+        ChunkSize = struct( ...
+            'OneElement',   { 1 }, ...
+            'SomeElements', { 7 }, ...
+            'WholeFile',    { 2^20 });
+        
+    end
+    
+    %% TEST METHODS
+    
+    methods(Test)
+        
+        function matrixMarketGivesLowerTriangle(testCase, ChunkSize)
+            % Check that reading a general Matrix Market file in chunks gives
+            % the lower triangle of the matrix.
+            
+            A = iMatrix();
+            fileName = iWriteMatrixMarket(testCase, A, "general");
+            
+            [rowPointer, columnIndex, values] = ...
+                amsla.common.internal.readMatrixFile(fileName, "ChunkSize", ChunkSize);
+            
+            testCase.verifyEqual(iSparseFromCompressedRows(rowPointer, columnIndex, values), ...
+                tril(A));
+        end
+        
+        function symmetricMatrixMarketGivesLowerTriangle(testCase, ChunkSize)
+            % Check that the elements of a symmetric Matrix Market file are
+            % all moved to the lower triangle.
+            
+            A = iMatrix();
+            fileName = iWriteMatrixMarket(testCase, triu(A+A'), "symmetric");
+            
+            [rowPointer, columnIndex, values] = ...
+                amsla.common.internal.readMatrixFile(fileName, "ChunkSize", ChunkSize);
+            
+            testCase.verifyEqual(iSparseFromCompressedRows(rowPointer, columnIndex, values), ...
+                tril(A+A'));
+        end
+        
+        function binaryDumpGivesLowerTriangle(testCase, ChunkSize)
+            % Check that reading a binary CSR dump in chunks gives the lower
+            % triangle of the matrix.
+            
+            A = iMatrix();
+            fileName = iWriteCompressedRows(testCase, A);
+            
+            [rowPointer, columnIndex, values] = ...
+                amsla.common.internal.readMatrixFile(fileName, "ChunkSize", ChunkSize);
+            
+            testCase.verifyEqual(iSparseFromCompressedRows(rowPointer, columnIndex, values), ...
+                tril(A));
+        end
+        
+        function matrixFromFileSolvesCorrectly(testCase)
+            % Check that a matrix created from a file gives the same
+            % solution as MATLAB's backslash, in all the formats.
+            
+            A = iMatrix();
+            L = tril(A) + speye(size(A));
+            fileName = iWriteMatrixMarket(testCase, L, "general");
+            rhs = ones(size(L, 1), 1);
+            
+            formats = ["csr", "levelSet", "tassl"];
+            analyseArguments = {{}, {}, {4}};
+            for k = 1:numel(formats)
+                format = formats(k);
+                matrix = amsla.SparseMatrix.fromFile(fileName, format, "ChunkSize", 5);
+                matrix = matrix.analyse(analyseArguments{k}{:});
+                
+                testCase.verifyEqual(matrix.solve(rhs), L\rhs, ...
+                    "AbsTol", 1e-10, ...
+                    "Wrong solution with a matrix read in format '" + format + "'.");
+            end
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+A = sprand(30, 30, 0.2) + 2*speye(30);
+end
+
+function A = iSparseFromCompressedRows(rowPointer, columnIndex, values)
+numRows = numel(rowPointer)-1;
+rowIndex = repelem((1:numRows)', diff(rowPointer));
+A = sparse(rowIndex, columnIndex, values, numRows, numRows);
+end
+
+function fileName = iWriteMatrixMarket(testCase, A, symmetry)
+% Write the matrix in a Matrix Market file, with the elements in random
+% order.
+
+fixture = testCase.applyFixture(matlab.unittest.fixtures.TemporaryFolderFixture);
+fileName = fullfile(fixture.Folder, "matrix.mtx");
+[I, J, V] = find(A);
+shuffle = randperm(numel(V));
+
+fileId = fopen(fileName, "w");
+fprintf(fileId, "%%%%MatrixMarket matrix coordinate real %s\n", symmetry);
+fprintf(fileId, "%% A comment\n");
+fprintf(fileId, "%d %d %d\n", size(A, 1), size(A, 2), numel(V));
+fprintf(fileId, "%d %d %.17g\n", [I(shuffle), J(shuffle), V(shuffle)]');
+fclose(fileId);
+end
+
+function fileName = iWriteCompressedRows(testCase, A)
+% Write the matrix in a binary CSR dump.
+
+fixture = testCase.applyFixture(matlab.unittest.fixtures.TemporaryFolderFixture);
+fileName = fullfile(fixture.Folder, "matrix.csr");
+[J, I, V] = find(A.');
+rowPointer = [0; cumsum(accumarray(I, 1, [size(A, 1), 1]))];
+
+fileId = fopen(fileName, "w", "ieee-le");
+fwrite(fileId, 'AMSLACSR', "char");
+fwrite(fileId, [size(A, 1); numel(V); rowPointer; J-1], "uint64");
+fwrite(fileId, V, "double");
+fclose(fileId);
+end
@@ -15,16 +15,24 @@ classdef test_DataStructure < amsla.test.tools.AmslaTest
     % See the License for the specific language governing permissions and
     % limitations under the License.
     
+    properties(TestParameter)
+        
+        Adjacency = struct( ...
+            'Eager', { "eager" }, ...
+            'Lazy',  { "lazy" });
+        
+    end
     
     methods (Test)
         
         %% "Graph API" for nodes and edges
         
-        function checkChildrenOfNodeVector(testCase)
+        function checkChildrenOfNodeVector(testCase, Adjacency)
             % Check the method "childrenOfNode" with a vector input.
             
             % Create a graph
-            [aGraph, ~, ~, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V, "Adjacency", Adjacency);
             
             nodes = 1:10;
             expectedOutput = {[2, 3], [], 6, 5, 6, [7, 8], [], [], 10, []};
@@ -67,11 +75,12 @@ classdef test_DataStructure < amsla.test.tools.AmslaTest
                 expectedOutput);
         end
         
-        function checkParentsOfNodeVector(testCase)
+        function checkParentsOfNodeVector(testCase, Adjacency)
             % Check the method "parentsOfNode" with a vector input.
             
             % Create a graph
-            [aGraph, ~, ~, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V, "Adjacency", Adjacency);
             
             nodes = 1:10;
             
@@ -82,11 +91,12 @@ classdef test_DataStructure < amsla.test.tools.AmslaTest
                 expectedOutput);
         end
         
-        function checkParentsOfNodeVectorWithDuplicates(testCase)
+        function checkParentsOfNodeVectorWithDuplicates(testCase, Adjacency)
             % Check the method "parentsOfNode" with a vector input and duplicates.
             
             % Create a graph
-            [aGraph, ~, ~, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V, "Adjacency", Adjacency);
             
             nodes = [6, 2, 6];
             
@@ -132,6 +142,71 @@ classdef test_DataStructure < amsla.test.tools.AmslaTest
         end
     end
     
+    properties(TestParameter)
+        
+        FrontierQuery = struct( ...
+            'Parents',  struct('Frontier', "parentsOfFrontier",  'PerNode', "parentsOfNode"), ...
+            'Children', struct('Frontier', "childrenOfFrontier", 'PerNode', "childrenOfNode"));
+        
+        Frontier = struct( ...
+            'Scalar',         { 6 }, ...
+            'Vector',         { 1:10 }, ...
+            'WithDuplicates', { [6, 2, 6, 1] }, ...
+            'Empty',          { zeros(1, 0) });
+        
+        AdjacencyLayout = struct( ...
+            'Eager',   { {"Adjacency", "eager"} }, ...
+            'Lazy',    { {"Adjacency", "lazy"} }, ...
+            'Compact', { {"Compact", true} });
+        
+    end
+    
+    methods(Test)
+        
+        function eagerAdjacencyMatchesLazyAdjacency(testCase, FrontierQuery)
+            % Check that computing parents and children on construction
+            % gives the same lists as computing them on request.
+            
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            eagerGraph = amsla.common.DataStructure(I, J, V, "Adjacency", "eager");
+            lazyGraph = amsla.common.DataStructure(I, J, V, "Adjacency", "lazy");
+            
+            allNodes = eagerGraph.listOfNodes();
+            testCase.verifyEqual( ...
+                eagerGraph.(FrontierQuery.PerNode)(allNodes), ...
+                lazyGraph.(FrontierQuery.PerNode)(allNodes), ...
+                "The eager and lazy adjacency lists differ.");
+            for nodeId = allNodes
+                testCase.verifyEqual( ...
+                    eagerGraph.(FrontierQuery.PerNode)(nodeId), ...
+                    lazyGraph.(FrontierQuery.PerNode)(nodeId), ...
+                    "The eager and lazy adjacency lists of a node differ.");
+            end
+        end
+        
+        function frontierQueriesMatchPerNodeQueries(testCase, FrontierQuery, Frontier, AdjacencyLayout)
+            % Check that the offsets-indices pair returned for a frontier
+            % matches the per-node queries, with all the layouts of the
+            % adjacency lists.
+            
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V, AdjacencyLayout{:});
+            
+            [offsets, nodeIds] = aGraph.(FrontierQuery.Frontier)(Frontier);
+            
+            testCase.verifySize(offsets, [numel(Frontier)+1, 1], ...
+                "There should be one offset per node, plus one.");
+            for k = 1:numel(Frontier)
+                expectedIds = aGraph.(FrontierQuery.PerNode)(Frontier(k));
+                actualIds = nodeIds(offsets(k):(offsets(k+1)-1));
+                testCase.verifyEqual(reshape(actualIds, 1, []), ...
+                    reshape(expectedIds, 1, []), ...
+                    "The nodes of the frontier are not what was expected.");
+            end
+        end
+        
+    end
+    
     properties(TestParameter)
         
         EdgeNodeAssignment = struct( ...
@@ -324,6 +399,82 @@ classdef test_DataStructure < amsla.test.tools.AmslaTest
                 "The time-slots in the 3rd sub-graph were not identified correctly.");
         end
     end
+    
+    %% Compact layout
+    methods(Test)
+        
+        function compactAdjacencyMatchesDefaultAdjacency(testCase, FrontierQuery)
+            % Check that the compact layout gives the same parents and
+            % children as the default layout.
+            
+            [defaultGraph, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            compactGraph = amsla.common.DataStructure(I, J, V, "Compact", true);
+            
+            allNodes = defaultGraph.listOfNodes();
+            testCase.verifyEqual( ...
+                compactGraph.(FrontierQuery.PerNode)(allNodes), ...
+                defaultGraph.(FrontierQuery.PerNode)(allNodes), ...
+                "The compact and default adjacency lists differ.");
+            for nodeId = allNodes
+                testCase.verifyEqual( ...
+                    compactGraph.(FrontierQuery.PerNode)(nodeId), ...
+                    defaultGraph.(FrontierQuery.PerNode)(nodeId), ...
+                    "The compact and default adjacency lists of a node differ.");
+            end
+        end
+        
+        function compactGraphStoresSubGraphsAndTimeSlots(testCase)
+            % Check that the compact layout returns the sub-graphs and
+            % time-slots it was given as doubles, null IDs included, even if
+            % they do not fit in its integer types.
+            
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            aGraph = amsla.common.DataStructure(I, J, V, "Compact", true);
+            
+            testCase.verifyEqual(aGraph.listOfNodes(), 1:10);
+            testCase.verifyEqual(aGraph.subGraphOfNode(1:3), iNullId(1, 3));
+            testCase.verifyEqual(aGraph.timeSlotOfEdge(1:3), iNullId(3, 1));
+            
+            subGraphs = [1, 1, 1, 2, 2, 3, 4, 4, 5, 5];
+            aGraph.setSubGraphOfNode(1:10, subGraphs);
+            testCase.verifyEqual(aGraph.subGraphOfNode(1:10), subGraphs);
+            testCase.verifyEqual(aGraph.listOfSubGraphs(), 1:5);
+            
+            timeSlots = [1; -2; iNullId(); 3];
+            aGraph.setTimeSlotOfEdge((1:4)', timeSlots);
+            testCase.verifyEqual(aGraph.timeSlotOfEdge((1:4)'), timeSlots);
+            testCase.verifyEqual(aGraph.edgesInSubGraphAndTimeSlot(1, -2), 2);
+            
+            aGraph.setSubGraphOfNode(1, 1e6);
+            aGraph.setTimeSlotOfEdge(1, 0.5);
+            testCase.verifyEqual(aGraph.subGraphOfNode(1:10), [1e6, subGraphs(2:end)], ...
+                "A sub-graph ID too large for the compact layout was not kept.");
+            testCase.verifyEqual(aGraph.timeSlotOfEdge((1:4)'), [0.5; timeSlots(2:end)], ...
+                "A time-slot ID that is not an integer was not kept.");
+        end
+        
+        function compactGraphUsesLessMemory(testCase)
+            % Check that the compact layout reports less memory than the
+            % default layout, and that every component is accounted for.
+            
+            rng('default');
+            A = tril(sprand(500, 500, 0.02)) + speye(500);
+            [I, J, V] = find(A);
+            defaultGraph = amsla.common.DataStructure(I, J, V);
+            compactGraph = amsla.common.DataStructure(I, J, V, "Compact", true);
+            
+            defaultFootprint = defaultGraph.memoryFootprint();
+            compactFootprint = compactGraph.memoryFootprint();
+            
+            testCase.verifyTrue(compactGraph.isCompact());
+            testCase.verifyFalse(defaultGraph.isCompact());
+            testCase.verifyEqual(compactFootprint.Component, defaultFootprint.Component);
+            testCase.verifyGreaterThan(compactFootprint.Bytes, 0);
+            testCase.verifyLessThan(sum(compactFootprint.Bytes), 0.6*sum(defaultFootprint.Bytes), ...
+                "The compact layout should use much less memory.");
+        end
+        
+    end
 end
 
 %% HELPER FUNCTIONS
@@ -342,8 +493,8 @@ aGraph.setSubGraphOfNode( ...
     [1, 1, 1, 2, 2, 3, 4, 4, 5, 5]);
 end
 
-function id = iNullId()
-id = amsla.common.nullId();
+function id = iNullId(varargin)
+id = amsla.common.nullId(varargin{:});
 end
 
 function ds = iSimpleMatrixLevelSetPartitioning(ds)
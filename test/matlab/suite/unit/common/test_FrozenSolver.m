@@ -0,0 +1,88 @@
+classdef test_FrozenSolver < amsla.test.tools.AmslaTest
+    %TEST_FROZENSOLVER Tests for amsla.common.FrozenSolver
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        
+        Format = struct( ...
+            'Csr',      { "csr" }, ...
+            'LevelSet', { "levelSet" }, ...
+            'Tassl',    { "tassl" });
+        
+    end
+    
+    %% TEST METHODS
+    
+    methods(Test)
+        
+        function frozenSolverMatchesMatrix(testCase, Format)
+            % Check that a frozen solver gives the same solutions and
+            % products as the matrix it was exported from.
+            
+            A = iMatrix();
+            matrix = iAnalysedMatrix(A, Format);
+            rhs = ones(size(A, 1), 2);
+            
+            frozen = matrix.freeze();
+            
+            testCase.verifyClass(frozen, ?amsla.common.FrozenSolver);
+            testCase.verifyEqual(frozen.solve(rhs), matrix.solve(rhs));
+            testCase.verifyEqual(frozen.solveTranspose(rhs), matrix.solveTranspose(rhs));
+            testCase.verifyEqual(frozen.multiply(rhs), matrix.spmv(rhs));
+        end
+        
+        function frozenSolverIgnoresLaterUpdates(testCase)
+            % Check that updating the values of the matrix after freezing it
+            % does not change the frozen solver.
+            
+            A = iMatrix();
+            matrix = iAnalysedMatrix(A, "tassl");
+            rhs = ones(size(A, 1), 1);
+            frozen = matrix.freeze();
+            
+            matrix = matrix.updateValues(2*A); %#ok<NASGU>
+            
+            testCase.verifyEqual(frozen.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-10, ...
+                "The frozen solver changed with the matrix.");
+        end
+        
+        function freezingRequiresAnalysis(testCase)
+            % Check that a matrix that was not analysed cannot be frozen.
+            
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            
+            testCase.verifyError(@() matrix.freeze(), "amsla:AnalysisRequired");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+A = tril(sprand(40, 40, 0.1)) + 4*speye(40);
+end
+
+function matrix = iAnalysedMatrix(A, format)
+matrix = amsla.SparseMatrix(A, format);
+if format=="tassl"
+    matrix = matrix.analyse(4);
+else
+    matrix = matrix.analyse();
+end
+end
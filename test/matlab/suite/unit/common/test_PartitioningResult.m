@@ -0,0 +1,97 @@
+classdef test_PartitioningResult < amsla.test.tools.AmslaTest
+    %TEST_PARTITIONINGRESULT Tests for the class
+    %amsla.common.PartitioningResult.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        AnalysisAlgorithm = struct( ...
+            'LevelSet', { @(ds) amsla.test.tools.levelSetAnalysis(ds) }, ...
+            'Tassl',    { @(ds) amsla.test.tools.tasslAnalysis(ds, 3) });
+    end
+    
+    methods(Test)
+        
+        function resultWithoutStatisticsIsEmpty(testCase)
+            % Check that a result created without a data structure has no
+            % sub-graphs.
+            
+            result = amsla.common.PartitioningResult(true);
+            
+            testCase.verifyTrue(result.WasPartitioned);
+            testCase.verifyEqual(result.NumSubGraphs, 0);
+            testCase.verifyEqual(result.NumLevels, 0);
+            testCase.verifyEqual(result.CriticalPathLength, 0);
+        end
+        
+        function subGraphStatisticsMatchDataStructure(testCase, AnalysisAlgorithm)
+            % Check the number and the sizes of the sub-graphs.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            result = amsla.common.PartitioningResult(true, aGraph, levelsTable);
+            
+            subGraphIds = reshape(aGraph.listOfSubGraphs(), [], 1);
+            testCase.verifyEqual(result.SubGraphIds, subGraphIds);
+            for k = 1:numel(subGraphIds)
+                testCase.verifyEqual(result.SubGraphSizes(k), ...
+                    nnz(aGraph.subGraphOfNode(aGraph.listOfNodes())==subGraphIds(k)), ...
+                    "Wrong size of a sub-graph.");
+                testCase.verifyEqual(result.TimeSlotsPerSubGraph(k), ...
+                    numel(aGraph.timeSlotsInSubGraph(subGraphIds(k))), ...
+                    "Wrong number of time-slots of a sub-graph.");
+            end
+            testCase.verifyEqual(sum(result.SubGraphSizeHistogram.Count), result.NumSubGraphs, ...
+                "The histogram should count every sub-graph once.");
+        end
+        
+        function levelStatisticsMatchLevelsTable(testCase, AnalysisAlgorithm)
+            % Check the statistics of the sub-graph levels.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            result = amsla.common.PartitioningResult(true, aGraph, levelsTable);
+            
+            testCase.verifyEqual(result.NumLevels, max(levelsTable.SubGraphLevel));
+            testCase.verifyEqual(sum(result.ParallelismPerLevel), result.NumSubGraphs);
+            testCase.verifyEqual(result.AverageParallelism, result.NumSubGraphs/result.NumLevels);
+            testCase.verifyGreaterThanOrEqual(result.CriticalPathLength, max(result.TimeSlotsPerSubGraph));
+            testCase.verifyLessThanOrEqual(result.CriticalPathLength, sum(result.TimeSlotsPerSubGraph));
+            [~, levelPosition] = ismember(result.SubGraphIds, levelsTable.SubGraphId);
+            testCase.verifyEqual(result.LevelOfSubGraph, levelsTable.SubGraphLevel(levelPosition));
+        end
+        
+        function externalEdgesAreCounted(testCase, AnalysisAlgorithm)
+            % Check the number of edges between different sub-graphs.
+            
+            [aGraph, levelsTable] = iAnalysedSimpleGraph(AnalysisAlgorithm);
+            result = amsla.common.PartitioningResult(true, aGraph, levelsTable);
+            
+            edgeIds = aGraph.listOfEdges();
+            rowSubGraphs = aGraph.subGraphOfNode(aGraph.exitingNodeOfEdge(edgeIds));
+            columnSubGraphs = aGraph.subGraphOfNode(aGraph.enteringNodeOfEdge(edgeIds));
+            testCase.verifyEqual(result.NumExternalEdges, nnz(rowSubGraphs~=columnSubGraphs));
+            testCase.verifyEqual(sum(result.ExternalEdgesPerSubGraph), result.NumExternalEdges);
+            testCase.verifyEqual(sum(result.EdgesPerSubGraph), numel(edgeIds));
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function [aGraph, levelsTable] = iAnalysedSimpleGraph(analysisAlgorithm)
+[aGraph, ~, ~, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+analysisAlgorithm(aGraph);
+levelsTable = amsla.common.internal.findSubGraphLevels(aGraph);
+end
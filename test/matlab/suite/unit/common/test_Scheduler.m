@@ -56,6 +56,35 @@ classdef test_Scheduler < amsla.test.tools.AmslaTest
         
     end
     
+    methods(Test)
+        
+        function parallelSchedulingMatchesSerial(testCase)
+            % Check that scheduling the sub-graphs concurrently assigns the
+            % same time-slots as scheduling them one at a time.
+            
+            rng('default');
+            W = gallery('wathen', 3, 3);
+            [I, J, V] = find(tril(W) + speye(size(W)));
+            serialGraph = amsla.common.DataStructure(I, J, V);
+            parallelGraph = amsla.common.DataStructure(I, J, V);
+            partitioner = amsla.tassl.Partitioner(serialGraph, 10);
+            partitioner.partition();
+            allNodes = serialGraph.listOfNodes();
+            parallelGraph.setSubGraphOfNode(allNodes, serialGraph.subGraphOfNode(allNodes));
+            
+            serialScheduler = amsla.common.Scheduler(serialGraph);
+            serialScheduler.scheduleOperations();
+            parallelScheduler = amsla.common.Scheduler(parallelGraph, "UseParallel", true);
+            parallelScheduler.scheduleOperations();
+            
+            allEdges = serialGraph.listOfEdges();
+            testCase.verifyEqual(parallelGraph.timeSlotOfEdge(allEdges), ...
+                serialGraph.timeSlotOfEdge(allEdges), ...
+                "The parallel scheduling does not match the serial one.");
+        end
+        
+    end
+    
     %% HELPER METHODS
     
     methods(Access=private)
@@ -0,0 +1,143 @@
+classdef test_Tracer < amsla.test.tools.AmslaTest
+    %TEST_TRACER Tests for amsla.common.Tracer
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% TEST METHODS
+    
+    methods(TestMethodSetup)
+        
+        function stopTracingAfterEachTest(testCase)
+            testCase.addTeardown(@() amsla.common.Tracer.stop());
+        end
+        
+    end
+    
+    methods(Test)
+        
+        function nothingIsRecordedWhenNotTracing(testCase)
+            % Check that the analysis and the solve record no events when
+            % the tracer was stopped.
+            
+            amsla.common.Tracer.start();
+            amsla.common.Tracer.stop();
+            
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            matrix = matrix.analyse(4);
+            matrix.solve(ones(40, 1));
+            
+            testCase.verifyFalse(amsla.common.Tracer.isEnabled());
+            testCase.verifyEmpty(amsla.common.Tracer.timestamp());
+            testCase.verifyEqual(height(amsla.common.Tracer.events()), 0);
+        end
+        
+        function phasesOfAnalysisAndSolveAreRecorded(testCase)
+            % Check that the phases of the TASSL analysis, the solve and
+            % the counters of the inner loops are recorded.
+            
+            amsla.common.Tracer.start();
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            matrix = matrix.analyse(4);
+            matrix.solve(ones(40, 1));
+            amsla.common.Tracer.stop();
+            
+            eventTable = amsla.common.Tracer.events();
+            expectedSpans = ["analyse", "partition", "componentDiscovery", ...
+                "mergeComponents", "partitionComponents", "partitionComponent", ...
+                "schedule", "findSubGraphLevels", "compilePlan", "solve"];
+            testCase.verifyTrue(all(ismember(expectedSpans, ...
+                eventTable.Name(eventTable.Type=="span"))), ...
+                "Some phases were not recorded.");
+            expectedCounters = ["bfsIterations", "bfsFrontierSize", "edgesPerTimeSlot"];
+            testCase.verifyTrue(all(ismember(expectedCounters, ...
+                eventTable.Name(eventTable.Type=="counter"))), ...
+                "Some counters were not recorded.");
+            testCase.verifyTrue(all(eventTable.Duration>=0));
+        end
+        
+        function levelsOfMatlabSolveAreRecorded(testCase)
+            % Check that the MATLAB implementation records one span per
+            % sub-graph level.
+            
+            [I, J, V] = find(iMatrix());
+            aGraph = amsla.common.DataStructure(I, J, V);
+            amsla.test.tools.tasslAnalysis(aGraph, 4);
+            solver = amsla.common.TriangularSolver(aGraph, "Backend", "matlab");
+            subGraphLevelsTable = amsla.common.internal.findSubGraphLevels(aGraph);
+            numLevels = max(subGraphLevelsTable.SubGraphLevel);
+            
+            amsla.common.Tracer.start();
+            solver.solve(ones(40, 1));
+            amsla.common.Tracer.stop();
+            
+            summaryTable = amsla.common.Tracer.summary();
+            testCase.verifyEqual(summaryTable.Count(summaryTable.Name=="solveLevel"), numLevels);
+            testCase.verifyEqual(summaryTable.Count(summaryTable.Name=="solve"), 1);
+        end
+        
+        function countersAreSummedInSummary(testCase)
+            % Check that the summary adds up the samples of a counter.
+            
+            amsla.common.Tracer.start();
+            amsla.common.Tracer.count("aCounter", [3, 1, 2]);
+            amsla.common.Tracer.span("aSpan", amsla.common.Tracer.timestamp());
+            amsla.common.Tracer.stop();
+            
+            summaryTable = amsla.common.Tracer.summary();
+            isCounter = summaryTable.Name=="aCounter";
+            testCase.verifyEqual(summaryTable.Type(isCounter), "counter");
+            testCase.verifyEqual(summaryTable.Count(isCounter), 3);
+            testCase.verifyEqual(summaryTable.Total(isCounter), 6);
+            testCase.verifyEqual(summaryTable.Maximum(isCounter), 3);
+            testCase.verifyEqual(summaryTable.Count(summaryTable.Name=="aSpan"), 1);
+        end
+        
+        function exportWritesChromeTrace(testCase)
+            % Check that the exported file is a Chrome trace with one
+            % complete event per span and one counter event per sample.
+            
+            amsla.common.Tracer.start();
+            amsla.common.Tracer.span("aSpan", amsla.common.Tracer.timestamp(), ...
+                struct("level", 2));
+            amsla.common.Tracer.count("aCounter", [4, 5]);
+            amsla.common.Tracer.stop();
+            
+            fixture = testCase.applyFixture(matlab.unittest.fixtures.TemporaryFolderFixture);
+            fileName = fullfile(fixture.Folder, "trace.json");
+            amsla.common.Tracer.export(fileName);
+            
+            trace = jsondecode(fileread(fileName));
+            traceEvents = trace.traceEvents;
+            if ~iscell(traceEvents)
+                traceEvents = num2cell(traceEvents);
+            end
+            phases = string(cellfun(@(e) e.ph, traceEvents, 'UniformOutput', false));
+            testCase.verifyEqual(nnz(phases=="X"), 1);
+            testCase.verifyEqual(nnz(phases=="C"), 2);
+            spanEvent = traceEvents{phases=="X"};
+            testCase.verifyEqual(spanEvent.name, 'aSpan');
+            testCase.verifyEqual(spanEvent.args.level, 2);
+            testCase.verifyGreaterThanOrEqual(spanEvent.dur, 0);
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+A = tril(sprand(40, 40, 0.1)) + 4*speye(40);
+end
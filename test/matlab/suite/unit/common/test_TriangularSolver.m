@@ -59,6 +59,382 @@ classdef test_TriangularSolver < amsla.test.tools.AmslaTest
         end
     end
     
+    % Native kernel
+    
+    methods(Test)
+        function nativeKernelMatchesMatlabImplementation(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that the native kernel, if it has been built, gives the
+            % same output as the MATLAB implementation.
+            
+            testCase.assumeTrue( ...
+                amsla.common.internal.hasNativeKernel("forwardSubstitutionMex"), ...
+                "The native kernel has not been built.");
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            rhs = ones(size(GalleryMatrix, 1), 1);
+            
+            matlabSolver = amsla.common.TriangularSolver(dataStructure, "Backend", "matlab");
+            nativeSolver = amsla.common.TriangularSolver(dataStructure, "Backend", "native");
+            expectedOutput = matlabSolver.solve(rhs);
+            actualOutput = nativeSolver.solve(rhs);
+            
+            absTol = amsla.test.tools.computeTolerance("Absolute", ...
+                @(A, x) nnz(A)*norm(x, Inf), GalleryMatrix, expectedOutput);
+            relTol = amsla.test.tools.computeTolerance("Relative", ...
+                @(A) 10*size(A, 1), GalleryMatrix);
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", absTol, ...
+                "RelTol", relTol, ...
+                "The native kernel does not match the MATLAB implementation.");
+        end
+    end
+    
+    methods(Test)
+        function multiThreadedNativeKernelMatchesSingleThreaded(testCase, GalleryMatrix)
+            % Check that executing the sub-graphs of each level on
+            % multiple threads gives the same output as a single thread.
+            
+            testCase.assumeTrue( ...
+                amsla.common.internal.hasNativeKernel("forwardSubstitutionMex"), ...
+                "The native kernel has not been built.");
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            amsla.test.tools.tasslAnalysis(dataStructure, 3);
+            rhs = ones(size(GalleryMatrix, 1), 1);
+            
+            singleThreadSolver = amsla.common.TriangularSolver(dataStructure, ...
+                "Backend", "native", "NumThreads", 1);
+            multiThreadSolver = amsla.common.TriangularSolver(dataStructure, ...
+                "Backend", "native", "NumThreads", 4);
+            
+            testCase.verifyEqual(multiThreadSolver.solve(rhs), singleThreadSolver.solve(rhs), ...
+                "The multi-threaded output does not match the single-threaded one.");
+        end
+        
+        function dependencyDrivenKernelMatchesLevels(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that following the dependencies between the sub-graphs
+            % on multiple threads gives the same output as executing one
+            % level at a time.
+            
+            testCase.assumeTrue( ...
+                amsla.common.internal.hasNativeKernel("forwardSubstitutionMex"), ...
+                "The native kernel has not been built.");
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            rhs = ones(size(GalleryMatrix, 1), 3);
+            
+            levelSolver = amsla.common.TriangularSolver(dataStructure, ...
+                "Backend", "native", "NumThreads", 1);
+            dependencySolver = amsla.common.TriangularSolver(dataStructure, ...
+                "Backend", "native", "NumThreads", 4, "Execution", "dependencies");
+            
+            testCase.verifyEqual(dependencySolver.solve(rhs), levelSolver.solve(rhs), ...
+                "Following the dependencies does not match executing the levels.");
+        end
+    end
+    
+    % GPU backend
+    
+    methods(Test)
+        function gpuBackendMatchesBackslash(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that solving on the GPU, if there is one, gives the
+            % same output as MATLAB's backslash.
+            
+            testCase.assumeTrue(exist("canUseGPU", "file")==2 && canUseGPU(), ...
+                "There is no GPU that MATLAB can use.");
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            
+            rng('default');
+            rhs = rand(size(GalleryMatrix, 1), 2);
+            expectedOutput = GalleryMatrix\rhs;
+            
+            solver = amsla.common.TriangularSolver(dataStructure, "Backend", "gpu");
+            testCase.verifyEqual(solver.solve(rhs), expectedOutput, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve' on the GPU.");
+            testCase.verifyClass(solver.solve(gpuArray(rhs)), 'gpuArray', ...
+                "The output should stay on the GPU.");
+        end
+    end
+    
+    % Multiple right-hand sides
+    
+    methods(Test)
+        function blockOfRightHandSides(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that a block of right-hand sides is solved in one call,
+            % with the same output as MATLAB's backslash.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            
+            rng('default');
+            rhs = rand(size(GalleryMatrix, 1), 8);
+            expectedOutput = GalleryMatrix\rhs;
+            
+            solver = amsla.common.TriangularSolver(dataStructure);
+            actualOutput = solver.solve(rhs);
+            
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve' with multiple right-hand sides.");
+        end
+    end
+    
+    % Transposed systems
+    
+    properties(TestParameter)
+        NumRightHandSides = struct("One", 1, "Block", 4);
+    end
+    
+    methods(Test)
+        function transposeMatchesBackslash(testCase, GalleryMatrix, AnalysisAlgorithm, NumRightHandSides)
+            % Check that the transposed system is solved with the same
+            % analysis, with the same output as MATLAB's backslash.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            
+            rng('default');
+            rhs = rand(size(GalleryMatrix, 1), NumRightHandSides);
+            expectedOutput = GalleryMatrix'\rhs;
+            
+            solver = amsla.common.TriangularSolver(dataStructure);
+            actualOutput = solver.solveTranspose(rhs);
+            
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solveTranspose'.");
+        end
+    end
+    
+    % Dense blocks
+    
+    methods(Test)
+        function denseBlocksUseMatlabImplementation(testCase)
+            % Check that a solver with dense blocks uses the MATLAB
+            % implementation with the default backend, which records one
+            % span per sub-graph level, and gives the output of MATLAB's
+            % backslash.
+            
+            testCase.addTeardown(@() amsla.common.Tracer.stop());
+            A = iTriangular(iWathen(2, 1));
+            [I, J, V] = find(A);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            amsla.test.tools.levelSetAnalysis(dataStructure);
+            solver = amsla.common.TriangularSolver(dataStructure, "DenseBlocks", true);
+            rhs = ones(size(A, 1), 1);
+            
+            amsla.common.Tracer.start();
+            actualOutput = solver.solve(rhs);
+            amsla.common.Tracer.stop();
+            
+            summaryTable = amsla.common.Tracer.summary();
+            testCase.verifyTrue(any(summaryTable.Name=="solveLevel"), ...
+                "The dense blocks were not executed by the MATLAB implementation.");
+            testCase.verifyEqual(actualOutput, A\rhs, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve' with dense blocks.");
+        end
+        
+        function nativeKernelRejectsDenseBlocks(testCase)
+            % Check that the native backend cannot be requested together
+            % with dense blocks.
+            
+            testCase.assumeTrue( ...
+                amsla.common.internal.hasNativeKernel("forwardSubstitutionMex"), ...
+                "The native kernel has not been built.");
+            
+            [dataStructure, ~, ~, ~] = ...
+                amsla.test.tools.getSimpleLowerTriangularMatrix();
+            amsla.test.tools.levelSetAnalysis(dataStructure);
+            
+            testCase.verifyError( ...
+                @() amsla.common.TriangularSolver(dataStructure, ...
+                "Backend", "native", "DenseBlocks", true), ...
+                "amsla:TriangularSolver:nativeDenseBlocks");
+        end
+    end
+    
+    % Renumbered rows
+    
+    methods(Test)
+        function reorderedSolverMatchesBackslash(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that renumbering the rows of the plan is transparent to
+            % the solve and to the product.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            
+            rng('default');
+            rhs = rand(size(GalleryMatrix, 1), 2);
+            
+            solver = amsla.common.TriangularSolver(dataStructure, "Reorder", true);
+            testCase.verifyEqual(solver.solve(rhs), GalleryMatrix\rhs, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve' after renumbering.");
+            testCase.verifyEqual(solver.solveTranspose(rhs), GalleryMatrix'\rhs, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solveTranspose' after renumbering.");
+            testCase.verifyEqual(solver.multiply(rhs), full(GalleryMatrix*rhs), ...
+                "AbsTol", iProductTolerance(GalleryMatrix, rhs), ...
+                "Wrong output of method 'multiply' after renumbering.");
+        end
+    end
+    
+    % Matrix-vector products
+    
+    methods(Test)
+        function productMatchesMtimes(testCase, GalleryMatrix, AnalysisAlgorithm, NumRightHandSides)
+            % Check that the product computed from the solve plan is the
+            % same as MATLAB's product.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            
+            rng('default');
+            x = rand(size(GalleryMatrix, 1), NumRightHandSides);
+            
+            solver = amsla.common.TriangularSolver(dataStructure);
+            testCase.verifyEqual(solver.multiply(x), full(GalleryMatrix*x), ...
+                "AbsTol", iProductTolerance(GalleryMatrix, x), ...
+                "Wrong output of method 'multiply'.");
+        end
+        
+        function productIncludesUnitDiagonal(testCase)
+            % Check that the unit diagonal elements that were never
+            % scheduled take part in the product.
+            
+            [dataStructure, I, J, V] = ...
+                amsla.test.tools.getSimpleLowerTriangularMatrix();
+            amsla.test.tools.levelSetAnalysis(dataStructure);
+            solver = amsla.common.TriangularSolver(dataStructure);
+            
+            x = (1:max(I))';
+            testCase.verifyEqual(solver.multiply(x), full(sparse(I, J, V)*x), ...
+                "AbsTol", 1e-12, ...
+                "Wrong output of method 'multiply' with a unit diagonal.");
+        end
+        
+        function productUsesStoredDiagonal(testCase)
+            % Check that the product multiplies by the weights of the
+            % diagonal as they are stored, and not by the reciprocal of
+            % their reciprocal, so that it is exact for a diagonal matrix.
+            
+            numRows = 100;
+            rng('default');
+            diagonal = 1 + rand(numRows, 1);
+            dataStructure = amsla.common.DataStructure(1:numRows, 1:numRows, diagonal);
+            amsla.test.tools.levelSetAnalysis(dataStructure);
+            x = rand(numRows, 1);
+            
+            solver = amsla.common.TriangularSolver(dataStructure);
+            testCase.verifyEqual(solver.multiply(x), diagonal.*x, ...
+                "The product does not use the weights of the diagonal.");
+            singleSolver = amsla.common.TriangularSolver(dataStructure, "Precision", "single");
+            testCase.verifyEqual(singleSolver.multiply(x), double(single(diagonal)).*x, ...
+                "The product does not use the single-precision weights of the diagonal.");
+        end
+    end
+    
+    % Single and mixed precision
+    
+    properties(TestParameter)
+        Precision = struct( ...
+            "Single",   { struct("Name", "single", "OutputClass", "single") }, ...
+            "Mixed",    { struct("Name", "mixed", "OutputClass", "double") });
+    end
+    
+    methods(Test)
+        function reducedPrecisionMatchesBackslash(testCase, GalleryMatrix, AnalysisAlgorithm, Precision)
+            % Check that solving with single-precision values gives the
+            % solution of MATLAB's backslash, up to the single-precision
+            % tolerance, with the expected class.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            rhs = ones(size(GalleryMatrix, 1), 1);
+            
+            solver = amsla.common.TriangularSolver(dataStructure, ...
+                "Precision", Precision.Name);
+            actualOutput = solver.solve(rhs);
+            expectedOutput = cast(GalleryMatrix\rhs, Precision.OutputClass);
+            
+            testCase.verifyClass(actualOutput, Precision.OutputClass, ...
+                "The solution does not have the class of the precision.");
+            absTol = amsla.test.tools.computeTolerance("Absolute", ...
+                @(x, A) nnz(A)*norm(x, Inf), single(expectedOutput), GalleryMatrix);
+            relTol = amsla.test.tools.computeTolerance("Relative", ...
+                @(x, A) 10*size(A, 1), single(expectedOutput), GalleryMatrix);
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", cast(absTol, Precision.OutputClass), ...
+                "RelTol", cast(relTol, Precision.OutputClass), ...
+                "Wrong output of method 'solve' in " + Precision.Name + " precision.");
+        end
+    end
+    
+    % Changing the values of the matrix
+    
+    methods(Test)
+        function updatedValuesMatchBackslash(testCase, GalleryMatrix, AnalysisAlgorithm)
+            % Check that changing the values of the matrix after the solver
+            % has been created gives the same output as MATLAB's backslash
+            % on the new matrix.
+            
+            [I, J, V] = find(GalleryMatrix);
+            dataStructure = amsla.common.DataStructure(I, J, V);
+            AnalysisAlgorithm(dataStructure);
+            solver = amsla.common.TriangularSolver(dataStructure);
+            
+            edgeIds = dataStructure.listOfEdges();
+            rows = dataStructure.exitingNodeOfEdge(edgeIds);
+            columns = dataStructure.enteringNodeOfEdge(edgeIds);
+            rng('default');
+            newWeights = dataStructure.weightOfEdge(edgeIds).*(1+rand(numel(edgeIds), 1));
+            solver = solver.updateValues(newWeights);
+            
+            rhs = ones(size(GalleryMatrix, 1), 1);
+            expectedOutput = sparse(rows, columns, newWeights)\rhs;
+            testCase.verifyEqual(solver.solve(rhs), expectedOutput, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve' after changing the values.");
+        end
+        
+        function unitDiagonalCannotBeUpdated(testCase)
+            % Check that the unit diagonal elements that were never
+            % scheduled cannot be changed.
+            
+            [dataStructure, ~, ~, V] = ...
+                amsla.test.tools.getSimpleLowerTriangularMatrix();
+            amsla.test.tools.levelSetAnalysis(dataStructure);
+            solver = amsla.common.TriangularSolver(dataStructure);
+            
+            newWeights = ones(numel(V), 1);
+            newWeights(dataStructure.loopEdgesOfNode(1)) = 2;
+            testCase.verifyError(@() solver.updateValues(newWeights), ...
+                "amsla:SolvePlan:unitDiagonalChanged");
+        end
+    end
+    
     %% PRIVATE METHODS
     
     methods(Access=private)
@@ -83,6 +459,14 @@ end
 
 %% HELPER FUNCTIONS
 
+function tol = iProductTolerance(A, x)
+% Bound on the rounding error of each element of A*x, whatever the order of
+% the sums.
+numPerRow = full(max(sum(A~=0, 2)));
+tol = amsla.test.tools.computeTolerance("Absolute", ...
+    @(x, A) numPerRow*full(abs(A)*abs(x)), x, A);
+end
+
 function outData = iTriangular(inData)
 outData = tril(inData)+speye(size(inData));
 end
@@ -0,0 +1,244 @@
+classdef test_DataStructure < amsla.test.tools.AmslaTest
+    %TEST_DATASTRUCTURE Tests for class amsla.csr.DataStructure
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    %% "Graph API" for nodes and edges
+    
+    properties(TestParameter)
+        
+        NodeQuery = { ...
+            "childrenOfNode", ...
+            "parentsOfNode", ...
+            "exitingEdgesOfNode", ...
+            "enteringEdgesOfNode", ...
+            "loopEdgesOfNode"};
+        
+        EdgeQuery = { ...
+            "exitingNodeOfEdge", ...
+            "enteringNodeOfEdge", ...
+            "weightOfEdge", ...
+            "timeSlotOfEdge"};
+        
+        NodeInput = struct( ...
+            'Scalar',         { 6 }, ...
+            'Vector',         { 1:10 }, ...
+            'WithDuplicates', { [6, 2, 6] });
+        
+        EdgeInput = struct( ...
+            'Scalar',         { 1 }, ...
+            'Vector',         { [1, 3, 5] }, ...
+            'WithDuplicates', { [3, 2, 2, 10, 5, 4] });
+        
+    end
+    
+    methods(Test)
+        
+        function nodeQueriesMatchCommonDataStructure(testCase, NodeQuery, NodeInput)
+            % Check that node queries return the same output as
+            % amsla.common.DataStructure.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            
+            testCase.verifyEqual( ...
+                actualGraph.(NodeQuery)(NodeInput), ...
+                expectedGraph.(NodeQuery)(NodeInput), ...
+                "The output of '" + NodeQuery + "' is not what was expected.");
+        end
+        
+        function edgeQueriesMatchCommonDataStructure(testCase, EdgeQuery, EdgeInput)
+            % Check that edge queries return the same output as
+            % amsla.common.DataStructure.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            
+            testCase.verifyEqual( ...
+                actualGraph.(EdgeQuery)(EdgeInput), ...
+                expectedGraph.(EdgeQuery)(EdgeInput), ...
+                "The output of '" + EdgeQuery + "' is not what was expected.");
+        end
+        
+        function frontierQueriesMatchCommonDataStructure(testCase, NodeInput)
+            % Check that frontier queries return the same output as
+            % amsla.common.DataStructure.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            
+            for query = ["parentsOfFrontier", "childrenOfFrontier"]
+                [expectedOffsets, expectedIds] = expectedGraph.(query)(NodeInput);
+                [actualOffsets, actualIds] = actualGraph.(query)(NodeInput);
+                testCase.verifyEqual(actualOffsets, expectedOffsets, ...
+                    "The offsets of '" + query + "' are not what was expected.");
+                testCase.verifyEqual(actualIds, expectedIds, ...
+                    "The nodes of '" + query + "' are not what was expected.");
+            end
+        end
+        
+        function listsOfNodesAndEdgesMatchCommonDataStructure(testCase)
+            % Check the lists of all the nodes and edges in the graph.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            
+            testCase.verifyEqual(actualGraph.listOfNodes(), expectedGraph.listOfNodes(), ...
+                "The list of nodes is not what was expected.");
+            testCase.verifyEqual(actualGraph.listOfEdges(), expectedGraph.listOfEdges(), ...
+                "The list of edges is not what was expected.");
+        end
+        
+        function edgesAreSortedByRowAndColumn(testCase)
+            % Check that the edge IDs follow the order of the entries
+            % sorted by row and then by column, independently of the order
+            % of the inputs.
+            
+            [~, I, J, ~] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            V = 1:numel(I);
+            shuffler = numel(I):-1:1;
+            aGraph = amsla.csr.DataStructure(I(shuffler), J(shuffler), V(shuffler));
+            
+            [sortedEdges, sorter] = sortrows([I', J']);
+            edgeIds = aGraph.listOfEdges();
+            testCase.verifyEqual(aGraph.exitingNodeOfEdge(edgeIds), sortedEdges(:, 1)', ...
+                "The rows of the edges are not sorted.");
+            testCase.verifyEqual(aGraph.enteringNodeOfEdge(edgeIds), sortedEdges(:, 2)', ...
+                "The columns of the edges are not sorted.");
+            testCase.verifyEqual(aGraph.weightOfEdge(edgeIds), V(sorter)', ...
+                "The weights do not follow the edges.");
+        end
+        
+    end
+    
+    %% Sub-graph and time-slot API
+    
+    methods(Test)
+        
+        function listOfSubGraphsShouldBeEmptyIfNotAllNodesAreAssigned(testCase)
+            % The method "listOfSubGraph" should return an empty array if
+            % not all nodes have been assigned.
+            
+            [~, aGraph] = iSimpleGraphs();
+            aGraph.setSubGraphOfNode(1:9, 1);
+            
+            testCase.verifyEmpty(aGraph.listOfSubGraphs(), ...
+                "The list of sub-graphs should be empty when at least one node is not assigned.");
+        end
+        
+        function nodesOutsideTheGraphCannotBeAssigned(testCase)
+            % Check that assigning a node that is not in the graph to a
+            % sub-graph throws an error and leaves the graph unchanged, as
+            % in amsla.common.DataStructure.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            
+            testCase.verifyThrowsError( ...
+                @() expectedGraph.setSubGraphOfNode([1, 11], 1));
+            testCase.verifyError( ...
+                @() actualGraph.setSubGraphOfNode([1, 11], 1), ...
+                "amsla:csr:DataStructure:nodeNotInGraph");
+            testCase.verifyError( ...
+                @() actualGraph.setSubGraphOfNode(0, 1), ...
+                "amsla:csr:DataStructure:nodeNotInGraph");
+            testCase.verifyTrue(all(amsla.common.isNullId(actualGraph.subGraphOfNode(1:10))), ...
+                "The sub-graphs of the nodes changed after the error.");
+        end
+        
+        function subGraphsMatchCommonDataStructure(testCase)
+            % Check the list of sub-graphs and their sizes.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            cellfun(@iSimpleMatrixLevelSetPartitioning, {expectedGraph, actualGraph});
+            
+            [expectedIds, expectedSizes] = expectedGraph.listOfSubGraphs();
+            [actualIds, actualSizes] = actualGraph.listOfSubGraphs();
+            testCase.verifyEqual(actualIds, expectedIds, ...
+                "The list of sub-graphs is incorrect.");
+            testCase.verifyEqual(actualSizes, expectedSizes, ...
+                "The size of the sub-graphs is incorrect.");
+            testCase.verifyEqual( ...
+                actualGraph.subGraphOfNode(1:10), ...
+                expectedGraph.subGraphOfNode(1:10), ...
+                "The sub-graphs of the nodes are incorrect.");
+        end
+        
+        function timeSlotsMatchCommonDataStructure(testCase)
+            % Check the time-slots and the edges in each sub-graph after a
+            % complete analysis.
+            
+            [expectedGraph, actualGraph] = iSimpleGraphs();
+            cellfun(@amsla.test.tools.levelSetAnalysis, {expectedGraph, actualGraph});
+            
+            testCase.verifyEqual(actualGraph.listOfTimeSlots(), expectedGraph.listOfTimeSlots(), ...
+                "The list of time-slots is incorrect.");
+            for subGraphId = expectedGraph.listOfSubGraphs()
+                timeSlotIds = expectedGraph.timeSlotsInSubGraph(subGraphId);
+                testCase.verifyEqual( ...
+                    actualGraph.timeSlotsInSubGraph(subGraphId), timeSlotIds, ...
+                    "The time-slots in a sub-graph are incorrect.");
+                for timeSlotId = reshape(timeSlotIds, 1, [])
+                    testCase.verifyEqual( ...
+                        actualGraph.edgesInSubGraphAndTimeSlot(subGraphId, timeSlotId), ...
+                        expectedGraph.edgesInSubGraphAndTimeSlot(subGraphId, timeSlotId), ...
+                        "The edges in a sub-graph and time-slot are incorrect.");
+                end
+            end
+        end
+        
+    end
+    
+    %% Linear systems
+    
+    properties(TestParameter)
+        GalleryMatrix = struct( ...
+            "Wathen",   iTriangular(gallery("wathen", 2, 1)), ...
+            "Neumann",  iTriangular(gallery("neumann", 64)));
+    end
+    
+    methods(Test)
+        
+        function sparseMatrixSolvesLinearSystems(testCase, GalleryMatrix)
+            % Check that a sparse matrix in the "csr" format solves linear
+            % systems correctly.
+            
+            rhs = ones(size(GalleryMatrix, 1), 1);
+            expectedOutput = GalleryMatrix\rhs;
+            
+            aMatrix = amsla.SparseMatrix(GalleryMatrix, "csr");
+            aMatrix = aMatrix.analyse();
+            actualOutput = aMatrix.solve(rhs);
+            
+            testCase.verifyEqual(actualOutput, expectedOutput, ...
+                "AbsTol", 1e-7, ...
+                "RelTol", 1e-6,  ...
+                "Wrong output of method 'solve'.");
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function [commonGraph, csrGraph] = iSimpleGraphs()
+[commonGraph, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+csrGraph = amsla.csr.DataStructure(I, J, V);
+end
+
+function iSimpleMatrixLevelSetPartitioning(ds)
+nodeIds = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10];
+subgIds = [1, 2, 2, 1, 2, 3, 4, 4, 1, 2];
+ds.setSubGraphOfNode(nodeIds, subgIds);
+end
+
+function sparseMatrix = iTriangular(sparseMatrix)
+sparseMatrix = tril(sparseMatrix);
+end
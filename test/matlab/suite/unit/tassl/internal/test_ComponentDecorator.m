@@ -0,0 +1,91 @@
+classdef test_ComponentDecorator < amsla.test.tools.AmslaTest
+    %TEST_COMPONENTDECORATOR Tests for the class
+    %amsla.tassl.internal.ComponentDecorator.
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    methods(Test)
+        
+        function mergedComponentsAreTheSame(testCase)
+            % Check that all the nodes of merged components report the same
+            % component, including after a chain of merges.
+            
+            graph = iDecoratedGraph(6);
+            graph.setComponentOfNode(1:6, [1, 2, 3, 4, 5, 6]);
+            
+            graph.mergeComponents(2, 1);
+            graph.mergeComponents([3, 4], 2);
+            graph.mergeComponents(1, 5);
+            
+            testCase.verifyEqual(graph.componentOfNode(1:6), [5, 5, 5, 5, 5, 6]);
+            [componentIds, numOfNodes] = graph.listOfComponents();
+            testCase.verifyEqual(componentIds, [5, 6]);
+            testCase.verifyEqual(numOfNodes, [5, 1]);
+        end
+        
+        function compactedComponentsStartFromOne(testCase)
+            % Check that compacting the components numbers them from 1 to
+            % N in ascending order of ID.
+            
+            graph = iDecoratedGraph(5);
+            graph.setComponentOfNode(1:5, [7, 3, 7, 10, 3]);
+            graph.mergeComponents(10, 7);
+            
+            graph.compactComponents();
+            
+            testCase.verifyEqual(graph.componentOfNode(1:5), [2, 1, 2, 2, 1]);
+            testCase.verifyEqual(graph.listOfComponents(), [1, 2]);
+        end
+        
+        function componentsOfUnorderedNodes(testCase)
+            % Check that the components are read and written by node ID,
+            % whatever the order of the nodes and with repeated nodes.
+            
+            graph = iDecoratedGraph(4);
+            graph.setComponentOfNode([4, 2, 1, 3], [1, 2, 3, 4]);
+            
+            testCase.verifyEqual(graph.componentOfNode([3, 3, 1, 4]), [4, 4, 3, 1]);
+            testCase.verifyEqual(graph.componentOfNode(2), 2);
+        end
+        
+        function componentsOfBlockDiagonalMatrix(testCase)
+            % Check that the component partitioner finds one component for
+            % each block of a block-diagonal matrix.
+            
+            rng('default');
+            blocks = arrayfun(@(k) tril(gallery('wathen', k, 1)), [1, 2, 1], ...
+                'UniformOutput', false);
+            [I, J, V] = find(blkdiag(blocks{:}));
+            graph = amsla.tassl.internal.ComponentDecorator( ...
+                amsla.common.DataStructure(I, J, V));
+            
+            amsla.tassl.internal.ComponentPartitioner(graph);
+            
+            blockSizes = cellfun(@(b) size(b, 1), blocks);
+            expectedComponents = repelem(1:numel(blocks), blockSizes);
+            testCase.verifyEqual(graph.componentOfNode(graph.listOfNodes()), ...
+                expectedComponents);
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function graph = iDecoratedGraph(numNodes)
+% A diagonal graph, whose nodes are not connected.
+graph = amsla.tassl.internal.ComponentDecorator( ...
+    amsla.common.DataStructure(1:numNodes, 1:numNodes, ones(1, numNodes)));
+end
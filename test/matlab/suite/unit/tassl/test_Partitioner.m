@@ -22,4 +22,31 @@ classdef test_Partitioner < amsla.test.shared.PartitionerTests
         end
         
     end
+    
+    methods(Test)
+        
+        function parallelPartitioningMatchesSerial(testCase)
+            % Check that partitioning the components concurrently assigns
+            % the same sub-graphs as partitioning them one at a time.
+            
+            rng('default');
+            blocks = arrayfun(@(k) tril(gallery('wathen', k, 2)), 1:3, ...
+                'UniformOutput', false);
+            [I, J, V] = find(blkdiag(blocks{:}));
+            serialGraph = amsla.common.DataStructure(I, J, V);
+            parallelGraph = amsla.common.DataStructure(I, J, V);
+            
+            serialPartitioner = amsla.tassl.Partitioner(serialGraph, 10);
+            serialPartitioner.partition();
+            parallelPartitioner = amsla.tassl.Partitioner(parallelGraph, 10, ...
+                "UseParallel", true);
+            parallelPartitioner.partition();
+            
+            allNodes = serialGraph.listOfNodes();
+            testCase.verifyEqual(parallelGraph.subGraphOfNode(allNodes), ...
+                serialGraph.subGraphOfNode(allNodes), ...
+                "The parallel partitioning does not match the serial one.");
+        end
+        
+    end
 end
\ No newline at end of file
@@ -0,0 +1,283 @@
+classdef test_SparseMatrixUpdates < amsla.test.tools.AmslaTest
+    %TEST_SPARSEMATRIXUPDATES Tests for the methods of amsla.SparseMatrix
+    %that change an analysed matrix
+    
+    % Copyright 2020 Andrea Picciau
+    %
+    % Licensed under the Apache License, Version 2.0 (the "License");
+    % you may not use this file except in compliance with the License.
+    % You may obtain a copy of the License at
+    %
+    %    http://www.apache.org/licenses/LICENSE-2.0
+    %
+    % Unless required by applicable law or agreed to in writing, software
+    % distributed under the License is distributed on an "AS IS" BASIS,
+    % WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    % See the License for the specific language governing permissions and
+    % limitations under the License.
+    
+    properties(TestParameter)
+        
+        Format = struct( ...
+            'Csr',            { "csr" }, ...
+            'LevelSet',       { "levelSet" }, ...
+            'Tassl',          { "tassl" }, ...
+            'CoarseLevelSet', { "coarseLevelSet" });
+        
+        CompactFormat = struct( ...
+            'LevelSet',       { "levelSet" }, ...
+            'Tassl',          { "tassl" }, ...
+            'CoarseLevelSet', { "coarseLevelSet" });
+        
+    end
+    
+    %% TEST METHODS
+    
+    % Changing the values of the matrix
+    
+    methods(Test)
+        
+        function updatingValuesKeepsTheOriginalMatrix(testCase)
+            % Check that the matrix whose values were updated is a new
+            % matrix, and that the original one keeps its values.
+            
+            A = iMatrix();
+            matrix = amsla.SparseMatrix(A, "tassl");
+            matrix = matrix.analyse(8);
+            
+            updatedMatrix = matrix.updateValues(2*A);
+            
+            rhs = ones(size(A, 1), 1);
+            testCase.verifyEqual(updatedMatrix.solve(rhs), (2*A)\rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong solution after updating the values.");
+            testCase.verifyEqual(matrix.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-10, ...
+                "The original matrix changed with the updated one.");
+            testCase.verifyEqual(matrix.spmv(rhs), A*rhs, ...
+                "AbsTol", 1e-10, ...
+                "The original matrix changed with the updated one.");
+        end
+        
+        function rejectedValuesLeaveTheMatrixUnchanged(testCase)
+            % Check that a matrix is unchanged after an update of a unit
+            % diagonal element that was not scheduled is rejected.
+            
+            [~, I, J, V] = amsla.test.tools.getSimpleLowerTriangularMatrix();
+            A = sparse(I, J, V);
+            matrix = amsla.SparseMatrix(A, "levelSet");
+            matrix = matrix.analyse();
+            
+            testCase.verifyError(@() matrix.updateValues(1, 1, 2), ...
+                "amsla:SolvePlan:unitDiagonalChanged");
+            
+            rhs = ones(size(A, 1), 1);
+            testCase.verifyEqual(matrix.spmv(rhs), A*rhs, ...
+                "AbsTol", 1e-10, ...
+                "The matrix changed after the update was rejected.");
+            testCase.verifyEqual(matrix.solve(rhs), A\rhs, ...
+                "AbsTol", 1e-10, ...
+                "The matrix changed after the update was rejected.");
+        end
+        
+        function updatingValuesDoesNotRebuildTheDataStructure(testCase, Format)
+            % Check that updating the values copies the data structure of
+            % the matrix instead of building its parents and children again.
+            
+            testCase.addTeardown(@() amsla.common.Tracer.stop());
+            A = iMatrix();
+            
+            amsla.common.Tracer.start();
+            matrix = amsla.SparseMatrix(A, Format);
+            amsla.common.Tracer.stop();
+            eventTable = amsla.common.Tracer.events();
+            testCase.assertTrue(ismember("buildDataStructure", eventTable.Name), ...
+                "The construction of the data structure was not recorded.");
+            
+            amsla.common.Tracer.start();
+            updatedMatrix = matrix.updateValues(2*A);
+            amsla.common.Tracer.stop();
+            eventTable = amsla.common.Tracer.events();
+            testCase.verifyFalse(ismember("buildDataStructure", eventTable.Name), ...
+                "Updating the values built the data structure again.");
+            
+            rhs = ones(size(A, 1), 1);
+            testCase.verifyEqual(updatedMatrix.spmv(rhs), (2*A)*rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong product after updating the values.");
+            testCase.verifyEqual(matrix.spmv(rhs), A*rhs, ...
+                "AbsTol", 1e-10, ...
+                "The original matrix changed with the updated one.");
+        end
+        
+    end
+    
+    % Changing the sparsity pattern of the matrix
+    
+    methods(Test)
+        
+        function updatedPatternSolvesCorrectly(testCase, Format)
+            % Check that a matrix whose sparsity pattern was updated gives
+            % the same solution as MATLAB's backslash on the new matrix.
+            
+            A = iMatrix();
+            matrix = amsla.SparseMatrix(A, Format);
+            if Format=="tassl"
+                matrix = matrix.analyse(8);
+            else
+                matrix = matrix.analyse();
+            end
+            
+            [addedRows, addedColumns, removedRows, removedColumns] = iPatternChange(A);
+            newA = A;
+            newA(sub2ind(size(A), addedRows, addedColumns)) = 0.5;
+            newA(sub2ind(size(A), removedRows, removedColumns)) = 0;
+            [matrix, result] = matrix.updatePattern(addedRows, addedColumns, ...
+                0.5*ones(size(addedRows)), removedRows, removedColumns);
+            
+            rhs = ones(size(A, 1), 1);
+            testCase.verifyClass(result, ?amsla.common.PartitioningResult);
+            testCase.verifyEqual(matrix.solve(rhs), newA\rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong solution after updating the sparsity pattern.");
+            testCase.verifyEqual(matrix.spmv(rhs), newA*rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong product after updating the sparsity pattern.");
+        end
+        
+        function updatingPatternRequiresAnalysis(testCase)
+            % Check that the pattern of a matrix that was not analysed
+            % cannot be updated.
+            
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            
+            testCase.verifyError(@() matrix.updatePattern(3, 1, 1), ...
+                "amsla:AnalysisRequired");
+        end
+        
+        function elementsMustBeNewOrExisting(testCase)
+            % Check that only new elements can be added and only existing
+            % elements can be removed.
+            
+            A = iMatrix();
+            matrix = amsla.SparseMatrix(A, "tassl");
+            matrix = matrix.analyse(8);
+            
+            testCase.verifyError(@() matrix.updatePattern(1, 1, 1), ...
+                "amsla:updatePattern:alreadyInPattern");
+            [noRow, noColumn] = find(tril(~A, -1), 1);
+            testCase.verifyError(@() matrix.updatePattern([], [], [], noRow, noColumn), ...
+                "amsla:updatePattern:notInPattern");
+        end
+        
+        function addedElementsMustBeLowerTriangular(testCase)
+            % Check that the elements to add must be in the lower triangle
+            % of the matrix.
+            
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            matrix = matrix.analyse(8);
+            
+            testCase.verifyError(@() matrix.updatePattern(1, 5, 1), ...
+                "amsla:updatePattern:notLowerTriangular");
+        end
+        
+        function diagonalCannotBeRemoved(testCase)
+            % Check that the diagonal elements of the matrix cannot be
+            % removed.
+            
+            matrix = amsla.SparseMatrix(iMatrix(), "tassl");
+            matrix = matrix.analyse(8);
+            
+            testCase.verifyError(@() matrix.updatePattern([], [], [], 3, 3), ...
+                "amsla:updatePattern:diagonalRemoved");
+        end
+        
+    end
+    
+    % Keeping the compact layout
+    
+    methods(Test)
+        
+        function updatedValuesKeepTheCompactLayout(testCase, CompactFormat)
+            % Check that a compact matrix is still compact after updating
+            % its values.
+            
+            A = iMatrix();
+            matrix = amsla.SparseMatrix(A, CompactFormat, "Compact", true);
+            matrix = iAnalyse(matrix, CompactFormat);
+            
+            updatedMatrix = matrix.updateValues(2*A);
+            
+            iVerifyCompactLayout(testCase, updatedMatrix, nnz(A));
+            testCase.verifyEqual(updatedMatrix.memoryFootprint(), matrix.memoryFootprint(), ...
+                "Updating the values changed the memory used by the matrix.");
+        end
+        
+        function updatedPatternKeepsTheCompactLayout(testCase, CompactFormat)
+            % Check that a compact matrix is still compact after updating
+            % its sparsity pattern.
+            
+            A = iMatrix();
+            matrix = amsla.SparseMatrix(A, CompactFormat, "Compact", true);
+            matrix = iAnalyse(matrix, CompactFormat);
+            
+            [addedRows, addedColumns, removedRows, removedColumns] = iPatternChange(A);
+            matrix = matrix.updatePattern(addedRows, addedColumns, ...
+                0.5*ones(size(addedRows)), removedRows, removedColumns);
+            
+            iVerifyCompactLayout(testCase, matrix, nnz(A));
+            rhs = ones(size(A, 1), 1);
+            newA = A;
+            newA(sub2ind(size(A), addedRows, addedColumns)) = 0.5;
+            newA(sub2ind(size(A), removedRows, removedColumns)) = 0;
+            testCase.verifyEqual(matrix.solve(rhs), newA\rhs, ...
+                "AbsTol", 1e-10, ...
+                "Wrong solution after updating the sparsity pattern.");
+        end
+        
+        function compactIsIgnoredWithoutCompactLayout(testCase)
+            % Check that a format without a compact layout stores the
+            % matrix as usual.
+            
+            A = iMatrix();
+            compactMatrix = amsla.SparseMatrix(A, "csr", "Compact", true);
+            matrix = amsla.SparseMatrix(A, "csr");
+            
+            testCase.verifyEqual(compactMatrix.memoryFootprint(), matrix.memoryFootprint());
+        end
+        
+    end
+end
+
+%% HELPER FUNCTIONS
+
+function A = iMatrix()
+rng('default');
+A = tril(sprand(60, 60, 0.05), -1) + 4*speye(60);
+end
+
+function matrix = iAnalyse(matrix, format)
+% Analyse the matrix, with small sub-graphs if the format uses them.
+if format=="tassl"
+    matrix = matrix.analyse(8);
+else
+    matrix = matrix.analyse();
+end
+end
+
+function iVerifyCompactLayout(testCase, matrix, numEdges)
+% The compact layout stores the edge IDs as int32.
+footprint = matrix.memoryFootprint();
+testCase.verifyEqual(footprint.Bytes(footprint.Component=="Edge IDs"), 4*numEdges, ...
+    "The matrix does not use the compact layout.");
+end
+
+function [addedRows, addedColumns, removedRows, removedColumns] = iPatternChange(A)
+% Add two elements in the lower triangle and remove two off-diagonal ones.
+[freeRows, freeColumns] = find(tril(~A, -1));
+addedRows = freeRows([1, end]);
+addedColumns = freeColumns([1, end]);
+[usedRows, usedColumns] = find(tril(A, -1));
+removedRows = usedRows([1, end]);
+removedColumns = usedColumns([1, end]);
+end